@@ -0,0 +1,303 @@
+// ============================================================================
+// AggregateStage: rf metadata'sı üzerinde pencereli kanal özetleri
+// ============================================================================
+// Girdi ring'inin rf lane'i (rf.first = kanal, rf.second = değer) sabit
+// pencerelerde kanal başına min / max / ortalama / varyans olarak özetlenir;
+// pencere başına kanal başına TEK WindowSummary kaydı çıktı ring'ine yazılır.
+// Telemetri hacmi window_items / kanal sayısı oranında düşer.
+//
+// PENCERE: girdi pozisyonuyla sabit: window = pos / window_items. Batch
+// pencere sınırında bölünür; sınır geçilince açık pencere yayınlanır
+// (skip_expired ile atlanan pozisyonlar pencereyi boş bırakabilir).
+//
+// SÜTUN İŞLEME: claim_consumer_batch ile alınan slot'ların rf kayıtları
+// lane'de ardışıktır (ring sarması hariç). AVX2 çekirdeği 4 kaydı iki
+// 256 bit yükle alır; unpacklo/unpackhi ile kanal ve değer sütunlarına
+// ayırır. 4'ü de aynı kanaldaysa min/max/toplam/kare toplamı vektörde
+// birikir; kanal değişen grupta skaler yola düşülür. Yani tek kanallı ve
+// kanal başına burst'lü akışlar vektör hızında, her kayıtta kanal değişen
+// (round-robin) akışlar skaler hızdadır.
+//
+// VARYANS: kanal başına pencerenin ilk değeri kaydırma (shift) olarak
+// kullanılır: toplamlar (x - shift) üzerinden, böylece büyük ofsetli
+// değerlerde sum/sumsq iptali olmaz. Popülasyon varyansı (n'e bölünür).
+//
+// Kanallar yoğun kimliklerdir: 0 <= rf.first < max_channels; aralık
+// dışındakiler dropped'ta sayılır. Çıktı ring'ine yazan TEK producer
+// AggregateStage olmalıdır (CodecStage gibi); çıktı chunk_size en az
+// sizeof(WindowSummary) olmalıdır. Çıktı ring'i doluysa özetler bekletilir
+// ve girdi tüketilmez (geri basınç).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Çıktı ring'inde slot başına bir kayıt (cpu_ptr); rf = {channel, mean}
+struct WindowSummary {
+    std::uint64_t window;    // pos / window_items
+    std::int32_t channel;
+    std::uint32_t count;
+    double min;
+    double max;
+    double mean;
+    double variance;         // Popülasyon varyansı
+};
+
+namespace aggregate_detail {
+
+using Rf = std::pair<int, double>;
+static_assert(sizeof(Rf) == 16 && offsetof(Rf, second) == 8, "rf lane düzeni: {int32, pad, double}");
+
+// Kanal başına pencere birikimi (değerler x - shift)
+struct Acc {
+    double shift = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0;
+    double sumsq = 0;
+    std::uint32_t count = 0;
+};
+
+inline void add_scalar(Acc& a, double x) {
+    const double d = x - a.shift;
+    a.min = std::min(a.min, x);
+    a.max = std::max(a.max, x);
+    a.sum += d;
+    a.sumsq += d * d;
+    ++a.count;
+}
+
+#if defined(__x86_64__)
+// rf[0..n)'in kanalı ch olan 4'lü gruplarını biriktirir; kanal değişen ilk
+// grupta durur. Dönüş: işlenen kayıt (4'ün katı).
+__attribute__((target("avx2")))
+inline std::size_t reduce_run_avx2(const Rf* rf, std::size_t n, int ch, Acc& a) {
+    const __m256i lo32 = _mm256_set1_epi64x(0xFFFFFFFFll);
+    const __m256i vch = _mm256_set1_epi64x(static_cast<std::uint32_t>(ch));
+    const __m256d shift = _mm256_set1_pd(a.shift);
+    __m256d vmin = _mm256_set1_pd(a.min);
+    __m256d vmax = _mm256_set1_pd(a.max);
+    __m256d vsum = _mm256_setzero_pd();
+    __m256d vsq = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i r01 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rf + i));
+        const __m256i r23 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rf + i + 2));
+        // 64 bit lane'ler: [first0|pad, second0, first1|pad, second1]; padding maskelenir
+        const __m256i chans = _mm256_and_si256(_mm256_unpacklo_epi64(r01, r23), lo32);
+        if (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(chans, vch))) != 0xF) break;
+        const __m256d v = _mm256_unpackhi_pd(_mm256_castsi256_pd(r01), _mm256_castsi256_pd(r23));
+        const __m256d d = _mm256_sub_pd(v, shift);
+        vmin = _mm256_min_pd(vmin, v);
+        vmax = _mm256_max_pd(vmax, v);
+        vsum = _mm256_add_pd(vsum, d);
+        vsq = _mm256_add_pd(vsq, _mm256_mul_pd(d, d));
+    }
+    if (i == 0) return 0;
+    alignas(32) double mn[4], mx[4], s[4], q[4];
+    _mm256_store_pd(mn, vmin);
+    _mm256_store_pd(mx, vmax);
+    _mm256_store_pd(s, vsum);
+    _mm256_store_pd(q, vsq);
+    a.min = std::min(std::min(mn[0], mn[1]), std::min(mn[2], mn[3]));
+    a.max = std::max(std::max(mx[0], mx[1]), std::max(mx[2], mx[3]));
+    a.sum += (s[0] + s[1]) + (s[2] + s[3]);
+    a.sumsq += (q[0] + q[1]) + (q[2] + q[3]);
+    a.count += static_cast<std::uint32_t>(i);
+    return i;
+}
+#endif
+
+inline bool has_avx2() {
+#if defined(__x86_64__)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}  // namespace aggregate_detail
+
+class AggregateStage {
+public:
+    struct Config {
+        std::size_t window_items = 4096;   // Pencere uzunluğu (girdi pozisyonu)
+        std::size_t max_channels = 256;    // Kanal kimlikleri [0, max_channels)
+        bool simd = true;                  // false: sadece skaler yol (karşılaştırma için)
+    };
+
+    struct Stats {
+        std::uint64_t items = 0;       // Tüketilen girdi item'ı
+        std::uint64_t windows = 0;     // Yayınlanan pencere
+        std::uint64_t summaries = 0;   // Çıktı ring'ine yazılan kayıt
+        std::uint64_t simd_items = 0;  // Vektör çekirdeğinde biriken item
+        std::uint64_t dropped = 0;     // Kanalı aralık dışı item
+        std::uint64_t out_full = 0;    // Çıktı ring'i dolu (geri basınç) sayısı
+        std::uint64_t errors = 0;      // Kaybedilen commit (tek producer şartı ihlali)
+    };
+
+    AggregateStage(CircularBuffer& in, CircularBuffer& out) : AggregateStage(in, out, Config{}) {}
+    AggregateStage(CircularBuffer& in, CircularBuffer& out, Config config)
+        : in_(in), out_(out), config_(config), accs_(config.max_channels) {
+        if (config_.window_items == 0) config_.window_items = 1;
+        touched_.reserve(config_.max_channels);
+    }
+
+    // ========================================================================
+    // pump: En fazla max_items girdi item'ı işler; işlenen sayıyı döner
+    // ========================================================================
+    // Önce bekleyen özetler çıktı ring'ine yazılır; yazılamayan kalırsa
+    // girdi tüketilmez (0 döner).
+    // ========================================================================
+    std::size_t pump(std::size_t max_items = 1024) {
+        constexpr std::size_t kBatch = 64;
+        CircularBuffer::Ticket batch[kBatch];
+        std::size_t done = 0;
+        while (done < max_items) {
+            if (!drain_pending()) break;
+            const std::size_t n = in_.claim_consumer_batch(batch, std::min(kBatch, max_items - done));
+            if (n == 0) break;
+            process(batch, n);
+            for (std::size_t i = 0; i < n; ++i) in_.release_consumer(batch[i]);
+            done += n;
+        }
+        return done;
+    }
+
+    // Açık (yarım) pencereyi yayınlar (kapanış, zaman aşımı); yazılamayanlar
+    // bekletilir. Tüm özetler çıktıya yazıldıysa true.
+    bool flush() {
+        close_window();
+        return drain_pending();
+    }
+
+    const Stats& stats() const { return stats_; }
+    const Config& config() const { return config_; }
+    std::size_t pending() const { return pending_.size(); }
+    // Girdi item'ı / çıktı kaydı oranı
+    double reduction() const {
+        return stats_.summaries ? static_cast<double>(stats_.items) / static_cast<double>(stats_.summaries) : 0.0;
+    }
+
+private:
+    using Rf = aggregate_detail::Rf;
+    using Acc = aggregate_detail::Acc;
+
+    void process(const CircularBuffer::Ticket* batch, std::size_t n) {
+        std::size_t i = 0;
+        while (i < n) {
+            const std::size_t pos = batch[i].pos;
+            const std::uint64_t window = pos / config_.window_items;
+            if (open_ && window != window_) close_window();
+            window_ = window;
+            open_ = true;
+            // Pencere sonu veya ring sarmasına kadar (rf kayıtları ardışık)
+            const std::size_t to_boundary = (window + 1) * config_.window_items - pos;
+            std::size_t len = 1;
+            while (i + len < n && len < to_boundary && batch[i + len].rf == batch[i].rf + len) ++len;
+            reduce(batch[i].rf, len);
+            stats_.items += len;
+            i += len;
+        }
+    }
+
+    // Ardışık rf[0..n) kayıtlarını kanal birikimlerine ekler
+    void reduce(const Rf* rf, std::size_t n) {
+        [[maybe_unused]] const bool simd = config_.simd && aggregate_detail::has_avx2();
+        std::size_t i = 0;
+        while (i < n) {
+            const int ch = rf[i].first;
+            if (ch < 0 || static_cast<std::size_t>(ch) >= config_.max_channels) {
+                ++stats_.dropped;
+                ++i;
+                continue;
+            }
+            Acc& a = accs_[static_cast<std::size_t>(ch)];
+            if (a.count == 0) {
+                a.shift = rf[i].second;
+                touched_.push_back(ch);
+            }
+#if defined(__x86_64__)
+            // Ucuz ön kontrol: 4'lü grubun son kaydı da aynı kanaldaysa vektör dene
+            if (simd && n - i >= 4 && rf[i + 3].first == ch) {
+                const std::size_t k = aggregate_detail::reduce_run_avx2(rf + i, n - i, ch, a);
+                stats_.simd_items += k;
+                i += k;
+            }
+#endif
+            // Kalan (kanal değişen grup veya < 4 kayıt): aynı kanal sürdükçe skaler
+            while (i < n && rf[i].first == ch) aggregate_detail::add_scalar(a, rf[i++].second);
+        }
+    }
+
+    // Açık pencerenin kanal özetlerini bekleyen kuyruğa alır
+    void close_window() {
+        if (!open_) return;
+        for (int ch : touched_) {
+            Acc& a = accs_[static_cast<std::size_t>(ch)];
+            const double n = static_cast<double>(a.count);
+            const double mean_d = a.sum / n;
+            WindowSummary s{};
+            s.window = window_;
+            s.channel = ch;
+            s.count = a.count;
+            s.min = a.min;
+            s.max = a.max;
+            s.mean = a.shift + mean_d;
+            s.variance = std::max(0.0, a.sumsq / n - mean_d * mean_d);
+            pending_.push_back(s);
+            a = Acc{};
+        }
+        touched_.clear();
+        open_ = false;
+        ++stats_.windows;
+    }
+
+    // Bekleyen özetleri çıktı ring'ine yazar; hepsi yazıldıysa true
+    bool drain_pending() {
+        while (!pending_.empty()) {
+            auto o = out_.claim_producer();
+            if (!o) {
+                ++stats_.out_full;
+                return false;
+            }
+            const WindowSummary& s = pending_.front();
+            const std::size_t bytes = std::min(sizeof(WindowSummary), out_.chunk_size());
+            std::memcpy(o->cpu_ptr, &s, bytes);
+            *o->size_ptr = bytes;
+            *o->rf = {s.channel, s.mean};
+            if (out_.commit_producer(*o)) ++stats_.summaries;
+            else ++stats_.errors;
+            pending_.pop_front();
+        }
+        return true;
+    }
+
+    CircularBuffer& in_;
+    CircularBuffer& out_;
+    Config config_;
+    Stats stats_;
+    std::vector<Acc> accs_;
+    std::vector<int> touched_;           // Açık pencerede görülen kanallar (ilk görülme sırası)
+    std::deque<WindowSummary> pending_;  // Çıktı ring'ine yazılmayı bekleyen özetler
+    std::uint64_t window_{0};
+    bool open_{false};
+};
@@ -0,0 +1,1562 @@
+// ============================================================================
+// Benchmark: Lock-free MPMC Circular Buffer
+// ============================================================================
+// Bu dosya buffer varyantlarının throughput ölçümlerini içerir. Her ölçüm bir
+// "bölüm" (section) olarak kayıtlıdır; argüman verilmezse hepsi çalışır.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench.cpp -o bench
+// Run:   ./bench                 (tüm bölümler)
+//        ./bench sharded         (sadece belirtilen bölüm)
+// ============================================================================
+
+#include "circular_buffer.hpp"
+#include "sharded_buffer.hpp"
+#include "lane_buffer.hpp"
+#include "udp_ingest.hpp"
+#include "recorder.hpp"
+#include "capture.hpp"
+#include "sample_codec.hpp"
+#include "topology.hpp"
+#include "memory_trimmer.hpp"
+#include "perf_counters.hpp"
+#include "stream_copy.hpp"
+#include "aggregate_stage.hpp"
+#include "fir_stage.hpp"
+#include "fft_stage.hpp"
+#include "detect_stage.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Her ölçüm bu kadar sürer (kısa tutuldu; CI'da da çalışabilsin)
+    constexpr auto kRunTime = std::chrono::milliseconds(300);
+
+    // ========================================================================
+    // run_threads: P producer + C consumer thread'ini kRunTime boyunca çalıştırır
+    // ========================================================================
+    // produce(id) / consume(id) başarılı işlem sayısını döndürür (0 veya 1;
+    // batch consumer'lar işlenen slot sayısını).
+    // pins boş değilse thread k (önce producer'lar) pins[k]'ya pinlenir.
+    // counted verilirse ölçüm boyunca tüm thread'lerin perf sayaçları
+    // (PerfCounters, inherit) ve tüketilen item sayısı oraya yazılır.
+    // Sonuç: saniyede tüketilen item sayısı (milyon).
+    // ========================================================================
+    struct Counted {
+        PerfCounters::Sample sample;
+        long long ops = 0;
+        std::string reason;      // Açılamayan sayaçların nedeni (boş: hepsi açık)
+    };
+
+    double run_threads(int producers, int consumers,
+                       const std::function<int(int)>& produce,
+                       const std::function<int(int)>& consume,
+                       const std::vector<int>& pins = {},
+                       Counted* counted = nullptr) {
+        // Sayaçlar thread'lerden önce açılır (inherit sadece sonraki thread'leri sayar)
+        std::optional<PerfCounters> perf;
+        if (counted) perf.emplace();
+        auto pin = [&](int k) {
+            if (!pins.empty()) pin_current_thread(pins[static_cast<std::size_t>(k) % pins.size()]);
+        };
+        std::atomic<bool> start{false};
+        std::atomic<bool> done{false};
+        std::atomic<long long> consumed{0};
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < producers; ++i) {
+            threads.emplace_back([&, i]() {
+                pin(i);
+                while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+                while (!done.load(std::memory_order_relaxed)) {
+                    if (!produce(i)) std::this_thread::yield();
+                }
+            });
+        }
+        for (int i = 0; i < consumers; ++i) {
+            threads.emplace_back([&, i]() {
+                pin(producers + i);
+                long long local = 0;
+                while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+                while (!done.load(std::memory_order_relaxed)) {
+                    if (const int n = consume(i)) local += n;
+                    else std::this_thread::yield();
+                }
+                consumed.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        if (perf) perf->start();
+        auto t0 = Clock::now();
+        start.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(kRunTime);
+        done.store(true, std::memory_order_relaxed);
+        for (auto& t : threads) t.join();
+        double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        if (perf) {
+            counted->sample = perf->stop();
+            counted->ops = consumed.load();
+            counted->reason = perf->reason();
+        }
+        return static_cast<double>(consumed.load()) / secs / 1e6;
+    }
+
+    // ========================================================================
+    // Bölüm: sharded — tek CircularBuffer ile ShardedBuffer karşılaştırması
+    // ========================================================================
+    // Her satırda P = C = n thread. ShardedBuffer'da shard sayısı n'dir; her
+    // producer kendi shard'ına yazar, consumer'lar home shard + çalma yapar.
+    // ========================================================================
+    void bench_sharded() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 64;
+        unsigned hw = std::thread::hardware_concurrency();
+        std::printf("[sharded] hardware_concurrency=%u, chunk=%zu, capacity/shard=%zu\n",
+                    hw, chunk, capacity);
+        std::printf("  %-8s %14s %14s %8s\n", "threads", "single Mops/s", "sharded Mops/s", "ratio");
+
+        for (int n : {1, 2, 4, 8}) {
+            CircularBuffer single(capacity, chunk);
+            double single_rate = run_threads(
+                n, n,
+                [&](int) {
+                    auto t = single.claim_producer();
+                    if (!t) return 0;
+                    *t->size_ptr = chunk;
+                    return single.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int) {
+                    auto t = single.claim_consumer();
+                    if (!t) return 0;
+                    single.release_consumer(*t);
+                    return 1;
+                });
+
+            ShardedBuffer sharded(static_cast<std::size_t>(n), capacity, chunk);
+            double sharded_rate = run_threads(
+                n, n,
+                [&](int id) {
+                    auto t = sharded.claim_producer(static_cast<std::size_t>(id));
+                    if (!t) return 0;
+                    *t->slot.size_ptr = chunk;
+                    return sharded.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int id) {
+                    auto t = sharded.claim_consumer(static_cast<std::size_t>(id));
+                    if (!t) return 0;
+                    sharded.release_consumer(*t);
+                    return 1;
+                });
+
+            std::printf("  %-8d %14.2f %14.2f %7.2fx\n", n, single_rate, sharded_rate,
+                        single_rate > 0 ? sharded_rate / single_rate : 0.0);
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: lanes — yüksek öncelikli lane'ler boşken claim maliyeti
+    // ========================================================================
+    // Tek thread: commit + claim + release döngüsü. Veri sadece en düşük
+    // öncelikli lane'de; LaneBuffer'ın boş lane'leri ready_mask_ ile atlaması
+    // beklenir. Referans: düz CircularBuffer.
+    // ========================================================================
+    void bench_lanes() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 64;
+        constexpr int iterations = 2'000'000;
+        std::printf("[lanes] ns per commit+claim+release (data only in lowest-priority lane)\n");
+
+        CircularBuffer single(capacity, chunk);
+        auto t0 = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            if (auto p = single.claim_producer()) single.commit_producer(*p);
+            if (auto c = single.claim_consumer()) single.release_consumer(*c);
+        }
+        double base_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+        std::printf("  %-28s %8.1f ns\n", "CircularBuffer", base_ns);
+
+        for (auto policy : {LaneBuffer::Policy::StrictPriority, LaneBuffer::Policy::WeightedRoundRobin}) {
+            for (std::size_t lanes : {2u, 8u, 32u}) {
+                LaneBuffer buffer(lanes, capacity, chunk, policy);
+                LaneBuffer::Cursor cursor;
+                const std::size_t bulk = lanes - 1;
+                auto t1 = Clock::now();
+                for (int i = 0; i < iterations; ++i) {
+                    if (auto p = buffer.claim_producer(bulk)) buffer.commit_producer(*p);
+                    if (auto c = buffer.claim_consumer(cursor)) buffer.release_consumer(*c);
+                }
+                double ns = std::chrono::duration<double, std::nano>(Clock::now() - t1).count() / iterations;
+                char label[64];
+                std::snprintf(label, sizeof(label), "LaneBuffer %s x%zu",
+                              policy == LaneBuffer::Policy::StrictPriority ? "strict" : "wrr", lanes);
+                std::printf("  %-28s %8.1f ns (%+.1f ns)\n", label, ns, ns - base_ns);
+            }
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: readiness — eventfd uyanma gecikmesi ve commit başına syscall
+    // ========================================================================
+    // Consumer bir epoll döngüsünde bekler; producer burst'ler halinde (burst
+    // başına N item, aralarında boşluk) commit eder ve chunk'a commit anını
+    // yazar. Uyanma gecikmesi = commit -> consumer claim süresi (burst'ün ilk
+    // item'ı). Syscall oranı = readiness_signals / commit.
+    // ========================================================================
+    void bench_readiness() {
+        constexpr int bursts = 2000;
+        std::printf("[readiness] eventfd wake latency and syscalls per commit\n");
+        std::printf("  %-8s %12s %12s %12s\n", "burst", "p50 wake us", "p99 wake us", "syscall/commit");
+
+        for (int burst : {1, 8, 64}) {
+            BufferOptions options;
+            options.readiness_fd = true;
+            CircularBuffer buffer(1024, 64, options);
+            std::vector<double> wake_us;
+            wake_us.reserve(bursts);
+            std::atomic<bool> done{false};
+
+            std::thread consumer([&]() {
+                int ep = ::epoll_create1(0);
+                epoll_event ev{};
+                ev.events = EPOLLIN;
+                ::epoll_ctl(ep, EPOLL_CTL_ADD, buffer.event_fd(), &ev);
+                bool first_of_burst = true;
+                while (!done.load(std::memory_order_acquire)) {
+                    while (auto t = buffer.claim_consumer()) {
+                        if (first_of_burst) {
+                            std::int64_t sent;
+                            std::memcpy(&sent, t->cpu_ptr, sizeof(sent));
+                            auto now = Clock::now().time_since_epoch().count();
+                            wake_us.push_back(static_cast<double>(now - sent) / 1000.0);
+                            first_of_burst = false;
+                        }
+                        buffer.release_consumer(*t);
+                    }
+                    if (!buffer.arm_readiness()) continue;
+                    epoll_event out;
+                    if (::epoll_wait(ep, &out, 1, 10) > 0) {
+                        buffer.drain_readiness();
+                        first_of_burst = true;
+                    }
+                }
+                ::close(ep);
+            });
+
+            std::uint64_t commits = 0;
+            for (int b = 0; b < bursts; ++b) {
+                for (int i = 0; i < burst;) {
+                    auto t = buffer.claim_producer();
+                    if (!t) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    auto now = Clock::now().time_since_epoch().count();
+                    std::memcpy(t->cpu_ptr, &now, sizeof(now));
+                    if (buffer.commit_producer(*t)) {
+                        ++i;
+                        ++commits;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done.store(true, std::memory_order_release);
+            consumer.join();
+
+            std::sort(wake_us.begin(), wake_us.end());
+            auto pct = [&](double q) {
+                return wake_us.empty() ? 0.0 : wake_us[static_cast<std::size_t>(q * (wake_us.size() - 1))];
+            };
+            std::printf("  %-8d %12.1f %12.1f %12.4f\n", burst, pct(0.50), pct(0.99),
+                        commits ? static_cast<double>(buffer.readiness_signals()) / commits : 0.0);
+        }
+    }
+
+    // Thread'in kullandığı CPU zamanı (saniye)
+    double thread_cpu_seconds() {
+        timespec ts{};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    // ========================================================================
+    // Bölüm: wait — WaitStrategy başına latency ve CPU kullanımı
+    // ========================================================================
+    // Producer 20 us aralıklarla item gönderir (chunk'a gönderim anı yazılır);
+    // consumer claim_consumer_wait ile bekler. Latency = commit -> claim.
+    // CPU = consumer thread CPU zamanı / duvar saati (1.0 = bir çekirdek dolu).
+    // ========================================================================
+    void bench_wait() {
+        constexpr int items = 5000;
+        std::printf("[wait] consumer-side wait strategy, 1P/1C, 20us inter-arrival\n");
+        std::printf("  %-12s %12s %12s %12s\n", "strategy", "p50 us", "p99 us", "consumer CPU");
+
+        for (auto w : {WaitStrategy::BusySpin, WaitStrategy::PauseSpin, WaitStrategy::Yield,
+                       WaitStrategy::Sleep, WaitStrategy::Park}) {
+            BufferOptions options;
+            options.consumer_wait = w;
+            options.producer_wait = w;
+            CircularBuffer buffer(1024, 64, options);
+            std::vector<double> lat_us;
+            lat_us.reserve(items);
+            double cpu = 0, wall = 0;
+
+            std::thread consumer([&]() {
+                double c0 = thread_cpu_seconds();
+                auto w0 = Clock::now();
+                while (auto t = buffer.claim_consumer_wait()) {
+                    std::int64_t sent;
+                    std::memcpy(&sent, t->cpu_ptr, sizeof(sent));
+                    lat_us.push_back(
+                        static_cast<double>(Clock::now().time_since_epoch().count() - sent) / 1000.0);
+                    buffer.release_consumer(*t);
+                }
+                cpu = thread_cpu_seconds() - c0;
+                wall = std::chrono::duration<double>(Clock::now() - w0).count();
+            });
+
+            for (int i = 0; i < items;) {
+                auto t = buffer.claim_producer_wait();
+                if (!t) break;
+                auto now = Clock::now().time_since_epoch().count();
+                std::memcpy(t->cpu_ptr, &now, sizeof(now));
+                buffer.commit_producer(*t);
+                ++i;
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+            buffer.stop();
+            consumer.join();
+
+            std::sort(lat_us.begin(), lat_us.end());
+            auto pct = [&](double q) {
+                return lat_us.empty() ? 0.0 : lat_us[static_cast<std::size_t>(q * (lat_us.size() - 1))];
+            };
+            std::printf("  %-12s %12.1f %12.1f %11.0f%%\n", wait_strategy_name(w), pct(0.50),
+                        pct(0.99), wall > 0 ? 100.0 * cpu / wall : 0.0);
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: udp — loopback üzerinden recvmmsg ingest (batch boyutuna göre)
+    // ========================================================================
+    // Sender thread 1 KiB datagram'ları loopback'e basar; ana thread
+    // UdpIngest::poll_once(MSG_WAITFORONE) ile ring'e alır ve hemen tüketir. Kernel'in
+    // düşürdükleri (soket buffer taşması) sayılmaz; oran = alınan / syscall.
+    // ========================================================================
+    void bench_udp() {
+        constexpr std::size_t payload = 1024;
+        std::printf("[udp] loopback recvmmsg ingest, %zu B datagrams\n", payload);
+        std::printf("  %-8s %14s %16s\n", "batch", "kdatagrams/s", "datagrams/syscall");
+
+        for (std::size_t batch : {1u, 8u, 32u}) {
+            int rx = UdpIngest::open_socket(0, "127.0.0.1", 8 << 20);
+            int tx = ::socket(AF_INET, SOCK_DGRAM, 0);
+            if (rx < 0 || tx < 0) {
+                std::printf("  socket setup failed\n");
+                if (rx >= 0) ::close(rx);
+                if (tx >= 0) ::close(tx);
+                return;
+            }
+            sockaddr_in dst{};
+            dst.sin_family = AF_INET;
+            dst.sin_port = htons(UdpIngest::local_port(rx));
+            ::inet_pton(AF_INET, "127.0.0.1", &dst.sin_addr);
+
+            // MSG_WAITFORONE + kısa timeout: boş poll'lar syscall oranını bozmasın
+            timeval tv{0, 10000};
+            ::setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            CircularBuffer buffer(1024, 2048);
+            UdpIngest::Config config;
+            config.batch = batch;
+            UdpIngest ingest(buffer, rx, config);
+
+            std::atomic<bool> done{false};
+            std::thread sender([&]() {
+                std::vector<char> msg(payload, 'r');
+                while (!done.load(std::memory_order_relaxed)) {
+                    ::sendto(tx, msg.data(), msg.size(), 0, reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+                }
+            });
+
+            auto t0 = Clock::now();
+            while (Clock::now() - t0 < kRunTime) {
+                ingest.poll_once(MSG_WAITFORONE);
+                while (auto t = buffer.claim_consumer()) buffer.release_consumer(*t);
+            }
+            double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+            done.store(true, std::memory_order_relaxed);
+            sender.join();
+            ::close(rx);
+            ::close(tx);
+
+            const auto& st = ingest.stats();
+            std::printf("  %-8zu %14.1f %16.2f\n", batch, static_cast<double>(st.datagrams) / secs / 1e3,
+                        st.syscalls ? static_cast<double>(st.datagrams) / st.syscalls : 0.0);
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: recorder — io_uring (O_DIRECT, registered buffer) vs pwritev
+    // ========================================================================
+    // Producer thread 64 KiB chunk'ları durmadan commit eder; ana thread
+    // Recorder::pump ile /tmp'deki dosyaya yazar. Buffered satırlar page cache
+    // hızını ölçer (fdatasync yok); direct satırları gerçek cihaz hızıdır.
+    // ========================================================================
+    void bench_recorder() {
+        constexpr std::size_t chunk = 64 * 1024;
+        std::printf("[recorder] %zu KiB chunks -> /tmp\n", chunk / 1024);
+        std::printf("  %-10s %-8s %-6s %10s %14s\n", "path", "direct", "fixed", "MB/s", "chunks/write");
+
+        for (bool ring : {true, false}) {
+            for (bool direct : {true, false}) {
+                BufferOptions options;
+                options.data_alignment = Recorder::kDirectAlignment;
+                CircularBuffer buffer(256, chunk, options);
+                const std::string path = "/tmp/mpmc_bench_recorder.bin";
+                Recorder::Config config;
+                config.use_io_uring = ring;
+                config.direct = direct;
+                config.queue_depth = 8;   // 8 x 16 chunk: ring'in yarısı uçuşta
+                config.max_batch = 16;
+                Recorder recorder(buffer, path, config);
+                if (!recorder.ok()) {
+                    std::printf("  cannot open %s\n", path.c_str());
+                    return;
+                }
+
+                std::atomic<bool> done{false};
+                std::thread producer([&]() {
+                    while (!done.load(std::memory_order_relaxed)) {
+                        if (auto t = buffer.claim_producer()) buffer.commit_producer(*t);
+                    }
+                });
+                auto t0 = Clock::now();
+                while (Clock::now() - t0 < kRunTime) recorder.pump();
+                recorder.drain();
+                double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+                done.store(true, std::memory_order_relaxed);
+                producer.join();
+
+                const auto& st = recorder.stats();
+                std::printf("  %-10s %-8s %-6s %10.0f %14.2f\n",
+                            recorder.io_uring_active() ? "io_uring" : "pwritev",
+                            recorder.direct_active() ? "yes" : "no",
+                            recorder.fixed_buffers() ? "yes" : "no",
+                            static_cast<double>(st.bytes) / secs / 1e6,
+                            st.writes ? static_cast<double>(st.chunks) / st.writes : 0.0);
+                ::unlink(path.c_str());
+            }
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: journal — mmap journal modunun sync politikasına göre maliyeti
+    // ========================================================================
+    // 1P/1C, 4 KiB chunk (memset ile doldurulur; sayfalar gerçekten kirlenir).
+    // Heap satırı referanstır; journal satırları /tmp'deki dosyaya eşlenir.
+    // ========================================================================
+    void bench_journal() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 4096;
+        std::printf("[journal] 1P/1C, chunk=%zu, capacity=%zu\n", chunk, capacity);
+        std::printf("  %-26s %10s %10s\n", "mode", "kops/s", "syncs");
+
+        struct Mode {
+            const char* name;
+            bool journal;
+            JournalSync sync;
+            std::size_t items;
+            int interval_ms;
+        };
+        const Mode modes[] = {
+            {"heap", false, JournalSync::None, 0, 0},
+            {"journal None", true, JournalSync::None, 0, 0},
+            {"journal Msync / 256 items", true, JournalSync::Msync, 256, 0},
+            {"journal Fdatasync / 256", true, JournalSync::Fdatasync, 256, 0},
+            {"journal Msync / 10 ms", true, JournalSync::Msync, 0, 10},
+        };
+        const std::string path = "/tmp/mpmc_bench_journal.ring";
+        for (const Mode& m : modes) {
+            ::unlink(path.c_str());
+            BufferOptions options;
+            if (m.journal) {
+                options.journal_path = path;
+                options.journal_sync = m.sync;
+                options.journal_sync_items = m.items;
+                options.journal_sync_interval = std::chrono::milliseconds(m.interval_ms);
+            }
+            double rate;
+            std::uint64_t syncs;
+            {
+                CircularBuffer buffer(capacity, chunk, options);
+                rate = run_threads(
+                    1, 1,
+                    [&](int) {
+                        auto t = buffer.claim_producer();
+                        if (!t) return 0;
+                        std::memset(t->cpu_ptr, 0x5A, chunk);
+                        *t->size_ptr = chunk;
+                        return buffer.commit_producer(*t) ? 1 : 0;
+                    },
+                    [&](int) {
+                        auto t = buffer.claim_consumer();
+                        if (!t) return 0;
+                        buffer.release_consumer(*t);
+                        return 1;
+                    });
+                syncs = buffer.journal_syncs();
+            }
+            std::printf("  %-26s %10.1f %10llu\n", m.name, rate * 1e3,
+                        static_cast<unsigned long long>(syncs));
+        }
+        ::unlink(path.c_str());
+    }
+
+    // ========================================================================
+    // Bölüm: capture — kayıt yazma, max hızda replay ve indeksli seek
+    // ========================================================================
+    // 200k kayıt (256 B payload, 16 kanal, 1 µs aralık). Seek satırı: son
+    // %1'lik zaman aralığını tek kanal için okumak (indeks) vs dosyanın
+    // başından sona taramak.
+    // ========================================================================
+    void bench_capture() {
+        constexpr int count = 200000;
+        constexpr std::size_t payload = 256;
+        const std::string path = "/tmp/mpmc_bench_capture.cap";
+        std::printf("[capture] %d records, %zu B payload\n", count, payload);
+
+        CircularBuffer source(1024, payload);
+        auto t0 = Clock::now();
+        {
+            CaptureWriter writer(path, source);
+            std::vector<char> data(payload, 'c');
+            for (int i = 0; i < count; ++i) {
+                writer.append(static_cast<std::uint64_t>(i) * 1000, {i % 16, 0.0}, payload,
+                              data.data(), nullptr);
+            }
+        }
+        double write_secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::printf("  %-22s %10.2f Mrec/s %8.2f GB/s\n", "write", count / write_secs / 1e6,
+                    count * payload / write_secs / 1e9);
+
+        CaptureReader reader(path);
+        CircularBuffer target(1024, payload);
+        std::atomic<bool> done{false};
+        std::thread consumer([&]() {
+            while (!done.load(std::memory_order_relaxed) || target.size_approx()) {
+                if (auto t = target.claim_consumer()) target.release_consumer(*t);
+                else std::this_thread::yield();
+            }
+        });
+        CaptureReplay::Config config;
+        config.speed = 0.0;
+        auto st = CaptureReplay(reader, target, config).run();
+        done.store(true, std::memory_order_relaxed);
+        consumer.join();
+        std::printf("  %-22s %10.2f Mrec/s %8.2f GB/s\n", "replay (max speed)",
+                    st.records / st.seconds / 1e6, st.bytes / st.seconds / 1e9);
+
+        const std::uint64_t from = static_cast<std::uint64_t>(count) * 990;
+        auto seek = [&](std::uint64_t begin) {
+            auto s0 = Clock::now();
+            int n = 0;
+            reader.for_each(begin, ~std::uint64_t{0}, 3, [&](const CaptureRecord& r) {
+                if (r.t_ns >= from) ++n;
+                return true;
+            });
+            return std::make_pair(n, std::chrono::duration<double, std::micro>(Clock::now() - s0).count());
+        };
+        auto indexed = seek(from);
+        auto scan = seek(0);
+        std::printf("  %-22s %10.1f us (%d rec)\n", "seek last 1% (index)", indexed.second, indexed.first);
+        std::printf("  %-22s %10.1f us (%d rec)\n", "full scan", scan.second, scan.first);
+        ::unlink(path.c_str());
+    }
+
+    // ========================================================================
+    // Bölüm: codec — delta/zigzag/bit-packing oranı ve tek çekirdek GB/s
+    // ========================================================================
+    // 4 KiB chunk (2048 örnek). GB/s açık (raw) bayt üzerinden.
+    //   slow  : random walk, |adım| <= 8 (yavaş değişen RF örnekleri)
+    //   noisy : sinüs + 6 bit gürültü
+    //   random: tam aralık rastgele (en kötü durum)
+    // ========================================================================
+    void bench_codec() {
+        constexpr std::size_t n = 2048;
+        constexpr int reps = 20000;
+        std::printf("[codec] %zu samples/chunk, single core\n", n);
+        std::printf("  %-8s %8s %12s %12s\n", "signal", "ratio", "enc GB/s", "dec GB/s");
+
+        std::uint32_t state = 1;
+        auto next = [&]() { state = state * 1664525u + 1013904223u; return state >> 8; };
+        for (const char* kind : {"slow", "noisy", "random"}) {
+            std::vector<short> x(n), y(n);
+            int v = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (kind[0] == 's') v += static_cast<int>(next() % 17) - 8;
+                else if (kind[0] == 'n') v = static_cast<int>(8000 * std::sin(i * 0.01)) + static_cast<int>(next() % 64);
+                else v = static_cast<short>(next());
+                x[i] = static_cast<short>(v);
+            }
+            std::vector<std::uint8_t> enc(SampleCodec::max_encoded_bytes(n));
+            std::size_t bytes = 0;
+            auto t0 = Clock::now();
+            for (int r = 0; r < reps; ++r) bytes = SampleCodec::encode(x.data(), n, enc.data());
+            double enc_secs = std::chrono::duration<double>(Clock::now() - t0).count();
+            t0 = Clock::now();
+            for (int r = 0; r < reps; ++r) SampleCodec::decode(enc.data(), bytes, y.data(), n);
+            double dec_secs = std::chrono::duration<double>(Clock::now() - t0).count();
+            const double raw = static_cast<double>(n * sizeof(short)) * reps;
+            std::printf("  %-8s %7.2fx %12.2f %12.2f%s\n", kind,
+                        static_cast<double>(n * sizeof(short)) / bytes, raw / enc_secs / 1e9,
+                        raw / dec_secs / 1e9, x == y ? "" : "  MISMATCH");
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: crc — checksum lane'inin commit/claim maliyeti
+    // ========================================================================
+    // 1P/1C, 4 KiB chunk: checksum kapalı / commit'te hesap / commit + claim'de
+    // doğrulama. "+ns/item" checksum'ın item başına eklediği mutlak süre.
+    // Son satır tek çekirdek ham crc32c hızı (aktif uygulama).
+    // ========================================================================
+    void bench_crc() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 4096;
+        std::printf("[crc] 1P/1C, chunk=%zu, impl=%s\n", chunk, crc32c_impl_name());
+        std::printf("  %-18s %10s %10s %10s\n", "mode", "kops/s", "overhead", "+ns/item");
+
+        struct Mode {
+            const char* name;
+            bool checksum;
+            bool verify;
+        };
+        const Mode modes[] = {
+            {"off", false, false},
+            {"commit", true, false},
+            {"commit + verify", true, true},
+        };
+        double base = 0;
+        for (const Mode& m : modes) {
+            BufferOptions options;
+            options.checksum = m.checksum;
+            options.verify_on_claim = m.verify;
+            CircularBuffer buffer(capacity, chunk, options);
+            const double rate = run_threads(
+                1, 1,
+                [&](int) {
+                    auto t = buffer.claim_producer();
+                    if (!t) return 0;
+                    std::memset(t->cpu_ptr, 0x5A, chunk);
+                    *t->size_ptr = chunk;
+                    return buffer.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int) {
+                    auto t = buffer.claim_consumer();
+                    if (!t) return 0;
+                    buffer.release_consumer(*t);
+                    return 1;
+                });
+            if (base == 0) base = rate;
+            std::printf("  %-18s %10.1f %9.1f%% %10.1f%s\n", m.name, rate * 1e3, (base / rate - 1.0) * 100.0,
+                        1e3 / rate - 1e3 / base, buffer.checksum_mismatches() ? "  MISMATCH" : "");
+        }
+
+        std::vector<unsigned char> data(1 << 20, 0xA5);
+        constexpr int reps = 2000;
+        std::uint32_t sink = 0;
+        auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) sink ^= crc32c(data.data(), data.size());
+        const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::printf("  raw crc32c: %.2f GB/s (%x)\n", data.size() * static_cast<double>(reps) / secs / 1e9, sink);
+    }
+
+    // ========================================================================
+    // Bölüm: placement — topoloji yerleşimine göre throughput ve ping-pong
+    // ========================================================================
+    // 1P/1C, 64 B chunk. "rtt" iki ring üzerinden tek item'ın gidiş-dönüş
+    // süresidir (cache line'ın iki çekirdek arasında taşınma maliyeti).
+    // Topolojinin karşılayamadığı yerleşimler "n/a".
+    // ========================================================================
+    void bench_placement() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 64;
+        const CpuTopology topo;
+        std::printf("[placement] %s\n", topo.describe().c_str());
+        std::printf("  %-14s %-10s %10s %10s\n", "placement", "cpus", "Mops/s", "rtt ns");
+
+        for (auto p : {Placement::None, Placement::SameCore, Placement::SameL3, Placement::CrossSocket}) {
+            const auto pins = topo.placement(p, 1, 1);
+            if (!pins) {
+                std::printf("  %-14s %-10s %10s %10s\n", placement_name(p), "-", "n/a", "n/a");
+                continue;
+            }
+            const std::string cpus = pins->empty() ? "any" : std::to_string((*pins)[0]) + "/" + std::to_string((*pins)[1]);
+
+            CircularBuffer buffer(capacity, chunk);
+            const double rate = run_threads(
+                1, 1,
+                [&](int) {
+                    auto t = buffer.claim_producer();
+                    if (!t) return 0;
+                    *t->size_ptr = chunk;
+                    return buffer.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int) {
+                    auto t = buffer.claim_consumer();
+                    if (!t) return 0;
+                    buffer.release_consumer(*t);
+                    return 1;
+                },
+                *pins);
+
+            // Ping-pong: driver ping'e yazar, echo pong'a geri yollar. Kısa spin,
+            // sonra yield (tek CPU'da karşı thread'e sıra verebilmek için).
+            CircularBuffer ping(2, chunk), pong(2, chunk);
+            constexpr int rounds = 20000;
+            auto wait = [](int& spins) {
+                if (++spins < 2000) _mm_pause();
+                else std::this_thread::yield();
+            };
+            auto send = [&](CircularBuffer& ring) {
+                int spins = 0;
+                std::optional<CircularBuffer::Ticket> t;
+                while (!(t = ring.claim_producer()) || !ring.commit_producer(*t)) wait(spins);
+            };
+            auto receive = [&](CircularBuffer& ring) {
+                int spins = 0;
+                std::optional<CircularBuffer::Ticket> t;
+                while (!(t = ring.claim_consumer())) wait(spins);
+                ring.release_consumer(*t);
+            };
+            std::thread echo([&] {
+                if (!pins->empty()) pin_current_thread((*pins)[1]);
+                for (int i = 0; i < rounds; ++i) {
+                    receive(ping);
+                    send(pong);
+                }
+            });
+            double rtt = 0;
+            std::thread driver([&] {
+                if (!pins->empty()) pin_current_thread((*pins)[0]);
+                const auto t0 = Clock::now();
+                for (int i = 0; i < rounds; ++i) {
+                    send(ping);
+                    receive(pong);
+                }
+                rtt = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / rounds;
+            });
+            driver.join();
+            echo.join();
+            std::printf("  %-14s %-10s %10.2f %10.0f\n", placement_name(p), cpus.c_str(), rate, rtt);
+        }
+    }
+
+    // Process'in resident set boyutu (bayt), /proc/self/statm
+    std::size_t rss_bytes() {
+        std::FILE* f = std::fopen("/proc/self/statm", "r");
+        if (!f) return 0;
+        unsigned long size = 0, resident = 0;
+        const int got = std::fscanf(f, "%lu %lu", &size, &resident);
+        std::fclose(f);
+        return got == 2 ? resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) : 0;
+    }
+
+    // ========================================================================
+    // Bölüm: resize — resize kapısının maliyeti ve online büyütme/küçültme
+    // ========================================================================
+    // Üst tablo: 1P/1C, 64 B chunk; resizable kapalı/açık (claim, commit ve
+    // release başına bir atomik sayaç) ve çalışırken her 10 ms'de bir
+    // 256 <-> 4096 resize. Alt tablo: 16 KiB chunk'lı ring'in büyütülüp
+    // doldurulması ve küçültülmesi; resize çağrısının toplam süresi
+    // (ayırma + sıfırlama dahil), kapının kapalı kaldığı süre ve RSS.
+    // ========================================================================
+    void bench_resize() {
+        constexpr std::size_t chunk = 64;
+        std::printf("[resize] 1P/1C, chunk=%zu\n", chunk);
+        std::printf("  %-26s %10s %8s\n", "mode", "Mops/s", "resizes");
+        for (int mode = 0; mode < 3; ++mode) {
+            BufferOptions options;
+            options.resizable = mode > 0;
+            CircularBuffer buffer(1024, chunk, options);
+            std::atomic<bool> done{false};
+            std::thread resizer;
+            if (mode == 2) {
+                resizer = std::thread([&] {
+                    for (int k = 0; !done.load(); ++k) {
+                        buffer.resize(k % 2 ? 256 : 4096);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                });
+            }
+            const double rate = run_threads(
+                1, 1,
+                [&](int) {
+                    auto t = buffer.claim_producer();
+                    if (!t) return 0;
+                    *t->size_ptr = chunk;
+                    return buffer.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int) {
+                    auto t = buffer.claim_consumer();
+                    if (!t) return 0;
+                    buffer.release_consumer(*t);
+                    return 1;
+                });
+            done = true;
+            if (resizer.joinable()) resizer.join();
+            const char* name = mode == 0 ? "fixed" : mode == 1 ? "resizable (idle)" : "resizable, resize / 10 ms";
+            std::printf("  %-26s %10.2f %8llu\n", name, rate, static_cast<unsigned long long>(buffer.resizes()));
+        }
+
+        constexpr std::size_t big_chunk = 16 * 1024;
+        std::printf("  %-26s %10s %10s %10s %10s\n", "step (16 KiB chunks)", "capacity", "resize us", "pause us",
+                    "RSS MiB");
+        BufferOptions options;
+        options.resizable = true;
+        CircularBuffer buffer(64, big_chunk, options);
+        auto fill = [&](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                auto t = buffer.claim_producer();
+                if (!t) break;
+                std::memset(t->cpu_ptr, 0x5A, big_chunk);
+                *t->size_ptr = big_chunk;
+                buffer.commit_producer(*t);
+            }
+        };
+        auto drain = [&]() {
+            while (auto t = buffer.claim_consumer()) buffer.release_consumer(*t);
+        };
+        auto row = [&](const char* step, double us) {
+            const double pause = us ? std::chrono::duration<double, std::micro>(buffer.last_resize_pause()).count() : 0;
+            std::printf("  %-26s %10zu %10.0f %10.0f %10.1f\n", step, buffer.capacity(), us, pause,
+                        rss_bytes() / 1048576.0);
+        };
+        auto timed_resize = [&](std::size_t cap) {
+            const auto t0 = Clock::now();
+            buffer.resize(cap);
+            return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        };
+        fill(32);
+        row("start, 32 items", 0);
+        double us = timed_resize(4096);
+        row("grow -> 4096", us);
+        fill(4096);
+        row("fill peak", 0);
+        drain();
+        fill(32);
+        row("drain to 32 items", 0);
+        us = timed_resize(64);
+        row("shrink -> 64", us);
+        drain();
+    }
+
+    // ========================================================================
+    // Bölüm: trim — günlük (diurnal) yükte doluluğa bağlı bellek iadesi
+    // ========================================================================
+    // 4096 x 16 KiB ring (cpu + gpu lane ~128 MiB). Her döngü: "gündüz"
+    // 50 tik boyunca ring doldurulup boşaltılır (tüm chunk'lara dokunulur),
+    // "gece" 200 tik boyunca tik başına 4 item akar. Bir tik 10 ms simüle
+    // zamandır (MemoryTrimmer::poll'a verilir; gerçek bekleme yok), trimmer
+    // idle_period = 1 s. Tablo: gündüz sonu ve gece sonu RSS, döngü boyunca
+    // ortalama RSS, gece sonrası ilk dolumun süresi (sayfa fault'ları) ve
+    // en uzun kapı kapanması. Free modunda RSS bellek baskısı gelene kadar
+    // düşmeyebilir (kernel sayfaları tembel geri alır).
+    // ========================================================================
+    void bench_trim() {
+        constexpr std::size_t capacity = 4096;
+        constexpr std::size_t chunk = 16 * 1024;
+        constexpr int cycles = 2;
+        std::printf("[trim] %zu x %zu B, %d day/night cycles (simulated 10 ms ticks)\n", capacity, chunk, cycles);
+        std::printf("  %-18s %10s %10s %10s %12s %10s %8s\n", "mode", "day MiB", "night MiB", "mean MiB",
+                    "refill ms", "pause us", "trims");
+        for (int mode = 0; mode < 3; ++mode) {
+            BufferOptions options;
+            options.trimmable = mode > 0;
+            options.trim_advice = mode == 2 ? TrimAdvice::Free : TrimAdvice::DontNeed;
+            options.data_alignment = 4096;
+            const std::size_t base_rss = rss_bytes();
+            auto buffer = std::make_unique<CircularBuffer>(capacity, chunk, options);
+            MemoryTrimmer::Config config;
+            config.idle_period = std::chrono::milliseconds(1000);
+            MemoryTrimmer trimmer(*buffer, config);
+
+            auto now = MemoryTrimmer::Clock::now();
+            const auto tick = std::chrono::milliseconds(10);
+            auto flow = [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    auto t = buffer->claim_producer();
+                    if (!t) break;
+                    std::memset(t->cpu_ptr, 0x5A, chunk);
+                    *t->size_ptr = chunk;
+                    buffer->commit_producer(*t);
+                }
+            };
+            auto drain = [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    auto t = buffer->claim_consumer();
+                    if (!t) break;
+                    buffer->release_consumer(*t);
+                }
+            };
+            auto mib = [&] { return (rss_bytes() - std::min(rss_bytes(), base_rss)) / 1048576.0; };
+
+            double day = 0, night = 0, sum = 0, refill_ms = 0;
+            int samples = 0;
+            for (int c = 0; c < cycles; ++c) {
+                for (int k = 0; k < 50; ++k) {
+                    const auto t0 = Clock::now();
+                    flow(capacity);
+                    if (k == 0 && c > 0) {
+                        refill_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                    }
+                    if (mode > 0) trimmer.poll(now);
+                    drain(capacity);
+                    now += tick;
+                    sum += mib();
+                    ++samples;
+                }
+                day = mib();
+                for (int k = 0; k < 200; ++k) {
+                    flow(4);
+                    drain(4);
+                    if (mode > 0) trimmer.poll(now);
+                    now += tick;
+                    sum += mib();
+                    ++samples;
+                }
+                night = mib();
+            }
+            const char* name = mode == 0 ? "no trim" : mode == 1 ? "trim (dontneed)" : "trim (free)";
+            std::printf("  %-18s %10.1f %10.1f %10.1f %12.2f %10.0f %8llu\n", name, day, night, sum / samples,
+                        refill_ms, std::chrono::duration<double, std::micro>(trimmer.stats().max_pause).count(),
+                        static_cast<unsigned long long>(trimmer.stats().trims));
+            buffer.reset();
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: counters — P/C yapılandırması başına perf sayaçları
+    // ========================================================================
+    // CircularBuffer 1024 x 64 B; her satırda tüm thread'lerin toplam
+    // sayaçları tüketilen item başına (producer + consumer işi dahil;
+    // başarısız claim denemeleri ve yield'ler de sayılır). IPC =
+    // instructions / cycles. Açılamayan sayaçlar "n/a" (neden altta).
+    // ========================================================================
+    void bench_counters() {
+        constexpr std::size_t capacity = 1024;
+        constexpr std::size_t chunk = 64;
+        std::printf("[counters] per consumed item, capacity=%zu chunk=%zu\n", capacity, chunk);
+        std::printf("  %-6s %8s %9s %9s %6s %9s %9s %9s %9s\n", "P/C", "Mops/s", "cycles", "instr", "IPC",
+                    "L1D miss", "LLC miss", "br miss", "ctx sw");
+        std::string reason;
+        const std::pair<int, int> configs[] = {{1, 1}, {1, 2}, {2, 1}, {2, 2}, {4, 4}};
+        for (auto [p, c] : configs) {
+            CircularBuffer buffer(capacity, chunk);
+            Counted counted;
+            const double rate = run_threads(
+                p, c,
+                [&](int) {
+                    auto t = buffer.claim_producer();
+                    if (!t) return 0;
+                    *t->size_ptr = chunk;
+                    return buffer.commit_producer(*t) ? 1 : 0;
+                },
+                [&](int) {
+                    auto t = buffer.claim_consumer();
+                    if (!t) return 0;
+                    buffer.release_consumer(*t);
+                    return 1;
+                },
+                {}, &counted);
+            if (reason.empty()) reason = counted.reason;
+
+            const double ops = counted.ops > 0 ? static_cast<double>(counted.ops) : 1.0;
+            auto cell = [&](PerfCounters::Counter k, char* out, std::size_t n) {
+                if (counted.sample[k]) std::snprintf(out, n, "%.3g", *counted.sample[k] / ops);
+                else std::snprintf(out, n, "n/a");
+            };
+            char cyc[16], ins[16], ipc[16], l1[16], llc[16], br[16], cs[16];
+            cell(PerfCounters::Cycles, cyc, sizeof(cyc));
+            cell(PerfCounters::Instructions, ins, sizeof(ins));
+            cell(PerfCounters::L1dMisses, l1, sizeof(l1));
+            cell(PerfCounters::LlcMisses, llc, sizeof(llc));
+            cell(PerfCounters::BranchMisses, br, sizeof(br));
+            cell(PerfCounters::ContextSwitches, cs, sizeof(cs));
+            const auto& cycles = counted.sample[PerfCounters::Cycles];
+            const auto& instr = counted.sample[PerfCounters::Instructions];
+            if (cycles && instr && *cycles > 0) std::snprintf(ipc, sizeof(ipc), "%.2f", *instr / *cycles);
+            else std::snprintf(ipc, sizeof(ipc), "n/a");
+            std::printf("  %dP/%dC  %8.2f %9s %9s %6s %9s %9s %9s %9s\n", p, c, rate, cyc, ins, ipc, l1, llc, br,
+                        cs);
+        }
+        if (!reason.empty()) std::printf("  (n/a: %s)\n", reason.c_str());
+    }
+
+    // ========================================================================
+    // Bölüm: prefetch — prefetch_distance'a göre chunk boyutu başına GB/s
+    // ========================================================================
+    // 1P/1C, ring ~32 MiB (LLC'den büyük): producer chunk'ın tamamını yazar,
+    // consumer tamamını okur (64-bit toplam). İki consumer yolu: tek tek
+    // claim_consumer ve consume_batch(32). prefetch_bytes varsayılan (256).
+    // İkinci tablo (cold): ring tek thread'le doldurulur, 128 MiB'lık başka
+    // bir bölgeye dokunularak cache'ten atılır, sonra consume_batch ile
+    // boşaltılır (3 tekrarın en iyisi); ilk dokunuş miss'lerini ayırır.
+    // ========================================================================
+    void bench_prefetch() {
+        constexpr std::size_t ring_bytes = 32u << 20;
+        const std::size_t distances[] = {0, 1, 2, 4, 8};
+        std::printf("[prefetch] 1P/1C GB/s consumed, ring %zu MiB, by prefetch_distance\n", ring_bytes >> 20);
+        std::printf("  %-8s %-8s", "chunk", "consumer");
+        for (std::size_t d : distances) std::printf(" %8s%zu", "d=", d);
+        std::printf("\n");
+        for (std::size_t chunk : {64u, 1024u, 4096u, 16384u, 65536u}) {
+            for (int batched = 0; batched < 2; ++batched) {
+                std::printf("  %-8zu %-8s", chunk, batched ? "batch" : "single");
+                for (std::size_t d : distances) {
+                    BufferOptions options;
+                    options.prefetch_distance = d;
+                    CircularBuffer buffer(ring_bytes / chunk, chunk, options);
+                    std::atomic<std::uint64_t> sink{0};
+                    auto read = [&](const CircularBuffer::Ticket& t) {
+                        std::uint64_t sum = *t.size_ptr;
+                        for (std::size_t off = 0; off < chunk; off += 8) {
+                            std::uint64_t v;
+                            std::memcpy(&v, t.cpu_ptr + off, 8);
+                            sum += v;
+                        }
+                        return sum;
+                    };
+                    const double rate = run_threads(
+                        1, 1,
+                        [&](int) {
+                            auto t = buffer.claim_producer();
+                            if (!t) return 0;
+                            std::memset(t->cpu_ptr, 0x11, chunk);
+                            *t->size_ptr = chunk;
+                            return buffer.commit_producer(*t) ? 1 : 0;
+                        },
+                        [&](int) {
+                            std::uint64_t sum = 0;
+                            int got = 0;
+                            if (batched) {
+                                got = static_cast<int>(buffer.consume_batch(
+                                    32, [&](const CircularBuffer::Ticket& t) { sum += read(t); }));
+                            } else if (auto t = buffer.claim_consumer()) {
+                                sum = read(*t);
+                                buffer.release_consumer(*t);
+                                got = 1;
+                            }
+                            sink.fetch_add(sum, std::memory_order_relaxed);
+                            return got;
+                        });
+                    std::printf(" %9.2f", rate * chunk / 1e3);
+                }
+                std::printf("\n");
+            }
+        }
+
+        std::vector<char> evict(128u << 20, 1);
+        for (std::size_t chunk : {64u, 1024u, 4096u, 16384u, 65536u}) {
+            std::printf("  %-8zu %-8s", chunk, "cold");
+            for (std::size_t d : distances) {
+                BufferOptions options;
+                options.prefetch_distance = d;
+                const std::size_t capacity = ring_bytes / chunk;
+                CircularBuffer buffer(capacity, chunk, options);
+                double best = 0;
+                std::uint64_t sum = 0;
+                for (int rep = 0; rep < 3; ++rep) {
+                    for (std::size_t i = 0; i < capacity; ++i) {
+                        auto t = buffer.claim_producer();
+                        std::memset(t->cpu_ptr, 0x11, chunk);
+                        *t->size_ptr = chunk;
+                        buffer.commit_producer(*t);
+                    }
+                    for (std::size_t i = 0; i < evict.size(); i += 64) ++evict[i];
+                    const auto t0 = Clock::now();
+                    while (buffer.consume_batch(32, [&](const CircularBuffer::Ticket& t) {
+                        for (std::size_t off = 0; off < chunk; off += 8) {
+                            std::uint64_t v;
+                            std::memcpy(&v, t.cpu_ptr + off, 8);
+                            sum += v;
+                        }
+                    })) {
+                    }
+                    const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+                    best = std::max(best, ring_bytes / secs / 1e9);
+                }
+                if (sum == 1) std::printf("?");   // Okumaların elenmemesi için
+                std::printf(" %9.2f", best);
+            }
+            std::printf("\n");
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: stream — büyük chunk'larda normal vs non-temporal producer yazımı
+    // ========================================================================
+    // 1P/1C, ring 256 slot. Producer write_chunk ile chunk'ın tamamını yazar
+    // (kaynak cache'te sıcak); streaming_store_threshold = 0 (memcpy) veya
+    // 4096 (NT). Consumer her chunk'ta 1 MiB'lık kendi çalışma kümesini
+    // (L2 boyutunda; ör. lookup tablosu) satır satır tarar; "header" modunda
+    // chunk'ın sadece ilk 64 baytını, "full" modunda tamamını da okur.
+    // Sütunlar: tüketilen chunk/s (bin), tarama başına ortalama ns ve
+    // tüketilen item başına L1D/LLC miss (sayaçlar açılamazsa n/a).
+    // ========================================================================
+    void bench_stream() {
+        constexpr std::size_t capacity = 256;
+        constexpr std::size_t working_set = 1u << 20;
+        std::printf("[stream] 1P/1C, capacity=%zu, consumer sweeps %zu KiB per chunk, nt impl=%s\n", capacity,
+                    working_set >> 10, stream_copy_impl_name());
+        std::printf("  %-6s %-7s %-7s %9s %10s %9s %9s\n", "chunk", "reads", "writes", "Kchunk/s", "sweep ns",
+                    "L1D/item", "LLC/item");
+        std::vector<char> source(64u << 10, 0x5a);
+        std::vector<char> table(working_set, 1);
+        std::string reason;
+        for (std::size_t chunk : {16384u, 32768u, 65536u}) {
+            for (int full = 0; full < 2; ++full) {
+                for (int nt = 0; nt < 2; ++nt) {
+                    BufferOptions options;
+                    options.streaming_store_threshold = nt ? 4096 : 0;
+                    CircularBuffer buffer(capacity, chunk, options);
+                    std::atomic<std::uint64_t> sink{0};
+                    std::atomic<long long> sweep_ns{0};
+                    std::atomic<long long> sweeps{0};
+                    Counted counted;
+                    const double rate = run_threads(
+                        1, 1,
+                        [&](int) {
+                            auto t = buffer.claim_producer();
+                            if (!t) return 0;
+                            buffer.write_chunk(*t, source.data(), chunk);
+                            return buffer.commit_producer(*t) ? 1 : 0;
+                        },
+                        [&](int) {
+                            auto t = buffer.claim_consumer();
+                            if (!t) return 0;
+                            std::uint64_t sum = 0;
+                            const std::size_t bytes = full ? *t->size_ptr : 64;
+                            for (std::size_t off = 0; off < bytes; off += 8) {
+                                std::uint64_t v;
+                                std::memcpy(&v, t->cpu_ptr + off, 8);
+                                sum += v;
+                            }
+                            buffer.release_consumer(*t);
+                            const auto t0 = Clock::now();
+                            for (std::size_t off = 0; off < working_set; off += 64) sum += table[off];
+                            sweep_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   Clock::now() - t0).count(),
+                                               std::memory_order_relaxed);
+                            sweeps.fetch_add(1, std::memory_order_relaxed);
+                            sink.fetch_add(sum, std::memory_order_relaxed);
+                            return 1;
+                        },
+                        {}, &counted);
+                    if (reason.empty()) reason = counted.reason;
+                    const double ops = counted.ops > 0 ? static_cast<double>(counted.ops) : 1.0;
+                    char l1[16], llc[16];
+                    if (counted.sample[PerfCounters::L1dMisses]) {
+                        std::snprintf(l1, sizeof(l1), "%.3g", *counted.sample[PerfCounters::L1dMisses] / ops);
+                    } else {
+                        std::snprintf(l1, sizeof(l1), "n/a");
+                    }
+                    if (counted.sample[PerfCounters::LlcMisses]) {
+                        std::snprintf(llc, sizeof(llc), "%.3g", *counted.sample[PerfCounters::LlcMisses] / ops);
+                    } else {
+                        std::snprintf(llc, sizeof(llc), "n/a");
+                    }
+                    const long long n = std::max(1LL, sweeps.load());
+                    std::printf("  %-6zu %-7s %-7s %9.1f %10.0f %9s %9s\n", chunk, full ? "full" : "header",
+                                nt ? "nt" : "memcpy", rate * 1e3, static_cast<double>(sweep_ns.load()) / n, l1,
+                                llc);
+                }
+            }
+        }
+        if (!reason.empty()) std::printf("  (n/a: %s)\n", reason.c_str());
+    }
+
+    // ========================================================================
+    // Bölüm: ttl — stall sonrası bayat item'ların catch-up süresi
+    // ========================================================================
+    // Ring tek thread'le doldurulur (item_ttl = 1 ms), 2 ms beklenir; sonra
+    // tüm bayat item'lar üç yolla boşaltılır (3 tekrarın en iyisi):
+    //   check : claim_consumer + expiry kontrolü + release (payload okunmaz)
+    //   read  : claim_consumer + chunk'ın tamamını okuma + release
+    //   skip  : skip_expired() (tek head_ CAS'ı + slot başına seq store)
+    // ========================================================================
+    void bench_ttl() {
+        using namespace std::chrono_literals;
+        std::printf("[ttl] catch-up over a full ring of expired items (best of 3)\n");
+        std::printf("  %-9s %-6s %-6s %10s %9s\n", "capacity", "chunk", "mode", "total us", "ns/item");
+        for (std::size_t capacity : {4096u, 65536u}) {
+            for (std::size_t chunk : {64u, 1024u}) {
+                BufferOptions options;
+                options.expiry = true;
+                options.item_ttl = 1ms;
+                CircularBuffer buffer(capacity, chunk, options);
+                std::uint64_t sink = 0;
+                for (const char* mode : {"check", "read", "skip"}) {
+                    double best = 1e30;
+                    for (int rep = 0; rep < 3; ++rep) {
+                        while (auto t = buffer.claim_producer()) {
+                            std::memset(t->cpu_ptr, 0x22, chunk);
+                            *t->size_ptr = chunk;
+                            buffer.commit_producer(*t);
+                        }
+                        std::this_thread::sleep_for(2ms);
+                        const auto t0 = Clock::now();
+                        if (mode[0] == 's') {
+                            while (buffer.skip_expired()) {
+                            }
+                        } else {
+                            const std::uint64_t now = CircularBuffer::steady_now_ns();
+                            while (auto t = buffer.claim_consumer()) {
+                                if (!t->expiry->expired(now)) sink += 1;
+                                if (mode[0] == 'r') {
+                                    for (std::size_t off = 0; off < chunk; off += 8) {
+                                        std::uint64_t v;
+                                        std::memcpy(&v, t->cpu_ptr + off, 8);
+                                        sink += v;
+                                    }
+                                }
+                                buffer.release_consumer(*t);
+                            }
+                        }
+                        const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+                        best = std::min(best, us);
+                    }
+                    std::printf("  %-9zu %-6zu %-6s %10.1f %9.2f\n", capacity, chunk, mode, best,
+                                best * 1e3 / static_cast<double>(capacity));
+                }
+                if (sink == 1) std::printf("?");   // Okumaların elenmemesi için
+            }
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: aggregate — rf metadata'sı üzerinde pencereli kanal özetleri
+    // ========================================================================
+    // Tek thread: girdi ring'i (4096 x 16 B) rf kayıtlarıyla doldurulur,
+    // sonra boşaltılır; sadece boşaltma zamanlanır (~kRunTime toplam).
+    //   ticket : bugünkü yol — claim_consumer ile item item, skaler birikim
+    //   scalar : AggregateStage, simd = false (batch + sütun, skaler)
+    //   simd   : AggregateStage (AVX2 varsa)
+    // Akışlar: single (tek kanal), burst64 (64'lük kanal burst'leri, 8 kanal),
+    // rr8 (round-robin 8 kanal). window_items = 4096. Son sütun girdi item'ı
+    // başına çıktı kaydı oranının tersi (hacim azaltma).
+    // ========================================================================
+    void bench_aggregate() {
+        constexpr std::size_t capacity = 4096;
+        constexpr std::size_t window = 4096;
+        std::printf("[aggregate] single thread drain, window=%zu items, avx2=%s\n", window,
+                    aggregate_detail::has_avx2() ? "yes" : "no");
+        std::printf("  %-8s %-7s %10s %10s\n", "stream", "path", "Mitems/s", "reduction");
+        auto channel_of = [](int pattern, std::size_t i) {
+            if (pattern == 0) return 0;
+            if (pattern == 1) return static_cast<int>((i / 64) % 8);
+            return static_cast<int>(i % 8);
+        };
+        const char* names[] = {"single", "burst64", "rr8"};
+        for (int pattern = 0; pattern < 3; ++pattern) {
+            for (int path = 0; path < 3; ++path) {
+                CircularBuffer in(capacity, 16);
+                CircularBuffer out(capacity, sizeof(WindowSummary));
+                AggregateStage::Config config;
+                config.window_items = window;
+                config.max_channels = 8;
+                config.simd = path == 2;
+                AggregateStage stage(in, out, config);
+                std::vector<aggregate_detail::Acc> accs(8);
+                std::uint64_t ticket_windows = 0, cur_window = 0;
+                double sink = 0;
+
+                std::size_t next = 0;
+                double busy = 0;
+                std::uint64_t items = 0;
+                const auto end = Clock::now() + kRunTime;
+                while (Clock::now() < end) {
+                    while (auto t = in.claim_producer()) {
+                        *t->rf = {channel_of(pattern, next), 1e3 + static_cast<double>(next % 1000)};
+                        in.commit_producer(*t);
+                        ++next;
+                    }
+                    const auto t0 = Clock::now();
+                    if (path == 0) {
+                        while (auto t = in.claim_consumer()) {
+                            if (t->pos / window != cur_window) {
+                                for (auto& a : accs) {
+                                    if (a.count) {
+                                        sink += a.sum / a.count + a.sumsq + a.min + a.max;
+                                        ++ticket_windows;
+                                    }
+                                    a = aggregate_detail::Acc{};
+                                }
+                                cur_window = t->pos / window;
+                            }
+                            auto& a = accs[static_cast<std::size_t>(t->rf->first)];
+                            if (a.count == 0) a.shift = t->rf->second;
+                            aggregate_detail::add_scalar(a, t->rf->second);
+                            in.release_consumer(*t);
+                            ++items;
+                        }
+                    } else {
+                        while (std::size_t n = stage.pump(capacity)) items += n;
+                    }
+                    busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                    while (auto t = out.claim_consumer()) out.release_consumer(*t);
+                }
+                const double records = path == 0 ? static_cast<double>(ticket_windows)
+                                                  : static_cast<double>(stage.stats().summaries);
+                if (sink == 1) std::printf("?");
+                std::printf("  %-8s %-7s %10.1f %9.0fx\n", names[pattern], path == 0 ? "ticket" : path == 1 ? "scalar" : "simd",
+                            static_cast<double>(items) / busy / 1e6, records > 0 ? static_cast<double>(items) / records : 0.0);
+            }
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: fir — FIR + seyreltme, çekirdek başına GS/s (girdi örneği)
+    // ========================================================================
+    // Tek thread. "kernel": FirDecimator::process aynı 4096 örneklik chunk'ı
+    // tekrar tekrar süzer (tek kanal, durum chunk'lar boyunca taşınır).
+    // "stage": FirStage girdi ring'inden (256 x 8 KiB, önceden doldurulmuş)
+    // çıktı ring'ine; sadece pump zamanlanır. GS/s = 1e9 girdi örneği/s.
+    // ========================================================================
+    void bench_fir() {
+        constexpr std::size_t samples = 4096;
+        std::printf("[fir] single core GS/s (input samples), chunk=%zu samples, avx2=%s\n", samples,
+                    fir_detail::has_avx2() ? "yes" : "no");
+        std::printf("  %-6s %-4s %10s %10s %10s %10s\n", "taps", "D", "scalar", "avx2", "speedup", "stage");
+        std::vector<short> input(samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            input[i] = static_cast<short>(8000.0 * std::sin(0.01 * static_cast<double>(i)) + (i * 31) % 257);
+        }
+        std::vector<short> output(samples);
+        for (std::size_t taps : {16u, 32u, 64u, 128u}) {
+            for (std::size_t dec : {4u, 8u}) {
+                const auto h = FirDecimator::lowpass_taps(taps, 0.45 / static_cast<double>(dec));
+                double rate[2];
+                for (int simd = 0; simd < 2; ++simd) {
+                    FirDecimator fir(h, dec, simd != 0);
+                    std::uint64_t done = 0;
+                    const auto t0 = Clock::now();
+                    const auto end = t0 + kRunTime / 2;
+                    while (Clock::now() < end) {
+                        for (int k = 0; k < 16; ++k) fir.process(0, input.data(), samples, output.data());
+                        done += 16 * samples;
+                    }
+                    rate[simd] = static_cast<double>(done) /
+                                 std::chrono::duration<double>(Clock::now() - t0).count() / 1e9;
+                }
+
+                // Stage: ring -> ring (claim/commit ve chunk kopyası dahil)
+                CircularBuffer in(256, samples * sizeof(short));
+                CircularBuffer out(256, samples * sizeof(short));
+                FirStage stage(in, out, h, dec);
+                std::uint64_t staged = 0;
+                double busy = 0;
+                const auto end = Clock::now() + kRunTime / 2;
+                while (Clock::now() < end) {
+                    while (auto t = in.claim_producer()) {
+                        std::memcpy(t->gpu_ptr, input.data(), samples * sizeof(short));
+                        *t->size_ptr = samples * sizeof(short);
+                        *t->rf = {0, 0.0};
+                        in.commit_producer(*t);
+                    }
+                    const auto t0 = Clock::now();
+                    while (std::size_t n = stage.pump(256)) staged += n * samples;
+                    busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                    while (auto t = out.claim_consumer()) out.release_consumer(*t);
+                }
+                std::printf("  %-6zu %-4zu %10.3f %10.3f %9.1fx %10.3f\n", taps, dec, rate[0], rate[1],
+                            rate[1] / rate[0], static_cast<double>(staged) / busy / 1e9);
+            }
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: fft — Pencereli güç spektrumu, çekirdek başına chunk/s
+    // ========================================================================
+    // Tek thread. "kernel": FftPlan::power_spectrum aynı 8 chunk'lık batch'i
+    // tekrar tekrar dönüştürür (skaler derleme vs avx2). "stage": FftStage
+    // girdi ring'inden (256 chunk, önceden doldurulmuş) float çıktı ring'ine;
+    // sadece pump zamanlanır. ns/fft = chunk başına süre, GS/s = girdi örneği.
+    // ========================================================================
+    void bench_fft() {
+        std::printf("[fft] single core power spectrum, batch=%zu chunks, avx2=%s\n", FftPlan::kBatch,
+                    fft_detail::has_avx2() ? "yes" : "no");
+        std::printf("  %-6s %12s %12s %9s %12s %9s %12s\n", "n", "scalar ch/s", "avx2 ch/s", "speedup", "avx2 ns/fft",
+                    "GS/s", "stage ch/s");
+        for (std::size_t n : {256u, 1024u, 4096u}) {
+            std::vector<std::vector<short>> input(FftPlan::kBatch, std::vector<short>(n));
+            for (std::size_t b = 0; b < FftPlan::kBatch; ++b) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    input[b][i] = static_cast<short>(8000.0 * std::sin(0.05 * static_cast<double>(i * (b + 1))) +
+                                                     (i * 31) % 257);
+                }
+            }
+            std::vector<std::vector<float>> output(FftPlan::kBatch, std::vector<float>(n / 2 + 1));
+            const short* src[FftPlan::kBatch];
+            float* dst[FftPlan::kBatch];
+            for (std::size_t b = 0; b < FftPlan::kBatch; ++b) {
+                src[b] = input[b].data();
+                dst[b] = output[b].data();
+            }
+
+            double rate[2];
+            for (int simd = 0; simd < 2; ++simd) {
+                FftPlan plan(n, simd != 0);
+                std::uint64_t done = 0;
+                const auto t0 = Clock::now();
+                const auto end = t0 + kRunTime / 2;
+                while (Clock::now() < end) {
+                    for (int k = 0; k < 8; ++k) plan.power_spectrum(src, FftPlan::kBatch, dst);
+                    done += 8 * FftPlan::kBatch;
+                }
+                rate[simd] = static_cast<double>(done) / std::chrono::duration<double>(Clock::now() - t0).count();
+            }
+
+            // Stage: ring -> ring (batch claim/commit dahil)
+            CircularBuffer in(256, n * sizeof(short));
+            CircularBuffer out(256, (n / 2 + 1) * sizeof(float));
+            FftStage stage(in, out, n);
+            std::uint64_t staged = 0;
+            double busy = 0;
+            const auto end = Clock::now() + kRunTime / 2;
+            while (Clock::now() < end) {
+                std::size_t b = 0;
+                while (auto t = in.claim_producer()) {
+                    std::memcpy(t->gpu_ptr, input[b++ % FftPlan::kBatch].data(), n * sizeof(short));
+                    *t->size_ptr = n * sizeof(short);
+                    *t->rf = {0, 0.0};
+                    in.commit_producer(*t);
+                }
+                const auto t0 = Clock::now();
+                while (std::size_t k = stage.pump(256)) staged += k;
+                busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                while (auto t = out.claim_consumer()) out.release_consumer(*t);
+            }
+            std::printf("  %-6zu %12.0f %12.0f %8.1fx %12.0f %9.3f %12.0f\n", n, rate[0], rate[1], rate[1] / rate[0],
+                        1e9 / rate[1], rate[1] * static_cast<double>(n) / 1e9, static_cast<double>(staged) / busy);
+        }
+    }
+
+    // ========================================================================
+    // Bölüm: detect — Eşik/tepe dedektörü, çekirdek başına GS/s
+    // ========================================================================
+    // Tek thread. 4096 örneklik chunk'lar: ±300 gürültü, burst oranı 0 /
+    // %1 / %10 örnek (64 örneklik burst'ler). "scalar"/"avx2": DetectStage
+    // ring'den ring'e (256 chunk önceden dolu, 4 kanal); sadece pump
+    // zamanlanır. out/in = olay baytı / girdi baytı.
+    // ========================================================================
+    void bench_detect() {
+        constexpr std::size_t samples = 4096;
+        std::printf("[detect] single core GS/s (input samples), chunk=%zu samples, avx2=%s\n", samples,
+                    detect_detail::has_avx2() ? "yes" : "no");
+        std::printf("  %-7s %10s %10s %10s %12s %10s\n", "bursts", "scalar", "avx2", "speedup", "events/s", "out/in");
+        for (double ratio : {0.0, 0.01, 0.10}) {
+            std::vector<short> input(samples * 4);
+            std::uint32_t lcg = 1;
+            for (auto& x : input) {
+                lcg = lcg * 1664525u + 1013904223u;
+                x = static_cast<short>(static_cast<int>(lcg >> 16) % 601 - 300);
+            }
+            const std::size_t bursts = static_cast<std::size_t>(ratio * static_cast<double>(input.size()) / 64);
+            for (std::size_t b = 0; b < bursts; ++b) {
+                const std::size_t at = (b * 7919 * 64) % (input.size() - 64);
+                for (std::size_t k = 0; k < 64; ++k) input[at + k] = static_cast<short>((k % 2 ? -1 : 1) * 9000);
+            }
+
+            double rate[2];
+            double events_per_s = 0, out_in = 0;
+            for (int simd = 0; simd < 2; ++simd) {
+                CircularBuffer in(256, samples * sizeof(short));
+                CircularBuffer out(4096, sizeof(PeakEvent));
+                DetectStage::Config config;
+                config.simd = simd != 0;
+                DetectStage stage(in, out, config);
+                std::uint64_t scanned = 0;
+                double busy = 0;
+                std::size_t c = 0;
+                const auto end = Clock::now() + kRunTime / 2;
+                while (Clock::now() < end) {
+                    while (auto t = in.claim_producer()) {
+                        const std::size_t ch = c++ % 4;
+                        std::memcpy(t->gpu_ptr, input.data() + ch * samples, samples * sizeof(short));
+                        *t->size_ptr = samples * sizeof(short);
+                        *t->rf = {static_cast<int>(ch), 0.0};
+                        in.commit_producer(*t);
+                    }
+                    const auto t0 = Clock::now();
+                    while (std::size_t n = stage.pump(256)) scanned += n * samples;
+                    busy += std::chrono::duration<double>(Clock::now() - t0).count();
+                    while (auto t = out.claim_consumer()) out.release_consumer(*t);
+                }
+                rate[simd] = static_cast<double>(scanned) / busy / 1e9;
+                events_per_s = static_cast<double>(stage.stats().events) / busy;
+                out_in = static_cast<double>(stage.stats().events * sizeof(PeakEvent)) /
+                         static_cast<double>(stage.stats().samples * sizeof(short));
+            }
+            std::printf("  %5.0f%%  %10.3f %10.3f %9.1fx %12.0f %9.5f\n", ratio * 100, rate[0], rate[1],
+                        rate[1] / rate[0], events_per_s, out_in);
+        }
+    }
+
+    struct Section {
+        const char* name;
+        void (*fn)();
+    };
+
+    const Section kSections[] = {
+        {"sharded", bench_sharded},
+        {"lanes", bench_lanes},
+        {"readiness", bench_readiness},
+        {"wait", bench_wait},
+        {"udp", bench_udp},
+        {"recorder", bench_recorder},
+        {"journal", bench_journal},
+        {"capture", bench_capture},
+        {"codec", bench_codec},
+        {"crc", bench_crc},
+        {"placement", bench_placement},
+        {"resize", bench_resize},
+        {"trim", bench_trim},
+        {"counters", bench_counters},
+        {"prefetch", bench_prefetch},
+        {"stream", bench_stream},
+        {"ttl", bench_ttl},
+        {"aggregate", bench_aggregate},
+        {"fir", bench_fir},
+        {"fft", bench_fft},
+        {"detect", bench_detect},
+    };
+}
+
+int main(int argc, char** argv) {
+    for (const auto& s : kSections) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], s.name) == 0) selected = true;
+        }
+        if (selected) s.fn();
+    }
+    return 0;
+}
@@ -0,0 +1,540 @@
+// ============================================================================
+// Capture: Blok yapılı kayıt formatı + zaman/kanal indeksi + replay sürücüsü
+// ============================================================================
+// Regresyon testleri için yakalanan trafiği buffer'ın lane'leriyle birebir
+// (cpu payload, gpu shorts, rf, size) ve zaman damgasıyla saklar.
+//
+// DOSYA FORMATI (little-endian, tüm bölümler 8 bayt hizalı):
+//   FileHeader (64 B)  magic "MPMCCAP1", chunk_size, shorts_per_chunk, flags
+//   Block 0            BlockHeader (64 B) + kayıtlar
+//   Block 1 ...
+//   Index              block_count x IndexEntry (BlockHeader özeti + offset)
+//   Trailer (32 B)     index_offset, block_count, magic
+//
+// Kayıt: RecordHeader (t_ns, rf.first, size, rf.second) + size bayt payload
+// (8'e yuvarlanır) + [kFlagGpuLane ise shorts_per_chunk x short, 8'e yuvarlanır]
+//
+// İNDEKS: Her blok t_first/t_last ve 64 bitlik kanal maskesi (bit = rf.first
+// & 63) tutar. Zaman aralığıyla seek, t_last üzerinde ikili arama; kanal
+// filtresi maskesinde biti olmayan blokları hiç açmaz. Zaman damgaları
+// monoton olmalıdır (writer geri giden damgayı öncekine eşitler).
+//
+// Trailer yoksa (writer close() edilmeden öldü) reader blok başlıklarını
+// sırayla okuyup indeksi yeniden kurar; yarım kalan son blok atılır.
+//
+// Dosya güvenilmez girdi sayılır: trailer, indeks girdileri ve blok
+// başlıkları dosya sonuna göre (taşmasız) doğrulanır; tutmazsa indeks blok
+// başlıklarından yeniden kurulur. Kayıtlar okunurken blok sonuna göre
+// sınırlanır; sığmayan kayıtta bloğun kalanı atlanır.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Dosya formatının sabitleri ve disk üstü yapıları
+struct CaptureFormat {
+    static constexpr std::uint64_t kFileMagic = 0x31504143434D504Dull;     // "MPMCCAP1"
+    static constexpr std::uint64_t kBlockMagic = 0x004B4C42434D504Dull;    // "MPMCBLK"
+    static constexpr std::uint64_t kTrailerMagic = 0x00584449434D504Dull;  // "MPMCIDX"
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kFlagGpuLane = 1;   // Kayıtlar gpu shorts'u da taşır
+
+    struct FileHeader {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint64_t chunk_size;
+        std::uint64_t shorts_per_chunk;
+        std::uint64_t reserved[4];
+    };
+    static_assert(sizeof(FileHeader) == 64, "FileHeader 64 bayt");
+
+    struct BlockHeader {
+        std::uint64_t magic;
+        std::uint64_t bytes;          // Kayıtların toplam boyutu (header hariç)
+        std::uint64_t count;          // Kayıt sayısı
+        std::uint64_t t_first;        // İlk kaydın zamanı (ns)
+        std::uint64_t t_last;         // Son kaydın zamanı (ns)
+        std::uint64_t channel_mask;   // bit (rf.first & 63)
+        std::uint64_t reserved[2];
+    };
+    static_assert(sizeof(BlockHeader) == 64, "BlockHeader 64 bayt");
+
+    struct IndexEntry {
+        std::uint64_t offset;         // BlockHeader'ın dosya offset'i
+        std::uint64_t count;
+        std::uint64_t t_first;
+        std::uint64_t t_last;
+        std::uint64_t channel_mask;
+    };
+
+    struct Trailer {
+        std::uint64_t index_offset;
+        std::uint64_t block_count;
+        std::uint64_t magic;
+        std::uint64_t reserved;
+    };
+
+    struct RecordHeader {
+        std::uint64_t t_ns;
+        std::int32_t channel;         // rf.first
+        std::uint32_t size;           // *size_ptr (payload bayt)
+        double value;                 // rf.second
+    };
+    static_assert(sizeof(RecordHeader) == 24, "RecordHeader 24 bayt");
+
+    static std::size_t pad8(std::size_t v) { return (v + 7) & ~std::size_t{7}; }
+
+    // Kanal maskesi biti (64 kanal üzeri aliaslanır; sadece eleme için)
+    static std::uint64_t channel_bit(int channel) {
+        return std::uint64_t{1} << (static_cast<unsigned>(channel) & 63u);
+    }
+};
+
+// Okunan bir kaydın görünümü (mmap'e işaret eder; reader yaşadıkça geçerli)
+struct CaptureRecord {
+    std::uint64_t t_ns;
+    std::pair<int, double> rf;
+    std::size_t size;
+    const char* payload;
+    const short* gpu;             // FlagGpuLane yoksa nullptr
+};
+
+// ============================================================================
+// CaptureWriter: Consumer tarafında ticket'ları bloklar halinde dosyaya ekler
+// ============================================================================
+// Tek thread'den kullanılır. Blok bellekte toplanır, dolunca tek write()
+// ile yazılır. close() (veya destructor) indeks + trailer'ı ekler.
+// Syscall hataları std::system_error olarak fırlatılır; destructor hatayı
+// yutar, yazma hatasını görmek isteyen close()'u açıkça çağırmalıdır.
+// fd her yolda (hata dahil) kapatılır.
+// ============================================================================
+class CaptureWriter : private CaptureFormat {
+public:
+    struct Config {
+        std::size_t records_per_block = 256;  // Seek çözünürlüğü / indeks boyutu dengesi
+        bool gpu_lane = false;                // gpu shorts'u da kaydet
+    };
+
+    CaptureWriter(const std::string& path, std::size_t chunk_size, std::size_t shorts_per_chunk)
+        : CaptureWriter(path, chunk_size, shorts_per_chunk, Config{}) {}
+    CaptureWriter(const std::string& path, std::size_t chunk_size, std::size_t shorts_per_chunk,
+                  Config config)
+        : config_(config), chunk_size_(chunk_size), shorts_per_chunk_(shorts_per_chunk) {
+        if (config_.records_per_block == 0) config_.records_per_block = 1;
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "capture open");
+        FileHeader h{};
+        h.magic = kFileMagic;
+        h.version = kVersion;
+        h.flags = config_.gpu_lane ? kFlagGpuLane : 0;
+        h.chunk_size = chunk_size_;
+        h.shorts_per_chunk = shorts_per_chunk_;
+        try {
+            write_all(&h, sizeof(h));
+        } catch (...) {
+            close_fd();   // Constructor fırlatınca destructor çalışmaz
+            throw;
+        }
+    }
+
+    // Buffer'ın geometrisiyle
+    CaptureWriter(const std::string& path, const CircularBuffer& buffer)
+        : CaptureWriter(path, buffer, Config{}) {}
+    CaptureWriter(const std::string& path, const CircularBuffer& buffer, Config config)
+        : CaptureWriter(path, buffer.chunk_size(), buffer.shorts_per_chunk(), config) {}
+
+    ~CaptureWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Destructor fırlatamaz (std::terminate); fd close() içinde kapandı
+        }
+    }
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Consumer ticket'ını t_ns zamanıyla kaydeder
+    void append(const CircularBuffer::Ticket& t, std::uint64_t t_ns) {
+        append(t_ns, *t.rf, *t.size_ptr, t.cpu_ptr, t.gpu_ptr);
+    }
+
+    void append(std::uint64_t t_ns, const std::pair<int, double>& rf, std::size_t size,
+                const char* payload, const short* gpu) {
+        if (size > chunk_size_) size = chunk_size_;
+        if (t_ns < last_t_) t_ns = last_t_;   // Monotonluk (indeks ikili araması için)
+        last_t_ = t_ns;
+
+        RecordHeader r{t_ns, rf.first, static_cast<std::uint32_t>(size), rf.second};
+        const std::size_t payload_bytes = pad8(size);
+        const std::size_t gpu_bytes = config_.gpu_lane ? pad8(shorts_per_chunk_ * sizeof(short)) : 0;
+        const std::size_t at = block_.size();
+        block_.resize(at + sizeof(r) + payload_bytes + gpu_bytes, 0);
+        std::memcpy(block_.data() + at, &r, sizeof(r));
+        std::memcpy(block_.data() + at + sizeof(r), payload, size);
+        if (gpu_bytes && gpu) {
+            std::memcpy(block_.data() + at + sizeof(r) + payload_bytes, gpu,
+                        shorts_per_chunk_ * sizeof(short));
+        }
+
+        if (block_count_records_ == 0) current_.t_first = t_ns;
+        current_.t_last = t_ns;
+        current_.channel_mask |= channel_bit(rf.first);
+        ++block_count_records_;
+        ++records_;
+        if (block_count_records_ >= config_.records_per_block) flush_block();
+    }
+
+    // Açık bloğu yazar, indeks + trailer ekler ve dosyayı kapatır
+    void close() {
+        if (fd_ < 0) return;
+        try {
+            flush_block();
+            Trailer tr{offset_, index_.size(), kTrailerMagic, 0};
+            write_all(index_.data(), index_.size() * sizeof(IndexEntry));
+            write_all(&tr, sizeof(tr));
+        } catch (...) {
+            close_fd();
+            throw;
+        }
+        close_fd();
+    }
+
+    std::uint64_t records() const { return records_; }
+    std::size_t blocks() const { return index_.size(); }
+
+private:
+    void close_fd() {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    void flush_block() {
+        if (block_count_records_ == 0) return;
+        BlockHeader bh{};
+        bh.magic = kBlockMagic;
+        bh.bytes = block_.size();
+        bh.count = block_count_records_;
+        bh.t_first = current_.t_first;
+        bh.t_last = current_.t_last;
+        bh.channel_mask = current_.channel_mask;
+        index_.push_back(IndexEntry{offset_, bh.count, bh.t_first, bh.t_last, bh.channel_mask});
+        write_all(&bh, sizeof(bh));
+        write_all(block_.data(), block_.size());
+        block_.clear();
+        block_count_records_ = 0;
+        current_ = IndexEntry{};
+    }
+
+    void write_all(const void* data, std::size_t len) {
+        const char* p = static_cast<const char*>(data);
+        while (len) {
+            const ssize_t w = ::write(fd_, p, len);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "capture write");
+            }
+            p += w;
+            len -= static_cast<std::size_t>(w);
+            offset_ += static_cast<std::uint64_t>(w);
+        }
+    }
+
+    Config config_;
+    std::size_t chunk_size_;
+    std::size_t shorts_per_chunk_;
+    int fd_{-1};
+    std::uint64_t offset_{0};        // Sıradaki yazmanın dosya offset'i
+    std::uint64_t last_t_{0};
+    std::uint64_t records_{0};
+
+    std::vector<char> block_;        // Açık bloğun kayıtları
+    std::size_t block_count_records_{0};
+    IndexEntry current_{};           // Açık bloğun özeti
+    std::vector<IndexEntry> index_;
+};
+
+// ============================================================================
+// CaptureReader: Capture dosyasını mmap eder; indeksle seek, kanal filtresiyle tarar
+// ============================================================================
+class CaptureReader : public CaptureFormat {
+public:
+    // Hata durumunda (fırlatmadan önce) eşleme ve fd bırakılır
+    explicit CaptureReader(const std::string& path) {
+        try {
+            open(path);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~CaptureReader() { release(); }
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // ========================================================================
+    // for_each: [t_begin, t_end] aralığındaki kayıtları sırayla fn(CaptureRecord)'a verir
+    // ========================================================================
+    // channel >= 0 ise sadece o kanal. fn false dönerse tarama durur.
+    // İlk blok ikili aramayla bulunur; aralık dışı ve maskesi uymayan bloklar
+    // açılmaz (sayfaları dokunulmaz).
+    // ========================================================================
+    template <typename Fn>
+    void for_each(std::uint64_t t_begin, std::uint64_t t_end, int channel, Fn&& fn) const {
+        const std::uint64_t want = channel >= 0 ? channel_bit(channel) : ~std::uint64_t{0};
+        for (std::size_t b = first_block(t_begin); b < index_.size(); ++b) {
+            const IndexEntry& e = index_[b];
+            if (e.t_first > t_end) return;
+            if (!(e.channel_mask & want)) continue;
+            BlockHeader bh;
+            std::memcpy(&bh, base_ + e.offset, sizeof(bh));
+            const char* p = base_ + e.offset + sizeof(BlockHeader);
+            const char* end = p + bh.bytes;   // Yükleme sırasında dosya içinde doğrulandı
+            for (std::uint64_t i = 0; i < e.count; ++i) {
+                CaptureRecord r;
+                p = decode(p, end, r);
+                if (!p) break;   // Bozuk kayıt: bloğun kalanı atlanır
+                if (r.t_ns < t_begin) continue;
+                if (r.t_ns > t_end) return;
+                if (channel >= 0 && r.rf.first != channel) continue;
+                if (!fn(r)) return;
+            }
+        }
+    }
+
+    // t'yi içerebilecek ilk blok (t_last >= t); yoksa block_count()
+    std::size_t first_block(std::uint64_t t) const {
+        auto it = std::lower_bound(index_.begin(), index_.end(), t,
+                                   [](const IndexEntry& e, std::uint64_t v) { return e.t_last < v; });
+        return static_cast<std::size_t>(it - index_.begin());
+    }
+
+    const FileHeader& header() const { return header_; }
+    const std::vector<IndexEntry>& index() const { return index_; }
+    std::size_t block_count() const { return index_.size(); }
+    bool index_rebuilt() const { return rebuilt_; }
+    std::uint64_t record_count() const {
+        std::uint64_t n = 0;
+        for (const auto& e : index_) n += e.count;
+        return n;
+    }
+    std::uint64_t t_first() const { return index_.empty() ? 0 : index_.front().t_first; }
+    std::uint64_t t_last() const { return index_.empty() ? 0 : index_.back().t_last; }
+
+private:
+    void open(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "capture open");
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0) throw std::system_error(errno, std::generic_category(), "capture fstat");
+        bytes_ = static_cast<std::size_t>(st.st_size);
+        if (bytes_ < sizeof(FileHeader)) throw std::invalid_argument("capture: file too small: " + path);
+        void* base = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "capture mmap");
+        base_ = static_cast<const char*>(base);
+        ::madvise(base, bytes_, MADV_SEQUENTIAL);
+
+        std::memcpy(&header_, base_, sizeof(header_));
+        if (header_.magic != kFileMagic || header_.version != kVersion) {
+            throw std::invalid_argument("capture: bad header: " + path);
+        }
+        if (!load_index()) rebuild_index();
+    }
+
+    void release() {
+        if (base_) ::munmap(const_cast<char*>(base_), bytes_);
+        if (fd_ >= 0) ::close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+    }
+
+    // p'deki kaydı çözer; kayıt end'e sığmıyorsa nullptr
+    const char* decode(const char* p, const char* end, CaptureRecord& r) const {
+        RecordHeader h;
+        if (static_cast<std::size_t>(end - p) < sizeof(h)) return nullptr;
+        std::memcpy(&h, p, sizeof(h));
+        p += sizeof(h);
+        if (h.size > header_.chunk_size || static_cast<std::size_t>(end - p) < pad8(h.size)) {
+            return nullptr;
+        }
+        r.t_ns = h.t_ns;
+        r.rf = {h.channel, h.value};
+        r.size = h.size;
+        r.payload = p;
+        p += pad8(h.size);
+        r.gpu = nullptr;
+        if (header_.flags & kFlagGpuLane) {
+            // shorts_per_chunk dosyadan gelir: çarpım/pad taşmadan önce sınırla
+            const std::size_t left = static_cast<std::size_t>(end - p);
+            if (header_.shorts_per_chunk > left / sizeof(short) ||
+                pad8(header_.shorts_per_chunk * sizeof(short)) > left) {
+                return nullptr;
+            }
+            r.gpu = reinterpret_cast<const short*>(p);
+            p += pad8(header_.shorts_per_chunk * sizeof(short));
+        }
+        return p;
+    }
+
+    // off'ta [FileHeader sonu, limit) içine tamamen sığan bir blok var mı
+    bool block_fits(std::uint64_t off, std::uint64_t limit, BlockHeader& bh) const {
+        if (off < sizeof(FileHeader) || off > limit || limit - off < sizeof(BlockHeader)) return false;
+        std::memcpy(&bh, base_ + off, sizeof(bh));
+        return bh.magic == kBlockMagic && bh.bytes <= limit - off - sizeof(BlockHeader);
+    }
+
+    // Trailer'dan indeks; trailer yok/bozuksa veya bir girdi tutmuyorsa false
+    bool load_index() {
+        if (bytes_ < sizeof(FileHeader) + sizeof(Trailer)) return false;
+        Trailer tr;
+        std::memcpy(&tr, base_ + bytes_ - sizeof(tr), sizeof(tr));
+        // Çarpım/toplam taşmasın: önce block_count'u kalan alana göre sınırla
+        const std::uint64_t index_end = bytes_ - sizeof(Trailer);
+        if (tr.magic != kTrailerMagic || tr.index_offset < sizeof(FileHeader) ||
+            tr.index_offset > index_end ||
+            tr.block_count > (index_end - tr.index_offset) / sizeof(IndexEntry) ||
+            tr.index_offset + tr.block_count * sizeof(IndexEntry) != index_end) {
+            return false;
+        }
+        index_.resize(tr.block_count);
+        std::memcpy(index_.data(), base_ + tr.index_offset, tr.block_count * sizeof(IndexEntry));
+
+        // Girdiler artan, örtüşmeyen ve indeksten önce biten bloklara işaret etmeli
+        std::uint64_t next = sizeof(FileHeader);
+        for (const IndexEntry& e : index_) {
+            BlockHeader bh;
+            if (e.offset < next || !block_fits(e.offset, tr.index_offset, bh) || bh.count != e.count) {
+                index_.clear();
+                return false;
+            }
+            next = e.offset + sizeof(BlockHeader) + bh.bytes;
+        }
+        return true;
+    }
+
+    // Blok başlıklarını sırayla gezerek indeksi kurar (yarım son blok atılır)
+    void rebuild_index() {
+        rebuilt_ = true;
+        index_.clear();
+        std::uint64_t off = sizeof(FileHeader);
+        BlockHeader bh;
+        while (block_fits(off, bytes_, bh)) {
+            index_.push_back(IndexEntry{off, bh.count, bh.t_first, bh.t_last, bh.channel_mask});
+            off += sizeof(bh) + bh.bytes;
+        }
+    }
+
+    int fd_{-1};
+    const char* base_{nullptr};
+    std::size_t bytes_{0};
+    FileHeader header_{};
+    std::vector<IndexEntry> index_;
+    bool rebuilt_{false};
+};
+
+// ============================================================================
+// CaptureReplay: Capture'ı bir CircularBuffer'a orijinal hızda, N kat veya max hızda basar
+// ============================================================================
+// speed = 1.0 orijinal zamanlama, 4.0 dört kat hızlı, 0 = beklemeden (max).
+// Zamanlama: kayıt i'nin hedef anı = başlangıç + (t_i - t_0) / speed;
+// erkenden sleep_until, sonrası hemen. Hedefin gerisinde kalınan kayıtlar
+// `late` sayılır (consumer yavaş / ring dolu). Ring doluysa
+// claim_producer_wait ile beklenir (kayıt düşürülmez).
+// Payload hedef chunk_size'tan büyükse kesilir.
+// ============================================================================
+class CaptureReplay {
+public:
+    struct Config {
+        double speed = 1.0;
+        std::uint64_t t_begin = 0;
+        std::uint64_t t_end = ~std::uint64_t{0};
+        int channel = -1;                                   // -1: tüm kanallar
+        std::chrono::microseconds late_threshold{1000};     // Bu kadar geride = late
+    };
+
+    struct Stats {
+        std::uint64_t records = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t late = 0;
+        double seconds = 0.0;
+    };
+
+    CaptureReplay(const CaptureReader& reader, CircularBuffer& buffer)
+        : CaptureReplay(reader, buffer, Config{}) {}
+    CaptureReplay(const CaptureReader& reader, CircularBuffer& buffer, Config config)
+        : reader_(reader), buffer_(buffer), config_(config) {}
+
+    // Aralığı sonuna kadar (veya stop true olana / buffer stop edilene kadar) oynatır
+    Stats run(const std::atomic<bool>* stop = nullptr) {
+        using SteadyClock = std::chrono::steady_clock;
+        Stats st;
+        const auto start = SteadyClock::now();
+        bool have_origin = false;
+        std::uint64_t origin = 0;
+        const std::size_t chunk = buffer_.chunk_size();
+        const std::size_t shorts = std::min<std::size_t>(buffer_.shorts_per_chunk(),
+                                                         reader_.header().shorts_per_chunk);
+
+        reader_.for_each(config_.t_begin, config_.t_end, config_.channel, [&](const CaptureRecord& r) {
+            if (stop && stop->load(std::memory_order_relaxed)) return false;
+            if (!have_origin) {
+                origin = r.t_ns;
+                have_origin = true;
+            }
+            if (config_.speed > 0.0) {
+                const auto offset = std::chrono::nanoseconds(
+                    static_cast<std::int64_t>(static_cast<double>(r.t_ns - origin) / config_.speed));
+                const auto due = start + offset;
+                const auto now = SteadyClock::now();
+                if (now < due) {
+                    std::this_thread::sleep_until(due);
+                } else if (now - due > config_.late_threshold) {
+                    ++st.late;
+                }
+            }
+
+            auto t = buffer_.claim_producer_wait();
+            if (t) {
+                const std::size_t n = std::min(r.size, chunk);
+                std::memcpy(t->cpu_ptr, r.payload, n);
+                if (r.gpu) std::memcpy(t->gpu_ptr, r.gpu, shorts * sizeof(short));
+                *t->rf = r.rf;
+                *t->size_ptr = n;
+                buffer_.commit_producer(*t);   // Claim özel: commit kaybedilmez
+                ++st.records;
+                st.bytes += n;
+            }
+            return static_cast<bool>(t);   // Buffer stop edildi
+        });
+        st.seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+        return st;
+    }
+
+private:
+    const CaptureReader& reader_;
+    CircularBuffer& buffer_;
+    Config config_;
+};
+
@@ -0,0 +1,1755 @@
+// ============================================================================
+// Lock-free MPMC (Multiple Producer Multiple Consumer) Halka Buffer
+// ============================================================================
+// Bu implementasyon, lock-free (kilit kullanmayan) bir circular buffer sağlar.
+// 
+// TEMEL TASARIM:
+// - Slot içinde veri tutulmuyor; tek bir büyük CPU char dizisi (data_cpu_) var
+// - GPU tarafı simülasyonu için short dizisi (data_gpu_) var
+// - Sabit chunk_size ile bu diziler chunk'lara bölünür
+// - Her slot bir sequence counter tutar (seq) - bu lock-free senkronizasyon için kritik
+// - Ek metadata: rfSignal (std::pair<int,double>) ve size (std::size_t)
+// - Producer: claim -> chunk pointer al (cpu_ptr, gpu_ptr, rf, size_ptr) -> doldur -> commit
+// - Consumer: claim -> pointer'ları al -> oku -> release
+//
+// LOCK-FREE ALGORİTMA:
+// Sequence counter pattern kullanılıyor. Her slot'un bir "beklenen sıra numarası" var:
+// - Boş slot: seq == pos (slot'un global pozisyonu)
+// - Dolu slot: seq == pos + 1 (producer doldurdu, consumer bekliyor)
+// - Yeniden boş: seq == pos + capacity (consumer okudu, producer tekrar kullanabilir)
+//
+// Bu sayede mutex/condition_variable olmadan thread-safe çalışma sağlanır.
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <linux/futex.h>
+#include <malloc.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "crc32c.hpp"
+#include "journal_file.hpp"
+#include "stream_copy.hpp"
+#include "trace.hpp"
+
+// İzleme kancaları (bkz. trace.hpp): MPMC_TRACE tanımlı değilse tamamen boş
+#ifdef MPMC_TRACE
+#define MPMC_TRACE_EVENT(ev, pos, n) ::mpmc_trace::emit(::mpmc_trace::Event::ev, trace_ring_, (pos), (n))
+#else
+#define MPMC_TRACE_EVENT(ev, pos, n) ((void)0)
+#endif
+
+// ============================================================================
+// WaitStrategy: Blocking claim'lerde (claim_*_wait) bekleme politikası
+// ============================================================================
+// Latency-kritik link'ler izole çekirdeklerde spin eder; arka plan link'leri
+// paylaşılan çekirdeklerde CPU'yu bırakmalıdır. Strateji producer ve
+// consumer tarafı için ayrı seçilir (BufferOptions::producer_wait/consumer_wait).
+//
+// - BusySpin : Her denemede tek _mm_pause; en düşük latency, %100 CPU
+// - PauseSpin: Exponential _mm_pause (1, 2, 4, ... 1024), sonra yield
+// - Yield    : Her denemede std::this_thread::yield()
+// - Sleep    : Her denemede BufferOptions::sleep_interval kadar uyur
+// - Park     : Kısa spin, sonra futex ile uyur; karşı taraf commit/release'te
+//              uyandırır (sadece Park seçiliyse karşı tarafa maliyet eklenir)
+// ============================================================================
+enum class WaitStrategy { BusySpin, PauseSpin, Yield, Sleep, Park };
+
+inline const char* wait_strategy_name(WaitStrategy w) {
+    switch (w) {
+        case WaitStrategy::BusySpin: return "busy-spin";
+        case WaitStrategy::PauseSpin: return "pause-spin";
+        case WaitStrategy::Yield: return "yield";
+        case WaitStrategy::Sleep: return "sleep";
+        case WaitStrategy::Park: return "park";
+    }
+    return "?";
+}
+
+// trim_idle()'ın boş chunk sayfaları için madvise tavsiyesi
+// - DontNeed: Sayfalar hemen bırakılır (RSS anında düşer); sonraki yazım
+//             sıfır sayfa fault'u alır
+// - Free    : Kernel sayfaları sadece bellek baskısında geri alır (RSS
+//             baskı gelene kadar düşmeyebilir); geri alınmadan yazılırsa
+//             fault yok. Kernel desteklemiyorsa DontNeed'e düşer.
+enum class TrimAdvice { DontNeed, Free };
+
+inline const char* trim_advice_name(TrimAdvice a) {
+    return a == TrimAdvice::Free ? "free" : "dontneed";
+}
+
+// ============================================================================
+// ItemExpiry: Slot başına commit zamanı ve TTL (BufferOptions::expiry)
+// ============================================================================
+// commit_ns: commit_producer'ın tail_ CAS'ından sonraki steady_clock zamanı
+// (ns). ttl_ns: 0 = süresiz. Item now - commit_ns >= ttl_ns olunca bayattır.
+// ============================================================================
+struct ItemExpiry {
+    std::uint64_t commit_ns;
+    std::uint64_t ttl_ns;
+
+    // now_ns < commit_ns (çağıranın saati commit'ten önce okunmuş): taze
+    bool expired(std::uint64_t now_ns) const {
+        return ttl_ns != 0 && now_ns >= commit_ns && now_ns - commit_ns >= ttl_ns;
+    }
+};
+
+// CPU'ya spin-wait ipucu (x86: PAUSE; SMT kardeşine pipeline bırakır)
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// ============================================================================
+// AlignedBuffer: Hizalı, sahipli sabit boyutlu dizi (data_cpu_ için)
+// ============================================================================
+// std::vector<char> en fazla alignof(max_align_t) hizalama verir; O_DIRECT ve
+// io_uring registered buffer'lar sayfa/sektör hizası ister. Bellek sıfırlanır.
+// ============================================================================
+template <typename T>
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    ~AlignedBuffer() { std::free(data_); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& o) noexcept : data_(o.data_), size_(o.size_) {
+        o.data_ = nullptr;
+        o.size_ = 0;
+    }
+    AlignedBuffer& operator=(AlignedBuffer&& o) noexcept {
+        if (this != &o) {
+            std::free(data_);
+            data_ = o.data_;
+            size_ = o.size_;
+            o.data_ = nullptr;
+            o.size_ = 0;
+        }
+        return *this;
+    }
+
+    // count eleman ayırır; alignment 2'nin kuvveti olmalı (0 -> alignof(T))
+    void allocate(std::size_t count, std::size_t alignment) {
+        std::free(data_);
+        if (alignment < alignof(T)) alignment = alignof(T);
+        std::size_t bytes = count * sizeof(T);
+        bytes = (bytes + alignment - 1) / alignment * alignment;  // aligned_alloc şartı
+        if (bytes == 0) bytes = alignment;
+        data_ = static_cast<T*>(std::aligned_alloc(alignment, bytes));
+        if (!data_) throw std::bad_alloc();
+        std::memset(static_cast<void*>(data_), 0, bytes);
+        size_ = count;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    T* data_{nullptr};
+    std::size_t size_{0};
+};
+
+// ============================================================================
+// BufferOptions: CircularBuffer'ın isteğe bağlı özellikleri
+// ============================================================================
+// Varsayılan değerlerle buffer orijinal davranışını korur; her seçenek ek bir
+// metadata lane'i veya commit/claim yolunda ek iş anlamına gelir.
+// ============================================================================
+struct BufferOptions {
+    // Slot metadata'sına producer başına artan sıra numarası lane'i ekler
+    // (Ticket::seq_ptr). Kapalıyken seq_ptr == nullptr.
+    bool sequence_tracking = false;
+
+    // Consumer'lar için eventfd: ring boştan doluya geçince okunabilir olur
+    // (event_fd(), arm_readiness(), drain_readiness()). epoll döngüsünde
+    // bloklanmadan bekleyen consumer'lar için.
+    bool readiness_fd = false;
+
+    // claim_producer_wait / claim_consumer_wait bekleme stratejileri
+    WaitStrategy producer_wait = WaitStrategy::PauseSpin;
+    WaitStrategy consumer_wait = WaitStrategy::PauseSpin;
+    std::chrono::microseconds sleep_interval{50};   // WaitStrategy::Sleep adımı
+
+    // data_cpu_ başlangıç hizası (2'nin kuvveti). O_DIRECT/io_uring kayıt için
+    // 4096 ve chunk_size'ı bu değerin katı seçin.
+    std::size_t data_alignment = 64;
+
+    // Yazılımsal prefetch: claim'lerde sonraki prefetch_distance'ıncı slot'un
+    // chunk'ının ilk prefetch_bytes baytı ve metadata satırları cache'e
+    // istenir. Producer: claim ettiği pos + d slot'u yazmak için (PREFETCHW);
+    // consumer: claim_consumer'da pos + d, claim_consumer_batch'te batch'in
+    // ilk d slot'u, consume_batch'te işlenen slot'un d ilerisi. 0 = kapalı.
+    // Ardışık chunk'ları donanım prefetcher'ı zaten izler; kazanç platforma
+    // bağlıdır, "./bench prefetch" ile hedef makinede ayarlayın (varsayılan
+    // kapalı; bkz. README).
+    std::size_t prefetch_distance = 0;
+    std::size_t prefetch_bytes = 256;
+
+    // write_chunk() bu boyuttan (bayt) büyük/eşit payload'ları non-temporal
+    // store ile yazar (bkz. stream_copy.hpp); consumer'ın cache'teki çalışma
+    // kümesi producer yazımlarıyla dışarı atılmaz. Açıkken commit_producer
+    // seq store'undan önce sfence yapar. 0 = kapalı (her zaman memcpy).
+    // Consumer chunk'ı hemen okuyacaksa NT store veriyi bellekten geri
+    // okutur; 16-64 KiB chunk ve L2'yi dolduran consumer durumları içindir.
+    std::size_t streaming_store_threshold = 0;
+
+    // Chunk başına CRC32C lane'i (Ticket::crc_ptr). commit_producer
+    // rf + size + cpu_ptr[0..size) üzerinden hesaplar (bkz. crc32c.hpp).
+    // verify_on_claim: claim_consumer* her chunk'ı doğrular; uyuşmazlıklar
+    // checksum_mismatches()'ta sayılır (item yine teslim edilir).
+    bool checksum = false;
+    bool verify_on_claim = false;
+
+    // Commit zamanı + TTL lane'i (Ticket::expiry). commit_producer(t) item_ttl
+    // ile, commit_producer(t, ttl) item başına TTL ile yazar (0 = süresiz).
+    // skip_expired() head'teki bayat item'ları tek head_ ilerlemesiyle atlar.
+    // Zamanlar steady_clock'tur; journal modunda lane kalıcı değildir
+    // (kurtarılan item'lar süresiz sayılır).
+    bool expiry = false;
+    std::chrono::nanoseconds item_ttl{0};
+
+    // Online resize (resize()): claim'ler ile resize arasında bir kapı açar.
+    // Her claim/commit/release ek bir atomik sayaç güncellemesi yapar; bu
+    // yüzden varsayılan kapalı. Açıkken claim edilip commit edilmeyecek
+    // producer ticket'ları abandon_producer() ile bırakılmalıdır.
+    bool resizable = false;
+
+    // Boş chunk belleğinin OS'e iadesi (trim_idle(), bkz. memory_trimmer.hpp).
+    // resize ile aynı kapıyı kullanır; kapı maliyeti resizable ile aynıdır.
+    // Sayfa sınırına denk gelen chunk'lar için data_alignment = 4096 ve
+    // chunk_size'ı sayfanın katı seçin (aksi halde kenar sayfalar atlanır).
+    bool trimmable = false;
+    TrimAdvice trim_advice = TrimAdvice::DontNeed;
+
+    // Journal modu: boş değilse tüm lane'ler (slot seq, chunk'lar, metadata)
+    // bu dosyanın mmap'inde yaşar; yeniden açılışta tüketilmemiş item'lar
+    // korunur (bkz. journal_file.hpp). Sync tetikleyicileri bağımsızdır:
+    // her journal_sync_items commit'te (commit eden producer) ve/veya her
+    // journal_sync_interval'de (arka plan flusher thread'i). İkisi de 0 ise
+    // sadece sync_journal() ve kapanış.
+    std::string journal_path;
+    JournalSync journal_sync = JournalSync::Msync;
+    std::size_t journal_sync_items = 0;
+    std::chrono::milliseconds journal_sync_interval{0};
+};
+
+// Birden çok CircularBuffer kuran sarmalayıcılar (ShardedBuffer, LaneBuffer,
+// RoutedBuffer) için alt buffer seçenekleri: journal dosyası paylaşılamaz,
+// her alt buffer "<journal_path>.<index>" dosyasını kullanır.
+inline BufferOptions sub_buffer_options(const BufferOptions& options, std::size_t index) {
+    BufferOptions sub = options;
+    if (!sub.journal_path.empty()) sub.journal_path += "." + std::to_string(index);
+    return sub;
+}
+
+// ============================================================================
+// Lock-free Bounded MPMC Ring Buffer
+// ============================================================================
+// Bu sınıf, sequence counter pattern kullanarak lock-free çalışan bir circular
+// buffer implementasyonu sağlar. Veri tek bir büyük char dizisinde tutulur ve
+// sabit chunk_size ile bölünür. Her chunk bir slot'a karşılık gelir.
+//
+// ÖNEMLİ: Bu implementasyon wait-free değil, lock-free'dur. Yani bazı thread'ler
+// diğerlerini bekleyebilir ama hiçbir thread mutex/condition_variable ile bloke
+// olmaz - sadece spin/yield yapar.
+// ============================================================================
+class CircularBuffer {
+public:
+    // Producer/Consumer'ın claim ettiği slot bilgisini taşır
+    struct Ticket {
+        std::size_t pos;               // Slot'un global pozisyon numarası (ring buffer'da döngüsel)
+        char* cpu_ptr;                 // CPU tarafı (char) chunk başlangıcı
+        short* gpu_ptr;                // GPU tarafı (simüle) short chunk başlangıcı
+        std::pair<int, double>* rf;    // Ek metadata: rfSignal
+        std::size_t* size_ptr;         // Ek metadata: yazılan byte sayısı
+        std::uint64_t* seq_ptr;        // Ek metadata: producer sıra numarası (kapalıysa nullptr)
+        std::uint32_t* crc_ptr;        // Ek metadata: CRC32C (checksum kapalıysa nullptr)
+        ItemExpiry* expiry;            // Ek metadata: commit zamanı + TTL (expiry kapalıysa nullptr)
+    };
+
+    // ========================================================================
+    // RAII Wrapper: Producer Ticket - Exception safety için
+    // ========================================================================
+    // Bu class, claim_producer() sonrası otomatik commit_producer() çağırır.
+    // Producer fail olsa bile (exception, early return) slot kaybolmaz.
+    // ========================================================================
+    class ProducerTicket {
+    public:
+        ProducerTicket(CircularBuffer* buffer, Ticket ticket)
+            : buffer_(buffer), ticket_(ticket), committed_(false) {}
+        
+        ~ProducerTicket() {
+            if (!committed_ && buffer_) {
+                // Exception veya early return durumunda otomatik commit
+                buffer_->commit_producer(ticket_);
+            }
+        }
+        
+        // Copy/move delete - sadece bir instance olmalı
+        ProducerTicket(const ProducerTicket&) = delete;
+        ProducerTicket& operator=(const ProducerTicket&) = delete;
+        ProducerTicket(ProducerTicket&&) = delete;
+        ProducerTicket& operator=(ProducerTicket&&) = delete;
+        
+        // Manuel commit (normal kullanım)
+        void commit() {
+            if (!committed_ && buffer_) {
+                buffer_->commit_producer(ticket_);
+                committed_ = true;
+            }
+        }
+        
+        // Ticket'a erişim
+        Ticket& get() { return ticket_; }
+        const Ticket& get() const { return ticket_; }
+        Ticket* operator->() { return &ticket_; }
+        const Ticket* operator->() const { return &ticket_; }
+        
+    private:
+        CircularBuffer* buffer_;
+        Ticket ticket_;
+        bool committed_;
+    };
+
+    // ========================================================================
+    // RAII Wrapper: Consumer Ticket - Exception safety için
+    // ========================================================================
+    // Bu class, claim_consumer() sonrası otomatik release_consumer() çağırır.
+    // Consumer fail olsa bile slot kaybolmaz.
+    // ========================================================================
+    class ConsumerTicket {
+    public:
+        ConsumerTicket(CircularBuffer* buffer, Ticket ticket)
+            : buffer_(buffer), ticket_(ticket), released_(false) {}
+        
+        ~ConsumerTicket() {
+            if (!released_ && buffer_) {
+                // Exception veya early return durumunda otomatik release
+                buffer_->release_consumer(ticket_);
+            }
+        }
+        
+        // Copy/move delete
+        ConsumerTicket(const ConsumerTicket&) = delete;
+        ConsumerTicket& operator=(const ConsumerTicket&) = delete;
+        ConsumerTicket(ConsumerTicket&&) = delete;
+        ConsumerTicket& operator=(ConsumerTicket&&) = delete;
+        
+        // Manuel release (normal kullanım)
+        void release() {
+            if (!released_ && buffer_) {
+                buffer_->release_consumer(ticket_);
+                released_ = true;
+            }
+        }
+        
+        // Ticket'a erişim
+        Ticket& get() { return ticket_; }
+        const Ticket& get() const { return ticket_; }
+        Ticket* operator->() { return &ticket_; }
+        const Ticket* operator->() const { return &ticket_; }
+        
+    private:
+        CircularBuffer* buffer_;
+        Ticket ticket_;
+        bool released_;
+    };
+
+    // Constructor: buffer'ı belirtilen kapasite ve chunk boyutu ile başlatır
+    CircularBuffer(std::size_t capacity_chunks, std::size_t chunk_size,
+                   const BufferOptions& options = {})
+        : chunk_size_(chunk_size), options_(options) {
+        // Kapasiteyi 2'nin kuvveti yap (ör: 7 -> 8, 9 -> 16)
+        // Bu sayede mod işlemi (pos % capacity) yerine bitwise AND (pos & mask) kullanabiliriz
+        // Bitwise AND çok daha hızlıdır ve performans kritik bir noktadır
+        capacity_ = 1;
+        while (capacity_ < capacity_chunks) capacity_ <<= 1;  // power of two
+        // Journal kurtarması dolu/boş slot'u seq'ten ayırt eder: en az 2 slot
+        if (!options_.journal_path.empty() && capacity_ < 2) capacity_ = 2;
+        
+        // Mask: capacity 8 ise mask = 7 (binary: 0111)
+        // pos & mask işlemi pos % capacity ile aynı sonucu verir ama çok daha hızlı
+        mask_ = capacity_ - 1;
+        
+        // "GPU" (simülasyon) için short dizisi: chunk_size / sizeof(short) kadar eleman
+        shorts_per_chunk_ = chunk_size_ / sizeof(short);
+        if (shorts_per_chunk_ == 0) shorts_per_chunk_ = 1;  // emniyet
+
+        // Lane depolaması: journal dosyası (kalıcı) veya heap
+        if (!options_.journal_path.empty()) {
+            open_journal();
+        } else {
+            allocate_lanes();
+        }
+
+        // eventfd: non-blocking; sayaç drain_readiness() ile sıfırlanır
+        if (options_.readiness_fd) event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    ~CircularBuffer() {
+        if (journal_) {
+            stop_flusher();
+            sync_journal();
+            journal_->header().clean_shutdown = 1;
+            journal_->sync(options_.journal_sync);
+        }
+        if (event_fd_ >= 0) ::close(event_fd_);
+    }
+
+    CircularBuffer(const CircularBuffer&) = delete;
+    CircularBuffer& operator=(const CircularBuffer&) = delete;
+
+    // ========================================================================
+    // Producer: Boş bir slot'u claim eder (non-blocking)
+    // ========================================================================
+    // Kuyruk doluysa, tail_ slot'u başka bir producer'da yazılıyorsa veya
+    // shutdown ise hemen std::nullopt döner. Başarıyla claim ederse Ticket
+    // döner; devamında commit_producer() (veya abandon_producer()) çağrılmalı.
+    //
+    // Claim ÖZELDİR: slot seq'i pos -> pos | kClaimed CAS'ı ile işaretlenir;
+    // CAS'ı kaybeden producer slot'a hiç yazmaz. Böylece iki producer aynı
+    // slot'un payload/metadata'sını karıştıramaz.
+    // ========================================================================
+    std::optional<Ticket> claim_producer() {
+        // Shutdown kontrolü
+        if (shutdown_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        // Resize sürüyorsa ring "dolu" gibi davranır
+        if (!enter_gate()) return std::nullopt;
+
+        // tail_: son yazılan pozisyon (atomik) - sadece okuyoruz, artırmıyoruz
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+
+        // Ring buffer index
+        Slot& slot = slots_[pos & mask_];
+
+        // Slot'un sequence değerini oku
+        std::size_t seq = slot.seq.load(std::memory_order_acquire);
+
+        // diff = seq - pos
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        // Slot boş: seq'i claim işaretiyle kilitle (kazanan tek producer yazar)
+        if (diff == 0 && slot.seq.compare_exchange_strong(seq, pos | kClaimed, std::memory_order_acquire,
+                                                           std::memory_order_relaxed)) {
+            // tail_ artırmıyoruz; tail_ commit_producer() içinde artırılacak
+            MPMC_TRACE_EVENT(ProducerClaim, pos, 1);
+            if (options_.prefetch_distance) prefetch_slot<true>(pos + options_.prefetch_distance);
+            return make_ticket(pos);
+        }
+
+        // Slot dolu (diff < 0), başka producer'da (kClaimed) veya CAS kaybedildi → dolu gibi çık
+        MPMC_TRACE_EVENT(Full, pos, 1);
+        leave_gate();
+        return std::nullopt;
+    }
+
+    // ========================================================================
+    // write_chunk: Payload'ı claim edilmiş slot'un chunk'ına kopyalar
+    // ========================================================================
+    // n >= streaming_store_threshold ise non-temporal store (stream_copy),
+    // aksi halde memcpy. *size_ptr = n yazılır; n chunk_size ile sınırlanır.
+    // Dönüş: yazılan bayt sayısı.
+    // ========================================================================
+    std::size_t write_chunk(const Ticket& t, const void* src, std::size_t n) {
+        n = std::min(n, chunk_size_);
+        if (options_.streaming_store_threshold && n >= options_.streaming_store_threshold) {
+            stream_copy(t.cpu_ptr, src, n);
+        } else {
+            std::memcpy(t.cpu_ptr, src, n);
+        }
+        *t.size_ptr = n;
+        return n;
+    }
+
+    // ========================================================================
+    // Producer: Chunk'ı doldurduktan sonra slot'u consumer'lara açık hale getirir
+    // ========================================================================
+    // Bu fonksiyon claim_producer()'dan sonra MUTLAKA çağrılmalı!
+    //
+    // tail_ burada artırılır (claim_producer()'da değil).
+    // Sequence'i pos+1 yaparak slot'u "dolu" olarak işaretleriz.
+    // Consumer'lar seq == pos+1 olduğunu görünce bu slot'u okuyabilir.
+    //
+    // memory_order_release: Bu yazıdan önceki tüm yazılar (chunk içine yazılan
+    // veriler) consumer'lar tarafından görülebilir hale gelir.
+    //
+    // Dönüş değeri: slot yayınlandıysa true. Claim özel olduğundan tek slot'luk
+    // ticket'lar için commit her zaman başarılıdır; false sadece
+    // claim_producer_batch ticket'ları sırasız commit edildiğinde döner
+    // (kullanım hatası: slot yayınlanmaz ve boşa çıkarılır).
+    // ========================================================================
+    bool commit_producer(const Ticket& t) { return commit_producer(t, options_.item_ttl); }
+
+    // Item başına TTL ile commit (BufferOptions::expiry kapalıysa ttl yok sayılır)
+    bool commit_producer(const Ticket& t, std::chrono::nanoseconds ttl) {
+        // write_chunk'ın streaming store'ları zayıf sıralıdır: release store
+        // bunları sıralamaz, seq yayınından önce sfence şart
+        if (options_.streaming_store_threshold) stream_fence();
+
+        // Checksum CAS'tan önce: slot bu ticket'a özel olduğundan chunk'ı kimse
+        // değiştiremez; tail_ ilerleyip seq yayınlanana kadarki pencere (bu
+        // arada consumer'lar slot'u bekler) CRC süresi kadar uzamaz
+        if (crc_lane_) *t.crc_ptr = chunk_checksum(t);
+
+        // tail_ artır: CAS ile atomik olarak ilerlet
+        // Sadece t.pos == tail_ ise artır (slot bu ticket'a özel claim edildiğinden
+        // tail_ == t.pos; aksi sadece sırasız batch commit'inde olur)
+        //
+        // seq_cst: arm_readiness() ile Dekker eşlemesi için (x86'da lock cmpxchg
+        // zaten tam bariyer; ek maliyet yok)
+        std::size_t expected = t.pos;
+        if (!tail_.compare_exchange_strong(expected, t.pos + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            // Sırasız batch commit'i: slot yayınlanmaz, claim işareti kaldırılır
+            MPMC_TRACE_EVENT(CommitLost, t.pos, 1);
+            slots_[t.pos & mask_].seq.store(t.pos, std::memory_order_release);
+            leave_gate();
+            return false;
+        }
+
+        if (expiry_lane_) {
+            const auto ttl_ns = static_cast<std::uint64_t>(std::max<std::int64_t>(ttl.count(), 0));
+            *t.expiry = ItemExpiry{steady_now_ns(), ttl_ns};
+        }
+
+        // Sequence'i pos+1 yap = "Bu slot dolu, consumer okuyabilir" sinyali
+        MPMC_TRACE_EVENT(Commit, t.pos, 1);   // Store'dan önce: consumer claim'inden erken
+        slots_[t.pos & mask_].seq.store(t.pos + 1, std::memory_order_release);
+        leave_gate();
+
+        // Journal: her N commit'te bir, N'inci commit'i yapan producer sync eder
+        if (options_.journal_sync_items != 0 &&
+            journal_commits_.fetch_add(1, std::memory_order_relaxed) % options_.journal_sync_items ==
+                options_.journal_sync_items - 1) {
+            sync_journal();
+        }
+
+        // Boş -> dolu geçişi: sadece bekleyen (armed) consumer varsa syscall
+        if (event_fd_ >= 0 && readiness_armed_.load(std::memory_order_seq_cst)) {
+            signal_readiness();
+        }
+        // Park eden consumer varsa bir tanesini uyandır (tail_ CAS ile Dekker)
+        if (options_.consumer_wait == WaitStrategy::Park &&
+            consumers_parked_.load(std::memory_order_seq_cst) != 0) {
+            wake(consumer_futex_, 1);
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // Blocking claim'ler: WaitStrategy ile bekler
+    // ========================================================================
+    // Slot/veri bulunana, timeout dolana veya stop() çağrılana kadar bekler.
+    // Bekleme biçimi BufferOptions::producer_wait / consumer_wait'tir.
+    // claim_consumer_wait, stop() sonrası kalan item'ları boşaltmaya devam eder;
+    // ring boşsa nullopt döner.
+    // ========================================================================
+    std::optional<Ticket> claim_producer_wait(
+        std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) {
+        Waiter w(options_.producer_wait, options_.sleep_interval, deadline_for(timeout));
+        while (true) {
+            if (auto t = claim_producer()) return t;
+            if (shutdown_.load(std::memory_order_acquire)) return std::nullopt;
+            if (w.should_park()) {
+                // Park: sayaç + futex değeri + yeniden kontrol (lost wake-up yok)
+                producers_parked_.fetch_add(1, std::memory_order_seq_cst);
+                const std::uint32_t v = producer_futex_.load(std::memory_order_seq_cst);
+                const std::size_t pos = tail_.load(std::memory_order_seq_cst);
+                bool has_space = true;   // Resize sürüyorsa park etme, tekrar dene
+                if (enter_gate()) {
+                    // kClaimed: başka producer yazıyor, commit'i beklenir (park etme)
+                    const std::size_t seq = slots_[pos & mask_].seq.load(std::memory_order_seq_cst);
+                    has_space = seq == pos || seq == (pos | kClaimed) ||
+                                tail_.load(std::memory_order_seq_cst) != pos;
+                    leave_gate();
+                }
+                if (!has_space && !shutdown_.load(std::memory_order_seq_cst)) {
+                    w.park(producer_futex_, v);
+                }
+                producers_parked_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                w.pause();
+            }
+            if (w.expired()) return std::nullopt;
+        }
+    }
+
+    std::optional<Ticket> claim_consumer_wait(
+        std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) {
+        Waiter w(options_.consumer_wait, options_.sleep_interval, deadline_for(timeout));
+        while (true) {
+            if (auto t = claim_consumer()) return t;
+            const std::size_t h = head_.load(std::memory_order_seq_cst);
+            const std::size_t tl = tail_.load(std::memory_order_seq_cst);
+            if (h == tl && shutdown_.load(std::memory_order_acquire)) return std::nullopt;
+            if (h == tl && w.should_park()) {
+                consumers_parked_.fetch_add(1, std::memory_order_seq_cst);
+                const std::uint32_t v = consumer_futex_.load(std::memory_order_seq_cst);
+                if (tail_.load(std::memory_order_seq_cst) == head_.load(std::memory_order_seq_cst) &&
+                    !shutdown_.load(std::memory_order_seq_cst)) {
+                    w.park(consumer_futex_, v);
+                }
+                consumers_parked_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                w.pause();
+            }
+            if (w.expired()) return std::nullopt;
+        }
+    }
+
+    // ========================================================================
+    // Producer: Ardışık boş slot'ları toplu claim eder (TEK producer için)
+    // ========================================================================
+    // tail_'ten başlayarak en fazla max_count boş slot'u claim_producer gibi
+    // özel olarak (seq -> pos | kClaimed) claim eder, out[]'a yazar ve
+    // sayısını döner. Kullanılmayan slot'lar abandon_producer() ile geri
+    // verilmelidir (sondan başa veya commit'lerden sonra).
+    //
+    // ÖNEMLİ: Slot'lar SIRAYLA commit edilmelidir (out[0], out[1], ...);
+    // commit_producer tail_ == pos şartını arar. Batch açıkken diğer
+    // producer'lar tail_ slot'unu claim edemez (dolu görür); bu API tek
+    // producer'lı ingest yolları (UDP, replay, stage'ler) içindir.
+    // ========================================================================
+    std::size_t claim_producer_batch(Ticket* out, std::size_t max_count) {
+        if (shutdown_.load(std::memory_order_acquire)) return 0;
+        if (!enter_gate()) return 0;
+        const std::size_t pos = tail_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        while (n < max_count && n < capacity_) {
+            const std::size_t p = pos + n;
+            std::size_t expected = p;
+            if (!slots_[p & mask_].seq.compare_exchange_strong(expected, p | kClaimed, std::memory_order_acquire,
+                                                               std::memory_order_relaxed)) {
+                break;
+            }
+            out[n++] = make_ticket(p);
+        }
+        if (n) MPMC_TRACE_EVENT(ProducerClaim, pos, n);
+        else MPMC_TRACE_EVENT(Full, pos, 1);
+        hold_gate(n);
+        return n;
+    }
+
+    // ========================================================================
+    // Producer: commit edilmeyecek ticket'ı bırakır
+    // ========================================================================
+    // Slot hiç yayınlanmadı: claim işareti kaldırılır (seq tekrar pos, slot
+    // boş) ve resizable modda ticket'ın resize kapısındaki payı geri verilir.
+    // ========================================================================
+    void abandon_producer(const Ticket& t) {
+        MPMC_TRACE_EVENT(Abandon, t.pos, 1);
+        slots_[t.pos & mask_].seq.store(t.pos, std::memory_order_release);
+        leave_gate();
+    }
+
+    // ========================================================================
+    // Producer: RAII wrapper ile claim (ÖNERİLEN - Exception safe)
+    // ========================================================================
+    // Bu fonksiyon ProducerTicket döndürür; destructor'da otomatik commit yapar.
+    // Producer fail olsa bile (exception, early return) slot kaybolmaz.
+    //
+    // KULLANIM:
+    //   if (auto ticket = buffer.claim_producer_raii()) {
+    //       // ticket->cpu_ptr, ticket->gpu_ptr, vs. kullan
+    //       ticket->commit();  // Manuel commit (isteğe bağlı, destructor zaten yapar)
+    //   }
+    // ========================================================================
+    std::optional<ProducerTicket> claim_producer_raii() {
+        auto opt = claim_producer();
+        if (!opt) return std::nullopt;
+        // ProducerTicket taşınamaz; optional içinde yerinde (in_place) kurulur
+        return std::optional<ProducerTicket>(std::in_place, this, *opt);
+    }
+
+    // ========================================================================
+    // Consumer: Dolu bir slot'u claim eder ve chunk pointer'ı döner (non-blocking)
+    // ========================================================================
+    // Veri yoksa hemen std::nullopt döner; spin/backoff yapmaz.
+    // ÖNEMLİ: Bu fonksiyon döndükten sonra mutlaka release_consumer() çağrılmalı!
+    // ========================================================================
+    std::optional<Ticket> claim_consumer() {
+        if (!enter_gate()) return std::nullopt;   // Resize sürüyor: boş gibi
+
+        // head_: son okunan pozisyon (atomik, birden fazla consumer paylaşır)
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        
+        // Ring buffer'da döngüsel indeks
+        Slot& slot = slots_[pos & mask_];
+        
+        // Slot'un sequence değerini oku
+        std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        
+        // diff = seq - (pos + 1)
+        intptr_t diff =
+            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        
+        if (diff == 0) {  // Slot dolu! Claim etmeyi dene
+            if (head_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                // Başarılı! Bu slot'u claim ettik
+                Ticket t = make_ticket(pos);  // Consumer bu pointer'lardan okuyabilir
+                MPMC_TRACE_EVENT(ConsumerClaim, pos, 1);
+                if (options_.prefetch_distance) prefetch_slot<false>(pos + options_.prefetch_distance);
+                if (options_.verify_on_claim) verify_checksum(t);
+                return t;
+            }
+            // CAS başarısızsa başka consumer aldı; veri yokmuş gibi nullopt dön
+            leave_gate();
+            return std::nullopt;
+        }
+        
+        // Slot boş (diff < 0) ya da beklenmeyen durum (diff > 0) → veri yokmuş gibi çık
+        MPMC_TRACE_EVENT(Empty, pos, 1);
+        leave_gate();
+        return std::nullopt;
+    }
+
+    // ========================================================================
+    // Consumer: Ardışık dolu slot'ları toplu claim eder (MPMC güvenli)
+    // ========================================================================
+    // head_'ten itibaren en fazla max_count dolu slot'u tek bir head_ CAS'ı ile
+    // alır ve out[]'a yazar. Her slot ayrıca release_consumer ile (herhangi bir
+    // sırada) geri verilmelidir. Dönüş: claim edilen slot sayısı (0 = boş).
+    // ========================================================================
+    std::size_t claim_consumer_batch(Ticket* out, std::size_t max_count) {
+        if (!enter_gate()) return 0;
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            std::size_t n = 0;
+            while (n < max_count &&
+                   slots_[(pos + n) & mask_].seq.load(std::memory_order_acquire) == pos + n + 1) {
+                ++n;
+            }
+            if (n == 0) {
+                MPMC_TRACE_EVENT(Empty, pos, 1);
+                leave_gate();
+                return 0;
+            }
+            if (head_.compare_exchange_weak(pos, pos + n, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                MPMC_TRACE_EVENT(ConsumerClaim, pos, n);
+                // Batch'in ilk slot'ları: çağıran onlara hemen dokunacak
+                for (std::size_t i = 0; i < std::min(n, options_.prefetch_distance); ++i) {
+                    prefetch_slot<false>(pos + i);
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = make_ticket(pos + i);
+                    if (options_.verify_on_claim) verify_checksum(out[i]);
+                }
+                hold_gate(n);
+                return n;
+            }
+            // CAS başarısız: pos güncel head_ ile yenilendi, tekrar dene
+        }
+    }
+
+    // ========================================================================
+    // Consumer: Batch claim + slot başına fn(ticket) + release (yardımcı)
+    // ========================================================================
+    // En fazla max_count slot'u claim_consumer_batch ile alır; slot i
+    // işlenmeden önce slot i + prefetch_distance prefetch edilir, böylece
+    // büyük chunk'larda ilk dokunuşun cache miss'i önceki slot'un işlenmesiyle
+    // örtüşür. fn(const Ticket&) sırayla çağrılır, her slot ardından release
+    // edilir. Dönüş: işlenen slot sayısı (0 = boş).
+    // ========================================================================
+    template <typename Fn>
+    std::size_t consume_batch(std::size_t max_count, Fn&& fn) {
+        constexpr std::size_t kStep = 64;
+        Ticket batch[kStep];
+        const std::size_t n = claim_consumer_batch(batch, std::min(max_count, kStep));
+        const std::size_t d = options_.prefetch_distance;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (d && i + d < n) prefetch_slot<false>(batch[i + d].pos);
+            fn(static_cast<const Ticket&>(batch[i]));
+            release_consumer(batch[i]);
+        }
+        return n;
+    }
+
+    // ========================================================================
+    // Consumer: head'teki bayat (TTL'i dolmuş) item'ları toplu atlar
+    // ========================================================================
+    // head_'ten itibaren dolu ve now_ns itibarıyla süresi dolmuş ardışık
+    // slot'ları tarar; ilk taze (veya boş) slot'ta durur. Hepsi tek bir
+    // head_ CAS'ı ile claim edilir ve slot seq'leri doğrudan boşa çevrilir
+    // (payload'a dokunulmaz). Stall sonrası catch-up: N bayat item için N
+    // claim/release yerine 1 CAS + N seq store.
+    // Dönüş: atlanan item sayısı (expired_skipped()'e de eklenir). Başka
+    // consumer'lar aynı anda claim edebilir; CAS kaybedilirse yeniden taranır.
+    // BufferOptions::expiry kapalıysa 0.
+    // ========================================================================
+    std::size_t skip_expired(std::uint64_t now_ns = steady_now_ns()) {
+        if (!expiry_lane_) return 0;
+        if (!enter_gate()) return 0;
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        while (true) {
+            n = 0;
+            while (n < capacity_) {
+                const std::size_t p = pos + n;
+                const std::size_t idx = p & mask_;
+                if (slots_[idx].seq.load(std::memory_order_acquire) != p + 1) break;
+                if (!expiry_lane_[idx].expired(now_ns)) break;
+                ++n;
+            }
+            if (n == 0) {
+                leave_gate();
+                return 0;
+            }
+            if (head_.compare_exchange_weak(pos, pos + n, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+            // CAS başarısız: pos güncel head_ ile yenilendi, tekrar tara
+        }
+        MPMC_TRACE_EVENT(ConsumerClaim, pos, n);
+        const bool park = options_.producer_wait == WaitStrategy::Park;
+        for (std::size_t i = 0; i < n; ++i) {
+            MPMC_TRACE_EVENT(Release, pos + i, 1);
+            // Park: seq_cst, parked producer sayacı okumasıyla yer değiştirmesin
+            slots_[(pos + i) & mask_].seq.store(pos + i + capacity_,
+                                                park ? std::memory_order_seq_cst : std::memory_order_release);
+        }
+        leave_gate();
+        if (park && producers_parked_.load(std::memory_order_seq_cst) != 0) wake(producer_futex_, INT_MAX);
+        expired_skipped_.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // skip_expired() ile atlanan toplam item
+    std::uint64_t expired_skipped() const { return expired_skipped_.load(std::memory_order_relaxed); }
+
+    // ItemExpiry::commit_ns ve skip_expired()'ın zaman tabanı
+    static std::uint64_t steady_now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    // ========================================================================
+    // Consumer: Chunk'ı okuduktan sonra slot'u producer'lara geri verir
+    // ========================================================================
+    // Bu fonksiyon claim_consumer()'dan sonra MUTLAKA çağrılmalı!
+    //
+    // Sequence'i pos + capacity_ yaparak slot'u "boş" olarak işaretleriz.
+    // Producer'lar seq == pos olduğunu görünce bu slot'a yazabilir.
+    //
+    // Neden pos + capacity_?
+    // - Ring buffer döngüsel çalışır, pos değerleri sürekli artar
+    // - pos + capacity_ yaparak, bir sonraki döngüde aynı slot'a geldiğimizde
+    //   seq değerini doğru hesaplayabiliriz
+    // - Örnek: capacity=8, pos=5 -> seq=13. Bir sonraki döngüde pos=13 geldiğinde
+    //   seq kontrolü: 13 - 13 = 0 (boş) olur
+    //
+    // memory_order_release: Bu yazıdan önceki tüm okumalar (chunk'tan okunan
+    // veriler) tamamlanmış olur.
+    // ========================================================================
+    void release_consumer(const Ticket& t) {
+        MPMC_TRACE_EVENT(Release, t.pos, 1);
+        if (options_.producer_wait == WaitStrategy::Park) {
+            // seq_cst store: parked producer sayacının okunmasıyla yer değiştirmesin
+            slots_[t.pos & mask_].seq.store(t.pos + capacity_, std::memory_order_seq_cst);
+            leave_gate();
+            if (producers_parked_.load(std::memory_order_seq_cst) != 0) {
+                wake(producer_futex_, 1);
+            }
+            return;
+        }
+        // Sequence'i pos + capacity_ yap = "Bu slot boş, producer yazabilir" sinyali
+        slots_[t.pos & mask_].seq.store(t.pos + capacity_,
+                                        std::memory_order_release);
+        leave_gate();
+    }
+
+    // ========================================================================
+    // Consumer: RAII wrapper ile claim (ÖNERİLEN - Exception safe)
+    // ========================================================================
+    // Bu fonksiyon ConsumerTicket döndürür; destructor'da otomatik release yapar.
+    // Consumer fail olsa bile slot kaybolmaz.
+    //
+    // KULLANIM:
+    //   if (auto ticket = buffer.claim_consumer_raii()) {
+    //       // ticket->cpu_ptr, ticket->gpu_ptr, vs. kullan
+    //       ticket->release();  // Manuel release (isteğe bağlı, destructor zaten yapar)
+    //   }
+    // ========================================================================
+    std::optional<ConsumerTicket> claim_consumer_raii() {
+        auto opt = claim_consumer();
+        if (!opt) return std::nullopt;
+        // ConsumerTicket taşınamaz; optional içinde yerinde (in_place) kurulur
+        return std::optional<ConsumerTicket>(std::in_place, this, *opt);
+    }
+
+    // ========================================================================
+    // Stop: Buffer'ı kapatır, producer/consumer'lara çıkış sinyali gönderir
+    // ========================================================================
+    // Bu fonksiyon çağrıldığında:
+    // - Producer'lar claim_producer()'da nullptr döner ve çıkar
+    // - Consumer'lar claim_consumer()'da nullopt döner ve çıkar
+    //
+    // memory_order_release: Bu yazıdan önceki tüm işlemler tamamlanır
+    // ========================================================================
+    void stop() {
+        shutdown_.store(true, std::memory_order_seq_cst);
+        // Park etmiş tüm thread'leri uyandır; shutdown'ı görüp çıksınlar
+        wake(producer_futex_, INT_MAX);
+        wake(consumer_futex_, INT_MAX);
+        // epoll'da bekleyen consumer'lar shutdown'ı görebilsin
+        if (event_fd_ >= 0) {
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto r = ::write(event_fd_, &one, sizeof(one));
+        }
+    }
+    bool stopped() const { return shutdown_.load(std::memory_order_acquire); }
+
+    // ========================================================================
+    // Online resize (BufferOptions::resizable)
+    // ========================================================================
+    // Ring'i yeni kapasiteye (2'nin kuvvetine yuvarlanır) taşır; producer ve
+    // consumer'lar çalışmaya devam eder. Devir protokolü:
+    //   1. gate_closed_ = true: yeni claim'ler kapıda geri döner (producer için
+    //      "dolu", consumer için "boş"; *_wait varyantları beklemeye devam eder)
+    //   2. Uçuştaki tüm ticket'lar commit/release/abandon edilene kadar beklenir
+    //      (inflight_ == 0). Bu noktada [head_, tail_) tamamen dolu, geri
+    //      kalan her slot boştur.
+    //   3. Yeni slot dizisi ve lane'ler ayrılır; item'lar aynı pos ile
+    //      (pos & yeni_mask) kopyalanır, boş slot'ların seq'i o index'e düşen
+    //      ilk pos >= tail_ olur. head_/tail_ değişmez.
+    //   4. gate_closed_ = false, park etmiş thread'ler uyandırılır.
+    // Eski depolama hemen serbest bırakılır (küçültmede malloc_trim ile
+    // OS'e iade edilir). Item kaybolmaz veya çoğalmaz.
+    //
+    // Dönüş false: resizable değil, journal modu veya ring'deki item sayısı
+    // yeni kapasiteye sığmıyor (durum değişmez; daha sonra tekrar denenebilir).
+    // ÖNEMLİ: Elinde ticket tutan bir thread resize() çağırmamalıdır
+    // (kendi ticket'ını bekler). chunk_storage() adresi değişir; depolama
+    // pin'liyken (kayıtlı buffer kullanan Recorder, bkz. pin_storage) false.
+    // ========================================================================
+    bool resize(std::size_t new_capacity_chunks) {
+        if (!options_.resizable || journal_) return false;
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        if (storage_pins_) return false;
+
+        std::size_t new_capacity = 1;
+        while (new_capacity < new_capacity_chunks) new_capacity <<= 1;
+        if (new_capacity == capacity_) return true;
+
+        // Yeni depolama kapı açıkken ayrılır (sıfırlama dahil); kapı sadece
+        // kopyalama ve pointer değişimi süresince kapalı kalır
+        HeapLanes lanes = make_heap_lanes(new_capacity);
+
+        // 1-2: kapıyı kapat, uçuştaki ticket'ları bekle
+        const auto closed = std::chrono::steady_clock::now();
+        close_gate();
+
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const bool ok = tail - head <= new_capacity;
+        const bool shrink = new_capacity < capacity_;
+        if (ok) migrate(head, tail, lanes, new_capacity);
+
+        // 4: kapıyı aç (yeni lane'ler ve kapasite görünür olur)
+        open_gate();
+        last_resize_pause_ = std::chrono::steady_clock::now() - closed;
+
+        // lanes artık eski depolamayı tutar: kapı dışında serbest bırak;
+        // küçültmede boşalan heap sayfalarını OS'e iade et
+        lanes = HeapLanes{};
+        if (ok && shrink) ::malloc_trim(0);
+        if (ok) resizes_.fetch_add(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    std::uint64_t resizes() const { return resizes_.load(std::memory_order_relaxed); }
+    // Son resize'da kapının kapalı kaldığı süre (claim'lerin geri çevrildiği)
+    std::chrono::nanoseconds last_resize_pause() const {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        return last_resize_pause_;
+    }
+
+    // ========================================================================
+    // trim_idle: Boş slot'ların chunk sayfalarını OS'e iade eder (trimmable)
+    // ========================================================================
+    // Kapı resize'daki gibi kapatılır; uçuşta ticket yokken [head_, tail_)
+    // tam doludur ve diğer tüm slot'lar boştur. Sonraki keep_slots boş slot
+    // (producer'ların bir sonraki yazacakları) sıcak bırakılır, kalan boş
+    // aralığın cpu ve gpu lane sayfalarına madvise uygulanır (sayfaya içe
+    // yuvarlanır: dolu slot'a taşan sayfaya dokunulmaz). Metadata lane'leri
+    // küçüktür ve atlanır. Bırakılan sayfa tekrar yazıldığında kernel sıfır
+    // sayfa verir; producer chunk'ı zaten baştan yazar.
+    //
+    // Büyük ring'de madvise milisaniyeler sürer; kapı bu yüzden adım başına
+    // en fazla step_slots slot için kapatılır. Adımlar boş aralığın sonundan
+    // (head_'in hemen gerisi, producer'ların en son ulaşacağı yer) başa
+    // doğru ilerler; her adımda aralık yeniden okunur, arada producer'ların
+    // yazdığı slot'lara dokunulmaz.
+    //
+    // Dönüş: madvise edilen bayt (trimmable değilse / journal modunda /
+    // depolama pin'liyken 0). last_trim_pause(): en uzun adımın kapı
+    // kapanma süresi.
+    // ÖNEMLİ: resize() gibi, elinde ticket tutan thread çağırmamalıdır.
+    // ========================================================================
+    std::size_t trim_idle(std::size_t keep_slots = 0, std::size_t step_slots = 256) {
+        if (!options_.trimmable || journal_) return 0;
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        if (storage_pins_) return 0;
+        if (step_slots == 0) step_slots = 1;
+
+        std::size_t bytes = 0;
+        std::chrono::nanoseconds pause{0};
+        std::size_t limit = SIZE_MAX;   // Bu pozisyon ve sonrası işlendi
+        while (true) {
+            const auto closed = std::chrono::steady_clock::now();
+            close_gate();
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            // Boş pozisyonlar [tail + keep, head + capacity)
+            const std::size_t lo = tail + keep_slots;
+            const std::size_t hi = std::min(head + capacity_, limit);
+            const bool more = lo < hi;
+            if (more) {
+                const std::size_t from = hi - lo > step_slots ? hi - step_slots : lo;
+                // pos aralığı en fazla iki index aralığına düşer (sarma)
+                const std::size_t first = from & mask_;
+                const std::size_t count = hi - from;
+                const std::size_t run = std::min(count, capacity_ - first);
+                bytes += advise_slots(first, run);
+                if (run < count) bytes += advise_slots(0, count - run);
+                limit = from;
+            }
+            open_gate();
+            pause = std::max(pause, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - closed));
+            if (!more) break;
+        }
+
+        last_trim_pause_ = pause;
+        trims_.fetch_add(1, std::memory_order_relaxed);
+        trimmed_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        return bytes;
+    }
+
+    std::uint64_t trims() const { return trims_.load(std::memory_order_relaxed); }
+    // Toplam madvise edilen bayt (aynı sayfa birden çok kez sayılabilir)
+    std::uint64_t trimmed_bytes() const { return trimmed_bytes_.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds last_trim_pause() const {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        return last_trim_pause_;
+    }
+
+    // ========================================================================
+    // pin_storage / unpin_storage: chunk depolamasını yerinde sabitler
+    // ========================================================================
+    // io_uring IORING_REGISTER_BUFFERS kayıt anındaki fiziksel sayfaları
+    // tutar. madvise(MADV_DONTNEED) sonrası producer yeni bir sıfır sayfaya
+    // yazar, WRITE_FIXED ise hâlâ eski sayfayı okur; resize() ise adresi
+    // tamamen değiştirir. Pin sayısı > 0 iken trim_idle() 0, resize() false
+    // döner. pin_storage() sürmekte olan bir trim/resize'ın bitmesini bekler.
+    // ========================================================================
+    void pin_storage() {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        ++storage_pins_;
+    }
+    void unpin_storage() {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        if (storage_pins_) --storage_pins_;
+    }
+    bool storage_pinned() const {
+        std::lock_guard<std::mutex> lock(resize_mutex_);
+        return storage_pins_ != 0;
+    }
+
+    // ========================================================================
+    // Readiness (eventfd): epoll döngüsündeki consumer'lar için
+    // ========================================================================
+    // Edge-style sinyal: producer sadece "consumer bekliyor" (armed) iken ve
+    // sadece ilk commit'te write() yapar; sonraki commit'ler syscall'suz.
+    //
+    // KULLANIM (consumer):
+    //   epoll_ctl(ep, EPOLL_CTL_ADD, buffer.event_fd(), EPOLLIN ...);
+    //   while (running) {
+    //       while (auto t = buffer.claim_consumer()) { ... release ... }
+    //       if (!buffer.arm_readiness()) continue;   // Arada veri geldi
+    //       epoll_wait(ep, ...);                      // Soket/timer/buffer
+    //       buffer.drain_readiness();                 // eventfd sayaç sıfırla
+    //   }
+    //
+    // Lost wake-up olmaması için arm_readiness() bayrağı seq_cst yazar ve
+    // tail_'i tekrar okur; commit_producer tail_ CAS'ı (seq_cst) sonrası
+    // bayrağı okur. İkisinden biri mutlaka diğerini görür.
+    // ========================================================================
+    int event_fd() const { return event_fd_; }
+
+    // true: beklemek güvenli (ring boş); false: veri var, tekrar claim et
+    bool arm_readiness() {
+        if (event_fd_ < 0) return false;
+        readiness_armed_.store(true, std::memory_order_seq_cst);
+        const std::size_t h = head_.load(std::memory_order_seq_cst);
+        const std::size_t t = tail_.load(std::memory_order_seq_cst);
+        if (t != h || shutdown_.load(std::memory_order_acquire)) {
+            return false;  // Bayrak açık kalabilir; en kötü ihtimal sahte uyanma
+        }
+        return true;
+    }
+
+    // eventfd sayacını sıfırlar (fd okunabilir olduktan sonra çağrılır)
+    void drain_readiness() {
+        if (event_fd_ < 0) return;
+        std::uint64_t value;
+        [[maybe_unused]] auto r = ::read(event_fd_, &value, sizeof(value));
+    }
+
+    // ========================================================================
+    // Journal (BufferOptions::journal_path)
+    // ========================================================================
+    // sync_journal(): cursor checkpoint'ini header'a yazar ve eşlemeyi
+    // journal_sync yöntemiyle diske indirir. Bu çağrıdan önce commit_producer'ı
+    // dönmüş tüm item'lar güç kaybına dayanıklıdır. Journal yoksa no-op.
+    // Release edilip henüz sync edilmemiş item'lar yeniden açılışta tekrar
+    // görünebilir (at-least-once).
+    // Eşzamanlı çağrılar (commit eden producer + flusher) sıralanır: header
+    // yazımı yarışmaz ve sonraki çağrı önceki checkpoint'ten geri gitmez.
+    // ========================================================================
+    bool sync_journal() {
+        if (!journal_) return true;
+        std::lock_guard<std::mutex> lock(journal_sync_mutex_);
+        JournalFile::Header& h = journal_->header();
+        h.head = head_.load(std::memory_order_relaxed);
+        h.tail = tail_.load(std::memory_order_relaxed);
+        const bool ok = journal_->sync(options_.journal_sync);
+        journal_syncs_.fetch_add(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    bool journaled() const { return journal_ != nullptr; }
+
+    // ========================================================================
+    // Checksum (BufferOptions::checksum)
+    // ========================================================================
+    // verify_checksum(): claim edilmiş chunk'ın CRC'sini yeniden hesaplar;
+    // uyuşmazlıkta checksum_mismatches() artar. Checksum kapalıysa true.
+    // Recorder gibi aşamalar verify_on_claim kapalıyken kendisi çağırır.
+    // ========================================================================
+    bool verify_checksum(const Ticket& t) {
+        if (!crc_lane_) return true;
+        checksum_verified_.fetch_add(1, std::memory_order_relaxed);
+        if (chunk_checksum(t) == *t.crc_ptr) return true;
+        checksum_mismatches_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::uint64_t checksum_verified() const { return checksum_verified_.load(std::memory_order_relaxed); }
+    std::uint64_t checksum_mismatches() const { return checksum_mismatches_.load(std::memory_order_relaxed); }
+    // Açılışta journal'dan geri yüklenen (tüketilmemiş) item sayısı
+    std::size_t recovered_items() const { return recovered_items_; }
+    // Önceki kapanış düzgün müydü (destructor çalıştı mı)
+    bool journal_was_clean() const { return journal_ && journal_->was_clean(); }
+    std::uint64_t journal_syncs() const { return journal_syncs_.load(std::memory_order_relaxed); }
+
+    // Toplam eventfd write() sayısı (commit başına syscall oranı için)
+    std::uint64_t readiness_signals() const {
+        return readiness_signals_.load(std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Gözlem yardımcıları (wrapper'lar ve benchmark için)
+    // ========================================================================
+    // size_approx(): eşzamanlı çalışırken yalnızca yaklaşık doluluk verir.
+    // ========================================================================
+    std::size_t capacity() const { return capacity_; }
+    std::size_t chunk_size() const { return chunk_size_; }
+    std::size_t shorts_per_chunk() const { return shorts_per_chunk_; }
+
+    // Örnek (gpu) lane'inin geçerli uzunluğu: *size_ptr / sizeof(short),
+    // shorts_per_chunk ile sınırlı. Örnek işleyen stage'ler (CodecStage
+    // encode, FirStage, FftStage, DetectStage) girdiyi bununla okur; örnek
+    // üreten producer *size_ptr = örnek * sizeof(short) yazmalıdır (stage
+    // çıktıları bunu zaten yapar, stage'ler zincirlenebilir).
+    std::size_t sample_count(const Ticket& t) const {
+        return std::min(*t.size_ptr / sizeof(short), shorts_per_chunk_);
+    }
+    const BufferOptions& options() const { return options_; }
+
+    // Chunk depolamasının tamamı (io_uring buffer kaydı, ring indeksi -> adres)
+    char* chunk_storage() { return cpu_lane_; }
+    std::size_t chunk_storage_bytes() const { return capacity_ * chunk_size_; }
+    std::size_t size_approx() const {
+        std::size_t h = head_.load(std::memory_order_relaxed);
+        std::size_t t = tail_.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+
+private:
+    // Armed bayrağını tek bir producer kapatır; sadece o syscall yapar
+    void signal_readiness() {
+        if (!readiness_armed_.exchange(false, std::memory_order_acq_rel)) return;
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto r = ::write(event_fd_, &one, sizeof(one));
+        readiness_signals_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Resize/trim kapısı: resizable ve trimmable değilse tamamen no-op
+    // ========================================================================
+    // enter_gate: inflight_'i artırır, sonra gate_closed_'ı okur (seq_cst);
+    // close_gate() önce gate_closed_ yazar, sonra inflight_'i okur. İkisinden
+    // biri diğerini görür: ya claim geri döner ya da kapatan onu bekler.
+    // Başarılı claim'in payı commit/release/abandon'da geri verilir.
+    // ========================================================================
+    bool gated() const { return options_.resizable || options_.trimmable; }
+
+    bool enter_gate() {
+        if (!gated()) return true;
+        inflight_.fetch_add(1, std::memory_order_seq_cst);
+        if (!gate_closed_.load(std::memory_order_seq_cst)) return true;
+        inflight_.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    void leave_gate() {
+        if (gated()) inflight_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Batch claim: kapıdaki tek pay n ticket'a genişletilir (n == 0: bırakılır)
+    void hold_gate(std::size_t n) {
+        if (!gated()) return;
+        if (n == 0) leave_gate();
+        else if (n > 1) inflight_.fetch_add(n - 1, std::memory_order_relaxed);
+    }
+
+    // Kapıyı kapatır ve uçuştaki ticket'ları bekler (resize_mutex_ tutulurken)
+    void close_gate() {
+        gate_closed_.store(true, std::memory_order_seq_cst);
+        for (int spins = 0; inflight_.load(std::memory_order_seq_cst) != 0; ++spins) {
+            if (spins < 64) cpu_relax();
+            else std::this_thread::yield();
+        }
+    }
+
+    // Kapıyı açar; kapıda park etmiş thread'leri uyandırır
+    void open_gate() {
+        gate_closed_.store(false, std::memory_order_seq_cst);
+        wake(producer_futex_, INT_MAX);
+        wake(consumer_futex_, INT_MAX);
+    }
+
+    // [idx, idx + n) slot'larının cpu ve gpu lane sayfalarına madvise
+    std::size_t advise_slots(std::size_t idx, std::size_t n) {
+        return advise_range(cpu_lane_ + idx * chunk_size_, n * chunk_size_) +
+               advise_range(reinterpret_cast<char*>(gpu_lane_ + idx * shorts_per_chunk_),
+                            n * shorts_per_chunk_ * sizeof(short));
+    }
+
+    // Aralığın tamamen içinde kalan sayfalar; başarısızsa 0
+    std::size_t advise_range(char* p, std::size_t len) {
+        static const std::uintptr_t page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+        const std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(p) + page - 1) & ~(page - 1);
+        const std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(p) + len) & ~(page - 1);
+        if (end <= begin) return 0;
+        void* addr = reinterpret_cast<void*>(begin);
+        const std::size_t bytes = end - begin;
+#ifdef MADV_FREE
+        if (options_.trim_advice == TrimAdvice::Free) {
+            if (::madvise(addr, bytes, MADV_FREE) == 0) return bytes;
+            if (errno != EINVAL) return 0;   // Eski kernel: DontNeed'e düş
+        }
+#endif
+        return ::madvise(addr, bytes, MADV_DONTNEED) == 0 ? bytes : 0;
+    }
+
+    // pos'un chunk başı (prefetch_bytes) ve rf/size metadata satırları.
+    // Write: PREFETCHW (hedef destekliyorsa); aksi halde okuma prefetch'i.
+    template <bool Write>
+    void prefetch_slot(std::size_t pos) const {
+        const std::size_t idx = pos & mask_;
+        const char* chunk = cpu_lane_ + idx * chunk_size_;
+        const std::size_t bytes = std::min(options_.prefetch_bytes, chunk_size_);
+        for (std::size_t off = 0; off < bytes; off += 64) __builtin_prefetch(chunk + off, Write ? 1 : 0, 3);
+        __builtin_prefetch(&rf_lane_[idx], Write ? 1 : 0, 3);
+        __builtin_prefetch(&size_lane_[idx], Write ? 1 : 0, 3);
+    }
+
+    // ========================================================================
+    // make_ticket: pos için tüm lane pointer'larını hesaplar
+    // ========================================================================
+    Ticket make_ticket(std::size_t pos) {
+        const std::size_t idx = pos & mask_;
+        return Ticket{pos,
+                      cpu_lane_ + idx * chunk_size_,
+                      gpu_lane_ + idx * shorts_per_chunk_,
+                      &rf_lane_[idx],
+                      &size_lane_[idx],
+                      seq_lane_ ? &seq_lane_[idx] : nullptr,
+                      crc_lane_ ? &crc_lane_[idx] : nullptr,
+                      expiry_lane_ ? &expiry_lane_[idx] : nullptr};
+    }
+
+    // rf + size + payload CRC32C'si (payload chunk_size ile sınırlı)
+    std::uint32_t chunk_checksum(const Ticket& t) const {
+        struct {
+            std::uint64_t size;
+            std::int32_t channel;
+            std::int32_t pad;
+            double value;
+        } meta{*t.size_ptr, t.rf->first, 0, t.rf->second};
+        const std::size_t n = *t.size_ptr < chunk_size_ ? *t.size_ptr : chunk_size_;
+        return ~crc32c_update(crc32c_update(~0u, &meta, sizeof(meta)), t.cpu_ptr, n);
+    }
+
+    // ========================================================================
+    // allocate_lanes: Heap modu — lane'ler sahipli dizilerde
+    // ========================================================================
+    void allocate_lanes() {
+        HeapLanes lanes = make_heap_lanes(capacity_);
+        swap_heap_lanes(lanes);
+
+        // Her slot'u başlangıç durumuna getir: seq = pos (boş durum)
+        // memory_order_relaxed yeterli çünkü henüz thread'ler başlamadı
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // ========================================================================
+    // open_journal: Journal modu — lane'ler dosya eşlemesinde
+    // ========================================================================
+    void open_journal() {
+        journal_ = std::make_unique<JournalFile>();
+        journal_->open(options_.journal_path, capacity_, chunk_size_, shorts_per_chunk_,
+                       options_.sequence_tracking, options_.checksum);
+        const JournalFile::Header& h = journal_->header();
+        slots_ = journal_->lane<Slot>(h.slots_offset);
+        cpu_lane_ = journal_->lane<char>(h.cpu_offset);
+        gpu_lane_ = journal_->lane<short>(h.gpu_offset);
+        rf_lane_ = journal_->lane<std::pair<int, double>>(h.rf_offset);
+        size_lane_ = journal_->lane<std::size_t>(h.size_offset);
+        seq_lane_ = h.seq_offset ? journal_->lane<std::uint64_t>(h.seq_offset) : nullptr;
+        crc_lane_ = h.crc_offset ? journal_->lane<std::uint32_t>(h.crc_offset) : nullptr;
+        // Expiry lane'i dosyada değil: steady_clock zamanları yeniden açılışta anlamsız
+        if (options_.expiry) {
+            meta_expiry_.assign(capacity_, ItemExpiry{0, 0});
+            expiry_lane_ = meta_expiry_.data();
+        }
+
+        if (journal_->created()) {
+            for (std::size_t i = 0; i < capacity_; ++i) {
+                slots_[i].seq.store(i, std::memory_order_relaxed);
+            }
+        } else {
+            recover_journal();
+        }
+        sync_journal();
+
+        if (options_.journal_sync_interval.count() > 0) {
+            flusher_ = std::thread([this] { flusher_loop(); });
+        }
+    }
+
+    // ========================================================================
+    // recover_journal: Slot seq'lerinden ring durumunu yeniden kurar
+    // ========================================================================
+    // Kalıcı gerçek slot seq'leridir (header cursor'ları sadece checkpoint):
+    //   (seq - idx) & mask == 1  -> dolu, pos = seq - 1 (commit edilmiş)
+    //   (seq - idx) & mask == 0  -> boş (release edilmiş veya hiç yazılmamış)
+    // Claim edilip release edilmemiş item'lar hâlâ dolu görünür ve geri gelir.
+    // Yarım commit'ler (tail_ CAS'ı yapılmış, seq yazılmamış) boş görünür ve
+    // ring'de delik bırakır; bu yüzden dolu item'lar pos sırasıyla en küçük
+    // pos'tan başlayarak ardışık pozisyonlara sıkıştırılır. Hedef pozisyon
+    // her zaman kaynaktan küçük-eşit ve pencere < capacity olduğundan
+    // henüz taşınmamış bir item'ın üzerine yazılmaz.
+    // ========================================================================
+    void recover_journal() {
+        std::vector<std::size_t> full;
+        for (std::size_t idx = 0; idx < capacity_; ++idx) {
+            const std::size_t seq = slots_[idx].seq.load(std::memory_order_relaxed);
+            if (((seq - idx) & mask_) == 1) full.push_back(seq - 1);
+        }
+        std::sort(full.begin(), full.end());
+        // Geçerli bir ring'de dolu item'lar < capacity genişliğinde bir pencerededir;
+        // bozuk dosyada pencere dışında kalan eski item'lar atılır
+        while (full.size() > 1 && full.back() - full.front() >= capacity_) {
+            full.erase(full.begin());
+        }
+
+        const std::size_t base = full.empty() ? journal_->header().tail : full.front();
+        for (std::size_t j = 0; j < full.size(); ++j) {
+            if (full[j] != base + j) move_item(full[j] & mask_, (base + j) & mask_);
+        }
+        // Ardışık dolu bölge + kalan boş slot'lar
+        for (std::size_t j = 0; j < capacity_; ++j) {
+            const std::size_t pos = base + j;
+            slots_[pos & mask_].seq.store(j < full.size() ? pos + 1 : pos, std::memory_order_relaxed);
+        }
+        head_.store(base, std::memory_order_relaxed);
+        tail_.store(base + full.size(), std::memory_order_relaxed);
+        recovered_items_ = full.size();
+    }
+
+    // Kurtarma sırasında bir item'ın tüm lane'lerini başka slot'a taşır
+    void move_item(std::size_t from, std::size_t to) {
+        std::memmove(cpu_lane_ + to * chunk_size_, cpu_lane_ + from * chunk_size_, chunk_size_);
+        std::memmove(gpu_lane_ + to * shorts_per_chunk_, gpu_lane_ + from * shorts_per_chunk_,
+                     shorts_per_chunk_ * sizeof(short));
+        rf_lane_[to] = rf_lane_[from];
+        size_lane_[to] = size_lane_[from];
+        if (seq_lane_) seq_lane_[to] = seq_lane_[from];
+        if (crc_lane_) crc_lane_[to] = crc_lane_[from];
+        if (expiry_lane_) expiry_lane_[to] = expiry_lane_[from];
+    }
+
+    // Arka plan flusher: her journal_sync_interval'de bir sync_journal()
+    void flusher_loop() {
+        std::unique_lock<std::mutex> lock(flusher_mutex_);
+        while (!flusher_stop_) {
+            flusher_cv_.wait_for(lock, options_.journal_sync_interval);
+            if (flusher_stop_) break;
+            lock.unlock();
+            sync_journal();
+            lock.lock();
+        }
+    }
+
+    void stop_flusher() {
+        if (!flusher_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(flusher_mutex_);
+            flusher_stop_ = true;
+        }
+        flusher_cv_.notify_all();
+        flusher_.join();
+    }
+
+    // ========================================================================
+    // Slot: Her slot bir sequence counter tutar
+    // ========================================================================
+    // Sequence counter, lock-free senkronizasyonun kalbidir:
+    // - seq == pos: Slot boş, producer yazabilir
+    // - seq == pos + 1: Slot dolu, consumer okuyabilir
+    // - seq == pos + capacity_: Slot boş (consumer okudu), producer tekrar yazabilir
+    //
+    // Copy/move constructor'lar delete edildi çünkü atomic kopyalanamaz.
+    // Bu yüzden vector yerine unique_ptr kullanıyoruz.
+    // ========================================================================
+    // Producer claim işareti: seq = pos | kClaimed (slot bir producer'da yazılıyor).
+    // Pozisyonlar bu bit'e ulaşmaz; consumer'lar ve kurtarma slot'u boş görür.
+    static constexpr std::size_t kClaimed = std::size_t{1} << (sizeof(std::size_t) * 8 - 1);
+
+    struct Slot {
+        std::atomic<std::size_t> seq{};  // Slot'un beklenen sıra numarası (sequence)
+        Slot() = default;
+        Slot(const Slot&) = delete;      // Atomic kopyalanamaz
+        Slot& operator=(const Slot&) = delete;
+        Slot(Slot&&) = delete;
+        Slot& operator=(Slot&&) = delete;
+    };
+    // Journal dosyasında slot lane'i düz uint64 dizisidir
+    static_assert(sizeof(Slot) == sizeof(std::uint64_t) &&
+                  std::atomic<std::size_t>::is_always_lock_free,
+                  "Slot dosyaya eşlenebilir olmalı");
+
+    // ========================================================================
+    // HeapLanes: Heap modu depolamasının tamamı (allocate_lanes ve resize)
+    // ========================================================================
+    // make_heap_lanes ayırır ve sıfırlar (slot seq'leri hariç);
+    // swap_heap_lanes üyelerle yer değiştirir ve lane pointer'larını bağlar.
+    // ========================================================================
+    struct HeapLanes {
+        std::unique_ptr<Slot[]> slots;
+        AlignedBuffer<char> cpu;
+        std::vector<short> gpu;
+        std::vector<std::pair<int, double>> rf;
+        std::vector<std::size_t> size;
+        std::vector<std::uint64_t> seq;
+        std::vector<std::uint32_t> crc;
+        std::vector<ItemExpiry> expiry;
+    };
+
+    HeapLanes make_heap_lanes(std::size_t capacity) const {
+        HeapLanes h;
+        // unique_ptr kullanıyoruz çünkü Slot içinde atomic var ve kopyalanamaz
+        h.slots = std::make_unique<Slot[]>(capacity);
+        // Büyük char dizisi: capacity * chunk_size byte, her slot için chunk_size
+        h.cpu.allocate(capacity * chunk_size_, options_.data_alignment);
+        h.gpu.resize(capacity * shorts_per_chunk_);
+        // Metadata dizileri: rfSignal ve size (+ isteğe bağlı seq / crc)
+        h.rf.resize(capacity);
+        h.size.resize(capacity, 0);
+        if (options_.sequence_tracking) h.seq.resize(capacity, 0);
+        if (options_.checksum) h.crc.resize(capacity, 0);
+        if (options_.expiry) h.expiry.resize(capacity, ItemExpiry{0, 0});
+        return h;
+    }
+
+    void swap_heap_lanes(HeapLanes& h) {
+        std::swap(slot_storage_, h.slots);
+        std::swap(data_cpu_, h.cpu);
+        data_gpu_.swap(h.gpu);
+        meta_rf_signal_.swap(h.rf);
+        meta_size_.swap(h.size);
+        meta_seq_.swap(h.seq);
+        meta_crc_.swap(h.crc);
+        meta_expiry_.swap(h.expiry);
+
+        slots_ = slot_storage_.get();
+        cpu_lane_ = data_cpu_.data();
+        gpu_lane_ = data_gpu_.data();
+        rf_lane_ = meta_rf_signal_.data();
+        size_lane_ = meta_size_.data();
+        seq_lane_ = meta_seq_.empty() ? nullptr : meta_seq_.data();
+        crc_lane_ = meta_crc_.empty() ? nullptr : meta_crc_.data();
+        expiry_lane_ = meta_expiry_.empty() ? nullptr : meta_expiry_.data();
+    }
+
+    // ========================================================================
+    // migrate: Sessiz (inflight_ == 0) ring'i hazırlanmış depolamaya taşır
+    // ========================================================================
+    // Dönüşte lanes eski depolamayı tutar (çağıran kapı dışında bırakır).
+    // ========================================================================
+    void migrate(std::size_t head, std::size_t tail, HeapLanes& lanes, std::size_t new_capacity) {
+        const std::size_t old_mask = mask_;
+        swap_heap_lanes(lanes);
+        capacity_ = new_capacity;
+        mask_ = new_capacity - 1;
+
+        for (std::size_t pos = head; pos != tail; ++pos) {
+            const std::size_t from = pos & old_mask;
+            const std::size_t to = pos & mask_;
+            std::memcpy(cpu_lane_ + to * chunk_size_, lanes.cpu.data() + from * chunk_size_, chunk_size_);
+            std::memcpy(gpu_lane_ + to * shorts_per_chunk_, lanes.gpu.data() + from * shorts_per_chunk_,
+                        shorts_per_chunk_ * sizeof(short));
+            rf_lane_[to] = lanes.rf[from];
+            size_lane_[to] = lanes.size[from];
+            if (seq_lane_) seq_lane_[to] = lanes.seq[from];
+            if (crc_lane_) crc_lane_[to] = lanes.crc[from];
+            if (expiry_lane_) expiry_lane_[to] = lanes.expiry[from];
+        }
+        // Dolu: seq = pos + 1; boş: o index'e düşen ilk pos >= tail
+        for (std::size_t idx = 0; idx < capacity_; ++idx) {
+            const std::size_t next = tail + ((idx - tail) & mask_);
+            const std::size_t pos = next - capacity_;
+            const bool full = next >= capacity_ && pos >= head && pos < tail;
+            slots_[idx].seq.store(full ? pos + 1 : next, std::memory_order_relaxed);
+        }
+    }
+
+    // ========================================================================
+    // Waiter: Contention (çakışma) durumunda bekleme stratejisi
+    // ========================================================================
+    // Lock-free algoritmalarda, eğer bir thread CAS başarısız olursa veya
+    // beklediği durum henüz oluşmamışsa, sürekli döngüye girip CPU'yu
+    // boşa harcamak yerine akıllıca beklemelidir. Waiter, WaitStrategy'yi
+    // uygular (bkz. WaitStrategy açıklaması).
+    //
+    // PauseSpin (eski Backoff davranışı, PAUSE ile):
+    // 1. İlk 10 denemede: Exponential backoff (1, 2, 4, ... 512 _mm_pause)
+    // 2. Sonrasında: Thread yield (OS'a CPU'yu başka thread'e ver)
+    //
+    // Park: ilk 64 deneme kısa spin (çoğu bekleme çok kısa), sonra futex.
+    // ========================================================================
+    class Waiter {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        Waiter(WaitStrategy strategy, std::chrono::microseconds sleep, TimePoint deadline)
+            : strategy_(strategy), sleep_(sleep), deadline_(deadline) {}
+
+        // Park'a geçme zamanı geldi mi? (sadece WaitStrategy::Park)
+        bool should_park() const {
+            return strategy_ == WaitStrategy::Park && count_ >= kParkSpins;
+        }
+
+        void pause() {
+            switch (strategy_) {
+                case WaitStrategy::BusySpin:
+                    cpu_relax();
+                    break;
+                case WaitStrategy::PauseSpin:
+                    if (count_ < kMaxPauseShift) {
+                        for (int i = 0; i < (1 << count_); ++i) cpu_relax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    break;
+                case WaitStrategy::Yield:
+                    std::this_thread::yield();
+                    break;
+                case WaitStrategy::Sleep:
+                    std::this_thread::sleep_for(sleep_);
+                    break;
+                case WaitStrategy::Park:
+                    cpu_relax();
+                    break;
+            }
+            ++count_;
+        }
+
+        // futex değeri hâlâ `expected` ise uyur (deadline'a kadar)
+        void park(std::atomic<std::uint32_t>& word, std::uint32_t expected) {
+            timespec ts{};
+            timespec* tsp = nullptr;
+            if (deadline_ != TimePoint::max()) {
+                auto left = deadline_ - std::chrono::steady_clock::now();
+                if (left <= std::chrono::nanoseconds::zero()) return;
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+                ts.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+                ts.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+                tsp = &ts;
+            }
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+                      expected, tsp, nullptr, 0);
+        }
+
+        bool expired() const {
+            return deadline_ != TimePoint::max() && std::chrono::steady_clock::now() >= deadline_;
+        }
+
+    private:
+        static constexpr int kMaxPauseShift = 10;
+        static constexpr int kParkSpins = 64;
+
+        WaitStrategy strategy_;
+        std::chrono::microseconds sleep_;
+        TimePoint deadline_;
+        int count_{0};  // Kaç kez bekledik
+    };
+
+    static Waiter::TimePoint deadline_for(std::chrono::nanoseconds timeout) {
+        if (timeout == std::chrono::nanoseconds::max()) return Waiter::TimePoint::max();
+        return std::chrono::steady_clock::now() + timeout;
+    }
+
+    // futex word'ü ilerletip bekleyenleri uyandırır
+    static void wake(std::atomic<std::uint32_t>& word, int count) {
+        word.fetch_add(1, std::memory_order_seq_cst);
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+                  count, nullptr, nullptr, 0);
+    }
+
+    // ========================================================================
+    // Member Variables
+    // ========================================================================
+    std::size_t capacity_{0};      // Ring buffer kapasitesi (2'nin kuvveti)
+    std::size_t mask_{0};          // Bitwise AND için mask (capacity - 1)
+    std::size_t chunk_size_{0};    // Her chunk'ın byte cinsinden boyutu
+    std::size_t shorts_per_chunk_{0};  // GPU short kapasitesi (chunk_size / sizeof(short))
+    
+    // Lane pointer'ları: heap modunda aşağıdaki sahipli dizilere, journal
+    // modunda dosya eşlemesine işaret eder. Hot path sadece bunları kullanır.
+    Slot* slots_{nullptr};
+    char* cpu_lane_{nullptr};
+    short* gpu_lane_{nullptr};
+    std::pair<int, double>* rf_lane_{nullptr};
+    std::size_t* size_lane_{nullptr};
+    std::uint64_t* seq_lane_{nullptr};   // Sadece sequence_tracking açıksa
+    std::uint32_t* crc_lane_{nullptr};   // Sadece checksum açıksa
+    ItemExpiry* expiry_lane_{nullptr};   // Sadece expiry açıksa (journal modunda da heap)
+
+    // Heap modu depolaması
+    // Slot dizisi: unique_ptr kullanıyoruz çünkü Slot içinde atomic var ve kopyalanamaz
+    std::unique_ptr<Slot[]> slot_storage_;
+    // CPU tarafı: tüm chunk'lar hizalı tek bir char dizisinde tutulur
+    AlignedBuffer<char> data_cpu_;
+    // GPU tarafı (simülasyon): short dizisi
+    std::vector<short> data_gpu_;
+    // Ek metadata
+    std::vector<std::pair<int, double>> meta_rf_signal_;
+    std::vector<std::size_t> meta_size_;
+    std::vector<std::uint64_t> meta_seq_;
+    std::vector<std::uint32_t> meta_crc_;
+    std::vector<ItemExpiry> meta_expiry_;
+
+    // Journal modu: dosya eşlemesi, flusher thread'i ve sayaçlar
+    std::unique_ptr<JournalFile> journal_;
+    std::size_t recovered_items_{0};
+    std::thread flusher_;
+    std::mutex flusher_mutex_;
+    std::mutex journal_sync_mutex_;   // sync_journal header yazımı + sync
+    std::condition_variable flusher_cv_;
+    bool flusher_stop_{false};
+    alignas(64) std::atomic<std::uint64_t> journal_commits_{0};
+    std::atomic<std::uint64_t> journal_syncs_{0};
+
+    // Checksum doğrulama sayaçları
+    std::atomic<std::uint64_t> checksum_verified_{0};
+    std::atomic<std::uint64_t> checksum_mismatches_{0};
+
+    // skip_expired() sayacı
+    std::atomic<std::uint64_t> expired_skipped_{0};
+    
+    BufferOptions options_;
+    
+    // head_: Consumer'ların okuduğu son pozisyon (atomik)
+    // tail_: Producer'ların yazdığı son pozisyon (atomik)
+    // alignas(64): False sharing'i önlemek için cache line (64 byte) hizalama
+    // Birden fazla thread aynı cache line'ı paylaşırsa performans düşer
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    
+    // Shutdown flag: Buffer'ın kapatıldığını gösterir
+    // Producer/Consumer'lar bu flag'i kontrol ederek çıkış yapar
+    alignas(64) std::atomic<bool> shutdown_{false};
+
+    // Readiness: eventfd ve "consumer epoll'da bekliyor" bayrağı
+    int event_fd_{-1};
+    alignas(64) std::atomic<bool> readiness_armed_{false};
+    std::atomic<std::uint64_t> readiness_signals_{0};
+
+    // Resize/trim kapısı: uçuştaki ticket sayısı ve kapı bayrağı
+    // (resizable/trimmable modda); resize_mutex_ resize ve trim'i sıralar
+    alignas(64) std::atomic<std::size_t> inflight_{0};
+    alignas(64) std::atomic<bool> gate_closed_{false};
+    std::atomic<std::uint64_t> resizes_{0};
+    mutable std::mutex resize_mutex_;
+    std::chrono::nanoseconds last_resize_pause_{0};
+    std::atomic<std::uint64_t> trims_{0};
+    std::atomic<std::uint64_t> trimmed_bytes_{0};
+    std::chrono::nanoseconds last_trim_pause_{0};
+    std::size_t storage_pins_ = 0;   // resize_mutex_ ile korunur (pin_storage)
+
+    // Park (futex): taraf başına uyandırma sayacı ve park etmiş thread sayısı
+    alignas(64) std::atomic<std::uint32_t> consumer_futex_{0};
+    std::atomic<std::uint32_t> consumers_parked_{0};
+    alignas(64) std::atomic<std::uint32_t> producer_futex_{0};
+    std::atomic<std::uint32_t> producers_parked_{0};
+
+#ifdef MPMC_TRACE
+    // İz kayıtlarında bu buffer'ın kimliği
+    std::uint8_t trace_ring_{mpmc_trace::Registry::instance().next_ring()};
+#endif
+};
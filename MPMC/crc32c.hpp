@@ -0,0 +1,155 @@
+// ============================================================================
+// CRC32C (Castagnoli): Chunk bütünlük sağlaması
+// ============================================================================
+// Üç uygulama, çalışma anında CPU'ya göre seçilir (derleme bayrağı gerekmez;
+// target attribute ile):
+//
+//   1. Skaler   : Bayt tablosu (her CPU)
+//   2. SSE4.2   : crc32 komutu, 8 bayt/komut (gecikme 3 döngü -> ~8 B/3 döngü)
+//   3. PCLMUL   : Büyük buffer'da 3 bağımsız crc32 akışı (A|B|C, her biri
+//                 kFoldLane bayt) paralel çalışır; sonuçlar carry-less çarpma
+//                 ile birleştirilir:
+//                   crc(A|B|C) = shift(crcA, 2L) ^ shift(crcB, L) ^ crcC
+//                   shift(c, n) = crc32_u64(0, clmul(c, x^(8n-33) mod P))
+//                 Böylece crc32 komutunun gecikmesi gizlenir (~3x).
+//
+// Fonksiyonlar "ham" durumla çalışır (başta/sonda ters çevirme crc32c()
+// içinde). Standart CRC32C: crc32c("123456789") == 0xE3069283.
+// ============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace crc32c_detail {
+
+constexpr std::uint32_t kPoly = 0x82F63B78u;   // Yansıtılmış Castagnoli polinomu
+constexpr std::size_t kFoldLane = 256;         // PCLMUL yolunda akış başına bayt
+
+struct Table {
+    std::uint32_t v[256];
+    constexpr Table() : v() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ ((c & 1) ? kPoly : 0);
+            v[i] = c;
+        }
+    }
+};
+inline constexpr Table kTable{};
+
+inline std::uint32_t update_scalar(std::uint32_t crc, const unsigned char* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) crc = kTable.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+// x^k mod P (yansıtılmış gösterim; bit 31 = x^0)
+constexpr std::uint32_t xpow_mod(std::size_t k) {
+    std::uint32_t r = 0x80000000u;
+    for (std::size_t i = 0; i < k; ++i) r = (r & 1) ? (r >> 1) ^ kPoly : r >> 1;
+    return r;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+inline std::uint32_t update_sse42(std::uint32_t crc, const unsigned char* p, std::size_t n) {
+    std::uint64_t c = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+    }
+    std::uint32_t c32 = static_cast<std::uint32_t>(c);
+    for (; n; --n, ++p) c32 = _mm_crc32_u8(c32, *p);
+    return c32;
+}
+
+// c'yi n bayt sıfır işlenmiş gibi ilerletir (k = x^(8n-33) mod P)
+__attribute__((target("sse4.2,pclmul")))
+inline std::uint32_t shift_clmul(std::uint32_t c, std::uint32_t k) {
+    const __m128i prod = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(c)),
+                                              _mm_cvtsi32_si128(static_cast<int>(k)), 0);
+    return static_cast<std::uint32_t>(_mm_crc32_u64(0, static_cast<std::uint64_t>(_mm_cvtsi128_si64(prod))));
+}
+
+__attribute__((target("sse4.2,pclmul")))
+inline std::uint32_t update_pclmul(std::uint32_t crc, const unsigned char* p, std::size_t n) {
+    static constexpr std::uint32_t k1 = xpow_mod(8 * 2 * kFoldLane - 33);   // shift 2L
+    static constexpr std::uint32_t k2 = xpow_mod(8 * kFoldLane - 33);       // shift L
+    while (n >= 3 * kFoldLane) {
+        std::uint64_t a = crc, b = 0, c = 0;
+        const unsigned char* pb = p + kFoldLane;
+        const unsigned char* pc = p + 2 * kFoldLane;
+        for (std::size_t i = 0; i < kFoldLane; i += 8) {
+            std::uint64_t wa, wb, wc;
+            std::memcpy(&wa, p + i, 8);
+            std::memcpy(&wb, pb + i, 8);
+            std::memcpy(&wc, pc + i, 8);
+            a = _mm_crc32_u64(a, wa);
+            b = _mm_crc32_u64(b, wb);
+            c = _mm_crc32_u64(c, wc);
+        }
+        crc = shift_clmul(static_cast<std::uint32_t>(a), k1) ^
+              shift_clmul(static_cast<std::uint32_t>(b), k2) ^ static_cast<std::uint32_t>(c);
+        p += 3 * kFoldLane;
+        n -= 3 * kFoldLane;
+    }
+    return update_sse42(crc, p, n);
+}
+#endif
+
+enum class Impl { Scalar, Sse42, Pclmul };
+
+inline Impl detect() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        return __builtin_cpu_supports("pclmul") ? Impl::Pclmul : Impl::Sse42;
+    }
+#endif
+    return Impl::Scalar;
+}
+
+inline Impl active() {
+    static const Impl impl = detect();
+    return impl;
+}
+
+}  // namespace crc32c_detail
+
+// ============================================================================
+// crc32c_update: ham CRC durumunu ilerletir (zincirleme için)
+// ============================================================================
+inline std::uint32_t crc32c_update(std::uint32_t state, const void* data, std::size_t n) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    using namespace crc32c_detail;
+#if defined(__x86_64__)
+    switch (active()) {
+        case Impl::Pclmul: return update_pclmul(state, p, n);
+        case Impl::Sse42: return update_sse42(state, p, n);
+        case Impl::Scalar: break;
+    }
+#endif
+    return update_scalar(state, p, n);
+}
+
+// Standart CRC32C (başlangıç ~0, sonuç ters çevrilmiş)
+inline std::uint32_t crc32c(const void* data, std::size_t n) {
+    return ~crc32c_update(~0u, data, n);
+}
+
+// Seçilen uygulamanın adı (bench/log için)
+inline const char* crc32c_impl_name() {
+    switch (crc32c_detail::active()) {
+        case crc32c_detail::Impl::Pclmul: return "pclmul";
+        case crc32c_detail::Impl::Sse42: return "sse4.2";
+        case crc32c_detail::Impl::Scalar: break;
+    }
+    return "scalar";
+}
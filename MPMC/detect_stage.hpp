@@ -0,0 +1,325 @@
+// ============================================================================
+// DetectStage: Uyarlanır eşikli burst / tepe olay dedektörü
+// ============================================================================
+// Chunk'ların çoğu gürültüdür; downstream sadece eşik üstü burst'leri ister.
+// DetectStage girdi ring'indeki gpu_ptr örneklerini (kanal = rf.first,
+// uzunluk CircularBuffer::sample_count) tarar,
+// |x| > eşik olan ardışık örnek run'larını bulur ve run başına TEK PeakEvent
+// kaydını olay ring'ine yazar. Ağır consumer'lar verinin ~%1'ini görür.
+//
+// TARAMA: AVX2 çekirdeği 16 örneği tek yükle alır: cmpgt(x, T) | cmpgt(-T, x)
+// + movemask_epi8 ile blok başına 32 bitlik isabet maskesi (örnek başına 2
+// bit) üretir, aynı geçişte abs + madd ile |x| toplamını biriktirir. Maskesi
+// sıfır bloklar (gürültünün tamamı) run makinesinde tek karşılaştırmayla
+// atlanır; sadece isabetli bloklarda örnek örnek yürünür. AVX2 yoksa aynı
+// maske biçimini üreten skaler yol (olaylar bit-bit aynı).
+//
+// GÜRÜLTÜ TABANI: kanal başına eşik altı örneklerin ortalama |x|'inin EMA'sı
+// (floor_alpha). Eşik = clamp(factor * taban, min_threshold, 32767); chunk
+// ÖNCEKİ chunk'lardan gelen tabanla taranır, burst kendi eşiğini yükseltmez.
+// Kanalın ilk chunk'ı önce tabanı ölçmek için bir kez daha taranır.
+//
+// RUN: eşik üstü örnekler arasında en fazla hold eşik altı örnek varsa aynı
+// run sayılır. Run'lar chunk sınırlarını aşar (kanal başına durum); offset
+// kanal akışındaki mutlak örnek indeksidir. Açık run'lar flush() ile yazılır.
+//
+// Kanallar yoğun kimliklerdir: 0 <= rf.first < max_channels; aralık dışı
+// chunk'lar dropped'ta sayılır. Çıktı ring'ine yazan TEK producer DetectStage
+// olmalıdır (CodecStage gibi). Çıktı ring'i doluysa olaylar bekletilir ve
+// girdi tüketilmez (geri basınç, AggregateStage gibi).
+// Çıktı chunk_size en az sizeof(PeakEvent) olmalıdır (aksi halde kurucu
+// invalid_argument atar; FftStage gibi).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Olay ring'inde slot başına bir kayıt (cpu_ptr); rf = {channel, peak}
+struct PeakEvent {
+    std::uint64_t offset;        // Run'ın ilk eşik üstü örneği (kanal akışında mutlak indeks)
+    std::int32_t channel;
+    std::uint32_t duration;      // İlk ve son eşik üstü örnek arası (dahil)
+    std::uint32_t peak_offset;   // Tepe örneğin offset'e uzaklığı
+    std::int16_t peak;           // En büyük |x|'li örnek (işaretli)
+    std::int16_t threshold;      // Run başladığında geçerli eşik
+};
+
+namespace detect_detail {
+
+constexpr std::size_t kBlock = 16;   // Maske bloğu (örnek); maske bit'i = 2 * örnek
+
+// -32768 -> 32767 doyurmalı |x|
+inline int magnitude(short x) {
+    return x < -32767 ? 32767 : std::abs(static_cast<int>(x));
+}
+
+// x[0..n) için blok maskeleri ve |x| toplamı (skaler)
+inline std::uint64_t scan_scalar(const short* x, std::size_t n, int threshold, std::uint32_t* masks) {
+    std::uint64_t sum = 0;
+    for (std::size_t b = 0; b * kBlock < n; ++b) {
+        const std::size_t len = std::min(kBlock, n - b * kBlock);
+        std::uint32_t m = 0;
+        for (std::size_t i = 0; i < len; ++i) {
+            const int a = magnitude(x[b * kBlock + i]);
+            sum += static_cast<std::uint64_t>(a);
+            if (a > threshold) m |= 3u << (2 * i);
+        }
+        masks[b] = m;
+    }
+    return sum;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+inline std::uint64_t scan_avx2(const short* x, std::size_t n, int threshold, std::uint32_t* masks) {
+    const __m256i hi = _mm256_set1_epi16(static_cast<short>(threshold));
+    const __m256i lo = _mm256_set1_epi16(static_cast<short>(-threshold));
+    const __m256i clamp = _mm256_set1_epi16(-32767);
+    const __m256i ones = _mm256_set1_epi16(1);
+    std::uint64_t sum = 0;
+    std::size_t b = 0;
+    const std::size_t full = n / kBlock;
+    while (b < full) {
+        // int32 lane'ler blok başına en fazla 65534 artar: 16384 blokta boşalt
+        const std::size_t end = std::min(full, b + 16384);
+        __m256i acc = _mm256_setzero_si256();
+        for (; b < end; ++b) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + b * kBlock));
+            v = _mm256_max_epi16(v, clamp);
+            const __m256i hit = _mm256_or_si256(_mm256_cmpgt_epi16(v, hi), _mm256_cmpgt_epi16(lo, v));
+            masks[b] = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_abs_epi16(v), ones));
+        }
+        alignas(32) std::uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        for (std::uint32_t l : lanes) sum += l;
+    }
+    if (full * kBlock < n) sum += scan_scalar(x + full * kBlock, n - full * kBlock, threshold, masks + full);
+    return sum;
+}
+#endif
+
+inline bool has_avx2() {
+#if defined(__x86_64__)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}  // namespace detect_detail
+
+class DetectStage {
+public:
+    struct Config {
+        double factor = 6.0;               // Eşik = factor * gürültü tabanı (ortalama |x|)
+        int min_threshold = 64;            // Eşiğin alt sınırı (sessiz kanal)
+        double floor_alpha = 1.0 / 16;     // Taban EMA katsayısı (chunk başına)
+        std::size_t hold = 4;              // Run içinde izin verilen eşik altı örnek
+        std::size_t max_channels = 256;    // Kanal kimlikleri [0, max_channels)
+        bool simd = true;                  // false: sadece skaler yol (karşılaştırma için)
+    };
+
+    struct Stats {
+        std::uint64_t chunks = 0;      // Taranan girdi chunk'ı
+        std::uint64_t samples = 0;     // Taranan örnek
+        std::uint64_t hits = 0;        // Eşik üstü örnek
+        std::uint64_t events = 0;      // Çıktı ring'ine yazılan olay
+        std::uint64_t dropped = 0;     // Kanalı aralık dışı chunk
+        std::uint64_t out_full = 0;    // Çıktı ring'i dolu (geri basınç) sayısı
+        std::uint64_t errors = 0;      // Kaybedilen commit (tek producer şartı ihlali)
+    };
+
+    DetectStage(CircularBuffer& in, CircularBuffer& out) : DetectStage(in, out, Config{}) {}
+    DetectStage(CircularBuffer& in, CircularBuffer& out, Config config)
+        : in_(in), out_(out), config_(config), channels_(config.max_channels),
+          masks_((in.shorts_per_chunk() + detect_detail::kBlock - 1) / detect_detail::kBlock) {
+        config_.min_threshold = std::clamp(config_.min_threshold, 1, 32767);
+        if (out_.chunk_size() < sizeof(PeakEvent)) {
+            throw std::invalid_argument("DetectStage: output chunk smaller than PeakEvent");
+        }
+    }
+
+    // ========================================================================
+    // pump: En fazla max_chunks girdi chunk'ı tarar; taranan sayıyı döner
+    // ========================================================================
+    // Önce bekleyen olaylar çıktı ring'ine yazılır; yazılamayan kalırsa
+    // girdi tüketilmez (0 döner).
+    // ========================================================================
+    std::size_t pump(std::size_t max_chunks = 64) {
+        constexpr std::size_t kBatch = 16;
+        CircularBuffer::Ticket batch[kBatch];
+        std::size_t done = 0;
+        while (done < max_chunks) {
+            if (!drain_pending()) break;
+            const std::size_t n = in_.claim_consumer_batch(batch, std::min(kBatch, max_chunks - done));
+            if (n == 0) break;
+            for (std::size_t i = 0; i < n; ++i) {
+                scan(batch[i]);
+                in_.release_consumer(batch[i]);
+            }
+            done += n;
+        }
+        return done;
+    }
+
+    // Açık run'ları kapatıp yayınlar (kapanış, zaman aşımı); yazılamayanlar
+    // bekletilir. Tüm olaylar çıktıya yazıldıysa true.
+    bool flush() {
+        for (std::size_t ch = 0; ch < channels_.size(); ++ch) {
+            if (channels_[ch].active) end_run(static_cast<int>(ch), channels_[ch]);
+        }
+        return drain_pending();
+    }
+
+    const Stats& stats() const { return stats_; }
+    const Config& config() const { return config_; }
+    std::size_t pending() const { return pending_.size(); }
+
+    // Kanalın gürültü tabanı (ortalama |x|; henüz veri yoksa 0) ve eşiği
+    double noise_floor(int channel) const { return valid(channel) ? state(channel).floor : 0.0; }
+    int threshold(int channel) const { return valid(channel) ? threshold_for(state(channel)) : 0; }
+
+private:
+    struct Channel {
+        std::uint64_t samples = 0;   // Kanalda şimdiye kadar taranan örnek
+        double floor = -1;           // < 0: henüz ölçülmedi
+        bool active = false;         // Açık run var
+        std::uint64_t start = 0;     // Açık run'ın ilk / son eşik üstü örneği
+        std::uint64_t last = 0;
+        std::uint64_t peak_at = 0;
+        short peak = 0;
+        int peak_mag = 0;
+        int run_threshold = 0;
+    };
+
+    bool valid(int ch) const { return ch >= 0 && static_cast<std::size_t>(ch) < channels_.size(); }
+    const Channel& state(int ch) const { return channels_[static_cast<std::size_t>(ch)]; }
+
+    int threshold_for(const Channel& s) const {
+        const double t = std::max(0.0, s.floor) * config_.factor;
+        return static_cast<int>(std::clamp(std::lround(t), static_cast<long>(config_.min_threshold), 32767L));
+    }
+
+    std::uint64_t scan_masks(const short* x, std::size_t n, int threshold) {
+#if defined(__x86_64__)
+        if (config_.simd && detect_detail::has_avx2()) return detect_detail::scan_avx2(x, n, threshold, masks_.data());
+#endif
+        return detect_detail::scan_scalar(x, n, threshold, masks_.data());
+    }
+
+    void scan(const CircularBuffer::Ticket& t) {
+        const int ch = t.rf->first;
+        if (!valid(ch)) {
+            ++stats_.dropped;
+            return;
+        }
+        Channel& s = channels_[static_cast<std::size_t>(ch)];
+        const short* x = t.gpu_ptr;
+        const std::size_t n = in_.sample_count(t);
+        if (n == 0) {
+            ++stats_.chunks;
+            return;
+        }
+        if (s.floor < 0) s.floor = static_cast<double>(scan_masks(x, n, 32767)) / static_cast<double>(n);
+
+        const int threshold = threshold_for(s);
+        const std::uint64_t sum = scan_masks(x, n, threshold);
+        std::uint64_t hit_sum = 0;
+        std::size_t hits = 0;
+        for (std::size_t b = 0; b * detect_detail::kBlock < n; ++b) {
+            const std::size_t base = b * detect_detail::kBlock;
+            for (std::uint32_t m = masks_[b]; m != 0; m &= m - 1, m &= m - 1) {
+                const std::size_t i = base + static_cast<std::size_t>(__builtin_ctz(m)) / 2;
+                const std::uint64_t p = s.samples + i;
+                const int a = detect_detail::magnitude(x[i]);
+                hit_sum += static_cast<std::uint64_t>(a);
+                ++hits;
+                if (s.active && p - s.last - 1 > config_.hold) end_run(ch, s);
+                if (!s.active) {
+                    s.active = true;
+                    s.start = p;
+                    s.peak_mag = -1;
+                    s.run_threshold = threshold;
+                }
+                s.last = p;
+                if (a > s.peak_mag) {
+                    s.peak_mag = a;
+                    s.peak = x[i];
+                    s.peak_at = p;
+                }
+            }
+            // Blok sonu (maskesi sıfır bloklar dahil): sessizlik hold'u aştıysa run biter
+            const std::uint64_t block_last = s.samples + std::min(base + detect_detail::kBlock, n) - 1;
+            if (s.active && block_last - s.last > config_.hold) end_run(ch, s);
+        }
+        s.samples += n;
+
+        // Taban: sadece eşik altı örneklerle (burst tabanı şişirmez)
+        if (hits < n) {
+            const double below = static_cast<double>(sum - hit_sum) / static_cast<double>(n - hits);
+            s.floor += config_.floor_alpha * (below - s.floor);
+        }
+        ++stats_.chunks;
+        stats_.samples += n;
+        stats_.hits += hits;
+    }
+
+    void end_run(int ch, Channel& s) {
+        PeakEvent e{};
+        e.offset = s.start;
+        e.channel = ch;
+        e.duration = static_cast<std::uint32_t>(s.last - s.start + 1);
+        e.peak_offset = static_cast<std::uint32_t>(s.peak_at - s.start);
+        e.peak = s.peak;
+        e.threshold = static_cast<std::int16_t>(s.run_threshold);
+        pending_.push_back(e);
+        s.active = false;
+    }
+
+    // Bekleyen olayları çıktı ring'ine yazar; hepsi yazıldıysa true
+    bool drain_pending() {
+        while (!pending_.empty()) {
+            auto o = out_.claim_producer();
+            if (!o) {
+                ++stats_.out_full;
+                return false;
+            }
+            const PeakEvent& e = pending_.front();
+            std::memcpy(o->cpu_ptr, &e, sizeof(e));
+            *o->size_ptr = sizeof(e);
+            *o->rf = {e.channel, static_cast<double>(e.peak)};
+            if (out_.commit_producer(*o)) ++stats_.events;
+            else ++stats_.errors;
+            pending_.pop_front();
+        }
+        return true;
+    }
+
+    CircularBuffer& in_;
+    CircularBuffer& out_;
+    Config config_;
+    Stats stats_;
+    std::vector<Channel> channels_;
+    std::vector<std::uint32_t> masks_;   // Tarama çıktısı: blok başına isabet maskesi
+    std::deque<PeakEvent> pending_;      // Çıktı ring'ine yazılmayı bekleyen olaylar
+};
@@ -0,0 +1,336 @@
+// ============================================================================
+// FFT Power Spectrum: int16 chunk'lar için pencereli güç spektrumu
+// ============================================================================
+// Spektrum monitörleri her data_gpu_ chunk'ını pencereler, FFT'sini alır ve
+// |X[k]|^2 hesaplar. Bağımlılık yok; n 2'nin kuvveti (>= 4):
+//
+//   P[k] = | sum_t (x[t] / 32768) * w[t] * e^{-2 pi i k t / n} |^2,  k = 0..n/2
+//   w = Hann (periyodik)
+//
+// PLAN (FftPlan): pencere, twiddle tabloları, çıktı permütasyonu ve gerçek
+// FFT ayrıştırma katsayıları bir kez hesaplanır.
+//
+// ALGORİTMA:
+//   1. Gerçek girdi paketlenir: z[m] = x[2m] + i x[2m+1] (m < n/2); n
+//      gerçek örnek n/2 karmaşık FFT ile çözülür.
+//   2. n/2 karmaşık FFT: radix-4 DIF aşamaları (log2(n/2) tekse sonda bir
+//      radix-2 aşaması). Çıktı karışık taban basamak-ters sırasındadır;
+//      permütasyon tablosuyla okunur (ayrı bit-reversal geçişi yok).
+//   3. Ayrıştırma: X[k] = Fe + W^k Fo, Fe = (Z[k] + Z*[M-k]) / 2,
+//      Fo = (Z[k] - Z*[M-k]) / 2i, ardından |X[k]|^2.
+//
+// VEKTÖRLEŞTİRME: Batch (en fazla 8 chunk) lane'lere yayılır: her karmaşık
+// eleman için 8 chunk'ın değeri tek 256 bit vektördür (SoA, re/im ayrı).
+// Böylece her aşama ve her kelebek span'dan bağımsız olarak tam genişlikte
+// çalışır; twiddle'lar skaler yayındır. Aynı kod GCC vektör tipleriyle
+// yazılır ve iki kez derlenir: target("avx2") ve varsayılan (SSE2 çiftleri);
+// çalışma anında seçilir.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace fft_detail {
+
+constexpr std::size_t kLanes = 8;
+typedef float v8f __attribute__((vector_size(32)));
+
+// 8 lane'lik eleman (vector<v8f> yerine: şablon argümanında öznitelik uyarısı yok)
+struct alignas(32) Lane8 {
+    float v[kLanes];
+};
+
+struct Stage {
+    std::size_t span;       // Kelebek girişleri arası mesafe
+    std::size_t radix;      // 4 veya 2
+    std::size_t twiddles;   // Stage'in twiddle tablosu başlangıcı (float)
+};
+
+// n/2 karmaşık FFT (DIF, yerinde); re/im: m eleman x 8 lane
+__attribute__((always_inline)) inline void transform(v8f* re, v8f* im, std::size_t m, const Stage* stages,
+                                                      std::size_t stage_count, const float* tw) {
+    for (std::size_t st = 0; st < stage_count; ++st) {
+        const std::size_t s = stages[st].span;
+        const float* w = tw + stages[st].twiddles;
+        if (stages[st].radix == 4) {
+            for (std::size_t base = 0; base < m; base += 4 * s) {
+                for (std::size_t j = 0; j < s; ++j) {
+                    const std::size_t i0 = base + j, i1 = i0 + s, i2 = i1 + s, i3 = i2 + s;
+                    const v8f t0r = re[i0] + re[i2], t0i = im[i0] + im[i2];
+                    const v8f t1r = re[i0] - re[i2], t1i = im[i0] - im[i2];
+                    const v8f t2r = re[i1] + re[i3], t2i = im[i1] + im[i3];
+                    const v8f t3r = re[i1] - re[i3], t3i = im[i1] - im[i3];
+                    re[i0] = t0r + t2r;
+                    im[i0] = t0i + t2i;
+                    // y1 = (t1 - i t3) w^j, y2 = (t0 - t2) w^2j, y3 = (t1 + i t3) w^3j
+                    const float* wj = w + 6 * j;
+                    const v8f y1r = t1r + t3i, y1i = t1i - t3r;
+                    const v8f y2r = t0r - t2r, y2i = t0i - t2i;
+                    const v8f y3r = t1r - t3i, y3i = t1i + t3r;
+                    re[i1] = y1r * wj[0] - y1i * wj[1];
+                    im[i1] = y1r * wj[1] + y1i * wj[0];
+                    re[i2] = y2r * wj[2] - y2i * wj[3];
+                    im[i2] = y2r * wj[3] + y2i * wj[2];
+                    re[i3] = y3r * wj[4] - y3i * wj[5];
+                    im[i3] = y3r * wj[5] + y3i * wj[4];
+                }
+            }
+        } else {
+            for (std::size_t base = 0; base < m; base += 2 * s) {
+                for (std::size_t j = 0; j < s; ++j) {
+                    const std::size_t i0 = base + j, i1 = i0 + s;
+                    const v8f dr = re[i0] - re[i1], di = im[i0] - im[i1];
+                    re[i0] = re[i0] + re[i1];
+                    im[i0] = im[i0] + im[i1];
+                    re[i1] = dr * w[2 * j] - di * w[2 * j + 1];
+                    im[i1] = dr * w[2 * j + 1] + di * w[2 * j];
+                }
+            }
+        }
+    }
+}
+
+// Gerçek FFT ayrıştırması + |X[k]|^2, k = 0..m; pos: frekans -> dizi konumu
+__attribute__((always_inline)) inline void power(const v8f* re, const v8f* im, std::size_t m,
+                                                  const std::uint32_t* pos, const float* split, v8f* out) {
+    for (std::size_t k = 0; k <= m; ++k) {
+        const std::size_t a = pos[k == m ? 0 : k];
+        const std::size_t b = pos[k == 0 ? 0 : m - k];
+        // Fe = (Z[k] + conj Z[m-k]) / 2, D = (Z[k] - conj Z[m-k]) / 2, Fo = -i D
+        const v8f fer = (re[a] + re[b]) * 0.5f, fei = (im[a] - im[b]) * 0.5f;
+        const v8f dr = (re[a] - re[b]) * 0.5f, di = (im[a] + im[b]) * 0.5f;
+        const v8f for_ = di, foi = -dr;
+        const float c = split[2 * k], s = split[2 * k + 1];   // W^k = c + i s
+        const v8f xr = fer + for_ * c - foi * s;
+        const v8f xi = fei + for_ * s + foi * c;
+        out[k] = xr * xr + xi * xi;
+    }
+}
+
+__attribute__((target("avx2"))) inline void run_avx2(v8f* re, v8f* im, std::size_t m, const Stage* stages,
+                                                      std::size_t stage_count, const float* tw,
+                                                      const std::uint32_t* pos, const float* split, v8f* out) {
+    transform(re, im, m, stages, stage_count, tw);
+    power(re, im, m, pos, split, out);
+}
+
+inline void run_generic(v8f* re, v8f* im, std::size_t m, const Stage* stages, std::size_t stage_count,
+                        const float* tw, const std::uint32_t* pos, const float* split, v8f* out) {
+    transform(re, im, m, stages, stage_count, tw);
+    power(re, im, m, pos, split, out);
+}
+
+inline bool has_avx2() {
+#if defined(__x86_64__)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}  // namespace fft_detail
+
+class FftPlan {
+public:
+    static constexpr std::size_t kBatch = fft_detail::kLanes;   // Çağrı başına en fazla chunk
+
+    explicit FftPlan(std::size_t n, bool simd = true) : n_(n), m_(n / 2), simd_(simd) {
+        if (n < 4 || (n & (n - 1)) != 0) throw std::invalid_argument("FftPlan: size must be a power of two >= 4");
+        constexpr double pi = std::numbers::pi;
+
+        window_.resize(n_);
+        for (std::size_t t = 0; t < n_; ++t) {
+            const double hann = 0.5 - 0.5 * std::cos(2 * pi * static_cast<double>(t) / static_cast<double>(n_));
+            window_[t] = static_cast<float>(hann / 32768.0);
+        }
+
+        // Aşamalar: radix-4 (kalan blok >= 4), gerekirse sonda radix-2
+        std::vector<std::size_t> radices;
+        for (std::size_t len = m_; len > 1;) {
+            const std::size_t r = len >= 4 ? 4 : 2;
+            const std::size_t s = len / r;
+            fft_detail::Stage st{s, r, twiddles_.size()};
+            for (std::size_t j = 0; j < s; ++j) {
+                for (std::size_t q = 1; q < r; ++q) {
+                    const double a = -2 * pi * static_cast<double>(q * j) / static_cast<double>(len);
+                    twiddles_.push_back(static_cast<float>(std::cos(a)));
+                    twiddles_.push_back(static_cast<float>(std::sin(a)));
+                }
+            }
+            stages_.push_back(st);
+            radices.push_back(r);
+            len = s;
+        }
+
+        // Frekans k'nın DIF çıktısındaki konumu (karışık taban basamak-tersi)
+        positions_.resize(m_);
+        for (std::size_t k = 0; k < m_; ++k) {
+            std::size_t p = 0, len = m_, rest = k;
+            for (std::size_t r : radices) {
+                len /= r;
+                p += (rest % r) * len;
+                rest /= r;
+            }
+            positions_[k] = static_cast<std::uint32_t>(p);
+        }
+
+        split_.resize(2 * (m_ + 1));
+        for (std::size_t k = 0; k <= m_; ++k) {
+            const double a = -2 * pi * static_cast<double>(k) / static_cast<double>(n_);
+            split_[2 * k] = static_cast<float>(std::cos(a));
+            split_[2 * k + 1] = static_cast<float>(std::sin(a));
+        }
+
+        re_.resize(m_);
+        im_.resize(m_);
+        power_.resize(m_ + 1);
+    }
+
+    std::size_t size() const { return n_; }
+    std::size_t bins() const { return m_ + 1; }
+    bool simd() const { return simd_ && fft_detail::has_avx2(); }
+
+    // ========================================================================
+    // power_spectrum: count (<= kBatch) chunk'ın güç spektrumu
+    // ========================================================================
+    // in[b]: n örnek; out[b]: bins() float. Tek çağrıda tüm batch lane'lerde
+    // birlikte dönüştürülür; kullanılmayan lane'ler sıfırdır.
+    // ========================================================================
+    void power_spectrum(const short* const* in, std::size_t count, float* const* out) {
+        using fft_detail::Lane8;
+        count = std::min(count, kBatch);
+        for (std::size_t m = 0; m < m_; ++m) {
+            Lane8& r = re_[m];
+            Lane8& i = im_[m];
+            const float w0 = window_[2 * m], w1 = window_[2 * m + 1];
+            for (std::size_t b = 0; b < kBatch; ++b) {
+                r.v[b] = b < count ? in[b][2 * m] * w0 : 0.0f;
+                i.v[b] = b < count ? in[b][2 * m + 1] * w1 : 0.0f;
+            }
+        }
+
+        auto* re = reinterpret_cast<fft_detail::v8f*>(re_.data());
+        auto* im = reinterpret_cast<fft_detail::v8f*>(im_.data());
+        auto* pw = reinterpret_cast<fft_detail::v8f*>(power_.data());
+        if (simd()) {
+            fft_detail::run_avx2(re, im, m_, stages_.data(), stages_.size(), twiddles_.data(), positions_.data(),
+                                 split_.data(), pw);
+        } else {
+            fft_detail::run_generic(re, im, m_, stages_.data(), stages_.size(), twiddles_.data(),
+                                    positions_.data(), split_.data(), pw);
+        }
+
+        for (std::size_t k = 0; k <= m_; ++k) {
+            for (std::size_t b = 0; b < count; ++b) out[b][k] = power_[k].v[b];
+        }
+    }
+
+private:
+    std::size_t n_;
+    std::size_t m_;   // n / 2 (karmaşık FFT boyu)
+    bool simd_;
+    std::vector<float> window_;
+    std::vector<fft_detail::Stage> stages_;
+    std::vector<float> twiddles_;
+    std::vector<std::uint32_t> positions_;
+    std::vector<float> split_;
+    std::vector<fft_detail::Lane8> re_, im_, power_;
+};
+
+// ============================================================================
+// FftStage: Tüketilen chunk'ların güç spektrumunu ikinci bir ring'e yazar
+// ============================================================================
+// Girdi: gpu_ptr'nin ilk n örneği (n <= shorts_per_chunk); sample_count < n
+// ise (bkz. CircularBuffer::sample_count) eksik kısım sıfırla doldurulur.
+// Çıktı: cpu_ptr'ye
+// bins() = n/2 + 1 float, *size_ptr = bins() * sizeof(float); rf ve seq
+// lane'i aynen taşınır. pump() her turda en fazla 8 chunk'ı tek batch olarak
+// claim eder (claim_consumer_batch / claim_producer_batch) ve birlikte
+// dönüştürür. Çıktı chunk_size en az bins() * sizeof(float) olmalıdır (aksi
+// halde kurucu invalid_argument atar). Çıktı buffer'ına yazan TEK producer
+// FftStage olmalıdır (CodecStage gibi).
+// ============================================================================
+class FftStage {
+public:
+    struct Stats {
+        std::uint64_t chunks = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t errors = 0;   // Kaybedilen commit (tek producer şartı ihlali)
+    };
+
+    FftStage(CircularBuffer& in, CircularBuffer& out, std::size_t n, bool simd = true)
+        : in_(in), out_(out), plan_(n, simd), pad_(FftPlan::kBatch * n) {
+        if (n > in_.shorts_per_chunk() || plan_.bins() * sizeof(float) > out_.chunk_size()) {
+            throw std::invalid_argument("FftStage: fft size exceeds input chunk or output chunk too small");
+        }
+    }
+
+    // En fazla max_chunks chunk işler (girdi boş / çıktı ring'i doluysa durur)
+    std::size_t pump(std::size_t max_chunks = 64) {
+        CircularBuffer::Ticket o[FftPlan::kBatch];
+        CircularBuffer::Ticket i[FftPlan::kBatch];
+        std::size_t done = 0;
+        while (done < max_chunks) {
+            const std::size_t want = std::min(FftPlan::kBatch, max_chunks - done);
+            const std::size_t n_out = out_.claim_producer_batch(o, want);
+            if (n_out == 0) break;
+            const std::size_t n = in_.claim_consumer_batch(i, n_out);
+            for (std::size_t k = n; k < n_out; ++k) out_.abandon_producer(o[k]);
+            if (n == 0) break;
+
+            const short* src[FftPlan::kBatch];
+            float* dst[FftPlan::kBatch];
+            const std::size_t points = pad_.size() / FftPlan::kBatch;
+            for (std::size_t k = 0; k < n; ++k) {
+                src[k] = i[k].gpu_ptr;
+                const std::size_t valid = in_.sample_count(i[k]);
+                if (valid < points) {
+                    // Kısa chunk: sıfır dolgulu kopya (chunk'ın kalanı geçersiz)
+                    short* p = pad_.data() + k * points;
+                    std::copy(i[k].gpu_ptr, i[k].gpu_ptr + valid, p);
+                    std::fill(p + valid, p + points, short{0});
+                    src[k] = p;
+                }
+                dst[k] = reinterpret_cast<float*>(o[k].cpu_ptr);
+            }
+            plan_.power_spectrum(src, n, dst);
+            for (std::size_t k = 0; k < n; ++k) {
+                *o[k].rf = *i[k].rf;
+                if (i[k].seq_ptr && o[k].seq_ptr) *o[k].seq_ptr = *i[k].seq_ptr;
+                *o[k].size_ptr = plan_.bins() * sizeof(float);
+                in_.release_consumer(i[k]);
+            }
+            for (std::size_t k = 0; k < n; ++k) {
+                if (!out_.commit_producer(o[k])) ++stats_.errors;
+            }
+            stats_.chunks += n;
+            ++stats_.batches;
+            done += n;
+        }
+        return done;
+    }
+
+    FftPlan& plan() { return plan_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    CircularBuffer& in_;
+    CircularBuffer& out_;
+    FftPlan plan_;
+    std::vector<short> pad_;   // kBatch x n: kısa chunk'lar için sıfır dolgulu girdi
+    Stats stats_;
+};
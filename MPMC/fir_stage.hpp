@@ -0,0 +1,288 @@
+// ============================================================================
+// FIR Decimation: int16 örnekler üzerinde alçak geçiren FIR + N'e seyreltme
+// ============================================================================
+// data_gpu_ chunk'ları kanal başına sürekli bir örnek akışıdır (kanal =
+// rf.first). FirDecimator akışı Q15 katsayılarla süzer ve her D'inci
+// çıktıyı tutar:
+//
+//   y[m] = sat16((sum_k h[k] * x[mD - k] + 2^14) >> 15)
+//
+// Sadece tutulan çıktılar hesaplanır (D kat daha az iş). Kanal başına durum
+// chunk sınırları boyunca korunur: son T-1 örnek (geçmiş) ve bir sonraki
+// çıktının faz ofseti; chunk uzunluğunun D'nin katı olması gerekmez.
+//
+// Uygulamalar (çalışma anında seçilir, derleme bayrağı gerekmez):
+//   1. AVX2 : _mm256_madd_epi16 — 16 örnek x 16 katsayı -> 8 int32 kısmi
+//             toplam. 8 çıktı birlikte hesaplanır, katsayı vektörü 8 kez
+//             kullanılır; toplamlar hadd ağacıyla tek vektörde birleşir.
+//   2. Skaler: aynı int32 aritmetiği (sonuçlar bit-bit aynı)
+//
+// NOT: madd iki çarpımı int32'de toplar; iki -32768 * -32768 çarpımı
+// taşar. Q15 katsayılar |h| < 1 olduğundan (-32768 kullanılmaz) pratikte
+// oluşmaz; skaler yol da aynı modüler toplamı yapar.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace fir_detail {
+
+inline short round_q15(std::uint32_t acc) {
+    const std::int32_t v = static_cast<std::int32_t>(acc + (1u << 14)) >> 15;
+    return static_cast<short>(std::clamp<std::int32_t>(v, -32768, 32767));
+}
+
+// Pencere w[0..tp) ile ters çevrilmiş, 16'ya dolgulu katsayılar hr'nin skaler çarpımı
+inline short dot_scalar(const short* w, const short* hr, std::size_t tp) {
+    std::uint32_t acc = 0;   // madd ile aynı modüler toplam
+    for (std::size_t j = 0; j < tp; ++j) {
+        acc += static_cast<std::uint32_t>(static_cast<std::int32_t>(w[j]) * hr[j]);
+    }
+    return round_q15(acc);
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+inline __m256i dot8_avx2(const short* w, std::size_t step, const short* hr, std::size_t tp) {
+    __m256i acc[8];
+    for (auto& a : acc) a = _mm256_setzero_si256();
+    for (std::size_t c = 0; c < tp; c += 16) {
+        const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hr + c));
+        for (std::size_t m = 0; m < 8; ++m) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + m * step + c));
+            acc[m] = _mm256_add_epi32(acc[m], _mm256_madd_epi16(x, h));
+        }
+    }
+    // hadd ağacı: 8 vektörün yatay toplamları tek vektörde [s0..s7]
+    const __m256i h01 = _mm256_hadd_epi32(acc[0], acc[1]);
+    const __m256i h23 = _mm256_hadd_epi32(acc[2], acc[3]);
+    const __m256i h45 = _mm256_hadd_epi32(acc[4], acc[5]);
+    const __m256i h67 = _mm256_hadd_epi32(acc[6], acc[7]);
+    const __m256i h0123 = _mm256_hadd_epi32(h01, h23);   // [s0 s1 s2 s3 | s0 s1 s2 s3] (yarım toplamlar)
+    const __m256i h4567 = _mm256_hadd_epi32(h45, h67);
+    return _mm256_add_epi32(_mm256_permute2x128_si256(h0123, h4567, 0x20),
+                            _mm256_permute2x128_si256(h0123, h4567, 0x31));
+}
+
+// count çıktı: pencere i, w + i * step'te başlar
+__attribute__((target("avx2")))
+inline void run_avx2(const short* w, std::size_t step, std::size_t count, const short* hr, std::size_t tp,
+                     short* out) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        alignas(32) std::uint32_t sums[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), dot8_avx2(w + i * step, step, hr, tp));
+        for (std::size_t m = 0; m < 8; ++m) out[i + m] = round_q15(sums[m]);
+    }
+    for (; i < count; ++i) out[i] = dot_scalar(w + i * step, hr, tp);
+}
+#endif
+
+inline bool has_avx2() {
+#if defined(__x86_64__)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}  // namespace fir_detail
+
+class FirDecimator {
+public:
+    // taps: Q15 katsayılar (h[0] en yeni örneğe uygulanır); decimation >= 1
+    FirDecimator(std::vector<short> taps, std::size_t decimation, bool simd = true) : simd_(simd) {
+        set_taps(std::move(taps), decimation);
+    }
+
+    // Katsayıları/seyreltmeyi değiştirir; tüm kanal durumları sıfırlanır
+    void set_taps(std::vector<short> taps, std::size_t decimation) {
+        if (taps.empty() || decimation == 0) {
+            throw std::invalid_argument("FirDecimator: empty taps or zero decimation");
+        }
+        taps_ = std::move(taps);
+        decimation_ = decimation;
+        padded_ = (taps_.size() + 15) / 16 * 16;
+        reversed_.assign(padded_, 0);
+        for (std::size_t j = 0; j < taps_.size(); ++j) reversed_[j] = taps_[taps_.size() - 1 - j];
+        channels_.clear();
+    }
+
+    // ========================================================================
+    // lowpass_taps: Hamming pencereli sinc, kesim = cutoff (0..0.5, fs'e göre)
+    // ========================================================================
+    // Kazanç 1'e (Q15 toplam ~32767) normalize edilir. Seyreltme D için
+    // tipik seçim cutoff ~ 0.5 / D.
+    // ========================================================================
+    static std::vector<short> lowpass_taps(std::size_t count, double cutoff) {
+        std::vector<double> h(count);
+        constexpr double pi = std::numbers::pi;
+        const double mid = (static_cast<double>(count) - 1) / 2;
+        double sum = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const double x = static_cast<double>(i) - mid;
+            const double sinc = x == 0 ? 2 * cutoff : std::sin(2 * pi * cutoff * x) / (pi * x);
+            const double window =
+                count > 1 ? 0.54 - 0.46 * std::cos(2 * pi * static_cast<double>(i) / static_cast<double>(count - 1))
+                          : 1.0;
+            h[i] = sinc * window;
+            sum += h[i];
+        }
+        std::vector<short> q(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            q[i] = static_cast<short>(std::clamp(std::lround(h[i] / sum * 32767.0), -32767l, 32767l));
+        }
+        return q;
+    }
+
+    // n girdi örneği için en fazla çıktı
+    std::size_t max_output(std::size_t n) const { return (n + decimation_ - 1) / decimation_; }
+
+    // ========================================================================
+    // process: channel akışının sonraki n örneğini süzer; çıktı sayısını döner
+    // ========================================================================
+    // out en az max_output(n) örnek olmalıdır.
+    // ========================================================================
+    std::size_t process(int channel, const short* in, std::size_t n, short* out) {
+        const std::size_t hist = taps_.size() - 1;
+        auto [it, inserted] = channels_.try_emplace(channel);
+        State& st = it->second;
+        if (inserted) st.history.assign(hist, 0);
+
+        // Çalışma alanı: geçmiş + yeni örnekler + dolgu (padded_ okuması için)
+        work_.resize(hist + n + padded_);
+        // Tek tap'li filtrede geçmiş boştur (data() nullptr olabilir; memcpy'ye verilmez)
+        if (hist) std::memcpy(work_.data(), st.history.data(), hist * sizeof(short));
+        if (n) std::memcpy(work_.data() + hist, in, n * sizeof(short));
+        std::fill(work_.begin() + static_cast<std::ptrdiff_t>(hist + n), work_.end(), 0);
+
+        // Girdi i için pencere work_[i .. i + T) (i = 0: ilk yeni örnek, geçmişle)
+        std::size_t count = 0;
+        if (st.phase < n) {
+            count = (n - st.phase + decimation_ - 1) / decimation_;
+            const short* w = work_.data() + st.phase;
+#if defined(__x86_64__)
+            if (simd_ && fir_detail::has_avx2()) {
+                fir_detail::run_avx2(w, decimation_, count, reversed_.data(), padded_, out);
+            } else
+#endif
+            {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = fir_detail::dot_scalar(w + i * decimation_, reversed_.data(), padded_);
+                }
+            }
+            st.phase = st.phase + count * decimation_ - n;
+        } else {
+            st.phase -= n;
+        }
+        if (hist) std::memcpy(st.history.data(), work_.data() + n, hist * sizeof(short));
+        return count;
+    }
+
+    std::size_t decimation() const { return decimation_; }
+    std::size_t tap_count() const { return taps_.size(); }
+    bool simd() const { return simd_ && fir_detail::has_avx2(); }
+    void reset() { channels_.clear(); }
+
+private:
+    struct State {
+        std::vector<short> history;   // Son T-1 örnek (eskiden yeniye)
+        std::size_t phase = 0;        // Sonraki çıktının bu chunk'taki girdi indeksi
+    };
+
+    std::vector<short> taps_;
+    std::vector<short> reversed_;   // Ters çevrilmiş, padded_'a sıfır dolgulu
+    std::size_t decimation_{1};
+    std::size_t padded_{16};
+    bool simd_;
+    std::unordered_map<int, State> channels_;
+    std::vector<short> work_;
+};
+
+// ============================================================================
+// FirStage: Tüketilen chunk'ları süzüp seyrelterek ikinci bir ring'e aktarır
+// ============================================================================
+// Girdi: gpu_ptr[0..sample_count) örnekleri (bkz. CircularBuffer::sample_count),
+// kanal = rf.first.
+// Çıktı: gpu_ptr'ye seyreltilmiş örnekler, *size_ptr = örnek * sizeof(short);
+// rf ve seq lane'i aynen taşınır. Çıktı shorts_per_chunk en az
+// max_output(girdi shorts_per_chunk) olmalıdır (aksi halde chunk errors'ta
+// sayılır ve durum ilerlemez). Çıktı buffer'ına yazan TEK producer FirStage
+// olmalıdır (CodecStage gibi).
+// ============================================================================
+class FirStage {
+public:
+    struct Stats {
+        std::uint64_t chunks = 0;
+        std::uint64_t in_samples = 0;
+        std::uint64_t out_samples = 0;
+        std::uint64_t errors = 0;   // Sığmayan / kaybedilen chunk
+    };
+
+    FirStage(CircularBuffer& in, CircularBuffer& out, std::vector<short> taps, std::size_t decimation,
+             bool simd = true)
+        : in_(in), out_(out), fir_(std::move(taps), decimation, simd) {}
+
+    // En fazla max_chunks chunk işler (girdi boş / çıktı ring'i doluysa durur)
+    std::size_t pump(std::size_t max_chunks = 64) {
+        std::size_t done = 0;
+        while (done < max_chunks) {
+            auto o = out_.claim_producer();
+            if (!o) break;
+            auto i = in_.claim_consumer();
+            if (!i) {
+                out_.abandon_producer(*o);
+                break;
+            }
+            process(*i, *o);
+            in_.release_consumer(*i);
+            if (!out_.commit_producer(*o)) ++stats_.errors;
+            ++done;
+        }
+        return done;
+    }
+
+    FirDecimator& decimator() { return fir_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    void process(const CircularBuffer::Ticket& i, const CircularBuffer::Ticket& o) {
+        *o.rf = *i.rf;
+        if (i.seq_ptr && o.seq_ptr) *o.seq_ptr = *i.seq_ptr;
+        const std::size_t n = in_.sample_count(i);
+        std::size_t written = 0;
+        if (fir_.max_output(n) <= out_.shorts_per_chunk()) {
+            written = fir_.process(i.rf->first, i.gpu_ptr, n, o.gpu_ptr);
+            stats_.in_samples += n;
+            stats_.out_samples += written;
+        } else {
+            ++stats_.errors;
+        }
+        *o.size_ptr = written * sizeof(short);
+        ++stats_.chunks;
+    }
+
+    CircularBuffer& in_;
+    CircularBuffer& out_;
+    FirDecimator fir_;
+    Stats stats_;
+};
@@ -0,0 +1,206 @@
+// ============================================================================
+// JournalFile: CircularBuffer lane'leri için mmap'li kalıcı dosya düzeni
+// ============================================================================
+// Journal modunda (BufferOptions::journal_path) ring'in tüm lane'leri heap
+// yerine bu dosyanın MAP_SHARED eşlemesinde yaşar. Producer'lar chunk'ı
+// doğrudan dosya sayfalarına yazar; ayrı bir log kopyası yoktur.
+//
+// DOSYA DÜZENİ (her bölüm kPageSize hizalı):
+//   [Header]  magic, sürüm, geometri, lane offset'leri, cursor checkpoint'i
+//   [slots]   capacity x uint64 (Slot::seq)       <- kalıcı durumun kaynağı
+//   [cpu]     capacity x chunk_size
+//   [gpu]     capacity x shorts_per_chunk x short
+//   [rf]      capacity x pair<int,double>
+//   [size]    capacity x size_t
+//   [seq]     capacity x uint64 (sadece sequence_tracking açıksa)
+//   [crc]     capacity x uint32 (sadece checksum açıksa)
+//
+// Header'daki head/tail sadece checkpoint'tir (sync ve kapanışta yazılır);
+// yeniden açılışta gerçek durum slot seq'lerinden kurulur (bkz.
+// CircularBuffer::recover_journal).
+//
+// DAYANIKLILIK:
+// - Process çökmesi: MAP_SHARED sayfalar page cache'te kalır, sync gerekmez
+// - Güç/kernel kaybı: sadece son sync()'e kadar commit edilenler garanti
+// sync() msync(MS_SYNC) veya fdatasync ile yapılır (JournalSync).
+// ============================================================================
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Commit'lerin diske indirilme yöntemi
+enum class JournalSync {
+    None,       // Sadece page cache (process çökmesine dayanıklı)
+    Msync,      // msync(MS_SYNC) ile eşlemenin tamamı
+    Fdatasync   // fdatasync(fd)
+};
+
+inline const char* journal_sync_name(JournalSync s) {
+    switch (s) {
+        case JournalSync::None: return "None";
+        case JournalSync::Msync: return "Msync";
+        case JournalSync::Fdatasync: return "Fdatasync";
+    }
+    return "?";
+}
+
+class JournalFile {
+public:
+    static constexpr std::size_t kPageSize = 4096;
+    static constexpr std::uint64_t kMagic = 0x314E524A434D504Dull;  // "MPMCJRN1"
+    static constexpr std::uint32_t kVersion = 2;
+
+    // Dosyanın ilk sayfası
+    struct Header {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t has_seq_lane;       // sequence_tracking lane'i var mı
+        std::uint32_t has_crc_lane;       // checksum lane'i var mı
+        std::uint32_t reserved0;
+        std::uint64_t capacity;
+        std::uint64_t chunk_size;
+        std::uint64_t shorts_per_chunk;
+        std::uint64_t slots_offset;
+        std::uint64_t cpu_offset;
+        std::uint64_t gpu_offset;
+        std::uint64_t rf_offset;
+        std::uint64_t size_offset;
+        std::uint64_t seq_offset;
+        std::uint64_t crc_offset;
+        std::uint64_t total_bytes;
+        std::uint64_t head;               // Cursor checkpoint'i (sync/kapanış)
+        std::uint64_t tail;
+        std::uint64_t clean_shutdown;     // 1: son kapanış düzgün
+    };
+    static_assert(sizeof(Header) <= kPageSize, "Header tek sayfaya sığmalı");
+
+    JournalFile() = default;
+    ~JournalFile() { close(); }
+
+    JournalFile(const JournalFile&) = delete;
+    JournalFile& operator=(const JournalFile&) = delete;
+
+    // ========================================================================
+    // open: Dosyayı açar/oluşturur ve eşler
+    // ========================================================================
+    // Dosya yoksa/boşsa sıfırdan oluşturulur (created() == true). Varsa
+    // geometri header ile aynı olmalıdır; değilse std::invalid_argument.
+    // Syscall hataları std::system_error olarak fırlatılır.
+    // ========================================================================
+    void open(const std::string& path, std::size_t capacity, std::size_t chunk_size,
+              std::size_t shorts_per_chunk, bool seq_lane, bool crc_lane) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw_errno("journal open");
+
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0) throw_errno("journal fstat");
+
+        Header layout{};
+        layout.magic = kMagic;
+        layout.version = kVersion;
+        layout.has_seq_lane = seq_lane ? 1 : 0;
+        layout.has_crc_lane = crc_lane ? 1 : 0;
+        layout.capacity = capacity;
+        layout.chunk_size = chunk_size;
+        layout.shorts_per_chunk = shorts_per_chunk;
+        std::uint64_t off = kPageSize;
+        auto place = [&](std::uint64_t bytes) {
+            const std::uint64_t at = off;
+            off += round_up(bytes);
+            return at;
+        };
+        layout.slots_offset = place(capacity * sizeof(std::uint64_t));
+        layout.cpu_offset = place(capacity * chunk_size);
+        layout.gpu_offset = place(capacity * shorts_per_chunk * sizeof(short));
+        layout.rf_offset = place(capacity * sizeof(std::pair<int, double>));
+        layout.size_offset = place(capacity * sizeof(std::size_t));
+        layout.seq_offset = seq_lane ? place(capacity * sizeof(std::uint64_t)) : 0;
+        layout.crc_offset = crc_lane ? place(capacity * sizeof(std::uint32_t)) : 0;
+        layout.total_bytes = off;
+
+        created_ = st.st_size == 0;
+        if (created_) {
+            // Sıfır dolu sparse dosya; slot seq'leri çağıran başlatır
+            if (::ftruncate(fd_, static_cast<off_t>(layout.total_bytes)) != 0) throw_errno("journal ftruncate");
+        } else {
+            Header existing{};
+            if (static_cast<std::uint64_t>(st.st_size) < sizeof(Header) ||
+                ::pread(fd_, &existing, sizeof(existing), 0) != static_cast<ssize_t>(sizeof(existing)) ||
+                existing.magic != kMagic || existing.version != kVersion) {
+                throw std::invalid_argument("journal: not a ring journal: " + path);
+            }
+            if (existing.capacity != layout.capacity || existing.chunk_size != layout.chunk_size ||
+                existing.has_seq_lane != layout.has_seq_lane ||
+                existing.has_crc_lane != layout.has_crc_lane ||
+                static_cast<std::uint64_t>(st.st_size) < layout.total_bytes) {
+                throw std::invalid_argument("journal: geometry mismatch: " + path);
+            }
+        }
+
+        bytes_ = layout.total_bytes;
+        void* base = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) throw_errno("journal mmap");
+        base_ = static_cast<char*>(base);
+
+        Header& h = header();
+        if (created_) {
+            h = layout;
+        } else {
+            was_clean_ = h.clean_shutdown == 1;
+        }
+        h.clean_shutdown = 0;  // Kapanışa kadar "kirli"
+    }
+
+    void close() {
+        if (base_) ::munmap(base_, bytes_);
+        if (fd_ >= 0) ::close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+    }
+
+    // Eşlemeyi seçilen yöntemle diske indirir; başarısızsa false (errno)
+    bool sync(JournalSync how) {
+        switch (how) {
+            case JournalSync::None: return true;
+            case JournalSync::Msync: return ::msync(base_, bytes_, MS_SYNC) == 0;
+            case JournalSync::Fdatasync: return ::fdatasync(fd_) == 0;
+        }
+        return false;
+    }
+
+    Header& header() { return *reinterpret_cast<Header*>(base_); }
+
+    // Lane başlangıcı (offset header'dan)
+    template <typename T>
+    T* lane(std::uint64_t offset) { return reinterpret_cast<T*>(base_ + offset); }
+
+    bool created() const { return created_; }
+    bool was_clean() const { return was_clean_; }
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    static std::uint64_t round_up(std::uint64_t v) { return (v + kPageSize - 1) / kPageSize * kPageSize; }
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    int fd_{-1};
+    char* base_{nullptr};
+    std::size_t bytes_{0};
+    bool created_{false};
+    bool was_clean_{false};
+};
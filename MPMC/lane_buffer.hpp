@@ -0,0 +1,193 @@
+// ============================================================================
+// Priority Lane Buffer: Öncelik lane'leri + ağırlıklı consumer zamanlaması
+// ============================================================================
+// Kontrol mesajları (retune, gain komutları) bulk sample'larla aynı ring'i
+// paylaşınca binlerce bulk chunk'ın arkasında bekler. LaneBuffer sabit sayıda
+// lane tutar; her lane ayrı bir CircularBuffer'dır. Lane 0 en yüksek önceliktir.
+//
+// - Producer: item başına lane seçer (claim_producer(lane))
+// - Consumer: Policy'ye göre lane seçer
+//     StrictPriority     : Dolu olan en düşük indeksli lane her zaman önce
+//     WeightedRoundRobin : Her lane sırayla weight[lane] kadar item verir
+//
+// HIZLI YOL (ready_mask_):
+// Her lane için "boş olmayabilir" biti tutulur. Consumer önce tek bir atomic
+// load ile maskeyi okur; boş lane'lere hiç dokunmaz. Tüm yüksek öncelikli
+// lane'ler boşken claim maliyeti = 1 mask load + 1 lane claim.
+//
+// BİT PROTOKOLÜ (lost wake-up olmadan):
+// - Producer: commit -> seq_cst fence -> bit kapalıysa fetch_or ile aç
+// - Consumer: lane boş görünürse fetch_and ile biti kapat -> seq_cst fence ->
+//   lane'i tekrar kontrol et; item varsa biti geri aç
+// İki taraf da fence kullandığı için "producer biti açık gördü, consumer
+// item'ı görmedi" durumu oluşamaz (Dekker deseni).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class LaneBuffer {
+public:
+    static constexpr std::size_t kMaxLanes = 64;  // ready_mask_ bit sayısı
+
+    enum class Policy { StrictPriority, WeightedRoundRobin };
+
+    // Claim edilen slot + ait olduğu lane
+    struct Ticket {
+        CircularBuffer::Ticket slot;   // Lane içindeki slot bilgisi
+        std::size_t lane;              // Lane indeksi (0 = en yüksek öncelik)
+
+        CircularBuffer::Ticket* operator->() { return &slot; }
+        const CircularBuffer::Ticket* operator->() const { return &slot; }
+    };
+
+    // ========================================================================
+    // Cursor: Consumer başına WRR durumu (StrictPriority'de kullanılmaz)
+    // ========================================================================
+    // Her consumer thread kendi Cursor'ını tutar; paylaşılan zamanlama durumu
+    // olmadığı için claim yolunda ek atomic işlem yoktur.
+    // ========================================================================
+    struct Cursor {
+        std::size_t lane = SIZE_MAX;  // Şu an servis edilen lane (SIZE_MAX: henüz yok)
+        unsigned credit = 0;          // Bu lane'den kalan item hakkı
+    };
+
+    // Constructor: lane_count adet lane, her biri capacity_per_lane chunk.
+    // weights boşsa tüm lane'ler 1 ağırlık alır (WRR = düz round robin).
+    LaneBuffer(std::size_t lane_count, std::size_t capacity_per_lane,
+               std::size_t chunk_size, Policy policy = Policy::StrictPriority,
+               std::vector<unsigned> weights = {}, const BufferOptions& options = {})
+        : policy_(policy), weights_(std::move(weights)) {
+        if (lane_count == 0) lane_count = 1;                   // emniyet
+        if (lane_count > kMaxLanes) lane_count = kMaxLanes;    // mask sınırı
+        lanes_.reserve(lane_count);
+        for (std::size_t i = 0; i < lane_count; ++i) {
+            lanes_.push_back(std::make_unique<CircularBuffer>(capacity_per_lane, chunk_size,
+                                                            sub_buffer_options(options, i)));
+        }
+        weights_.resize(lane_count, 1);
+        for (auto& w : weights_) {
+            if (w == 0) w = 1;  // 0 ağırlık lane'i aç bırakır; en az 1
+        }
+    }
+
+    // ========================================================================
+    // Producer: Seçilen lane'de boş slot claim eder (non-blocking)
+    // ========================================================================
+    std::optional<Ticket> claim_producer(std::size_t lane) {
+        if (lane >= lanes_.size()) return std::nullopt;
+        auto t = lanes_[lane]->claim_producer();
+        if (!t) return std::nullopt;
+        return Ticket{*t, lane};
+    }
+
+    // Producer: slot'u yayınlar ve lane'in ready bitini açar
+    bool commit_producer(const Ticket& t) {
+        if (!lanes_[t.lane]->commit_producer(t.slot)) return false;
+        // seq store'u ile mask okuması yer değiştirmemeli (bkz. BİT PROTOKOLÜ)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint64_t bit = std::uint64_t{1} << t.lane;
+        // Bit zaten açıksa paylaşılan satıra yazmıyoruz (bulk lane'de sık durum)
+        if (!(ready_mask_.load(std::memory_order_relaxed) & bit)) {
+            ready_mask_.fetch_or(bit, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // Consumer: Policy'ye göre bir lane'den slot claim eder (non-blocking)
+    // ========================================================================
+    std::optional<Ticket> claim_consumer(Cursor& cursor) {
+        if (policy_ == Policy::StrictPriority) return claim_strict();
+        return claim_weighted(cursor);
+    }
+
+    // Consumer: slot'u ait olduğu lane'e geri verir
+    void release_consumer(const Ticket& t) {
+        lanes_[t.lane]->release_consumer(t.slot);
+    }
+
+    // Tüm lane'leri kapatır
+    void stop() {
+        for (auto& l : lanes_) l->stop();
+    }
+
+    std::size_t lane_count() const { return lanes_.size(); }
+    Policy policy() const { return policy_; }
+    CircularBuffer& lane(std::size_t i) { return *lanes_[i]; }
+    std::uint64_t ready_mask() const { return ready_mask_.load(std::memory_order_relaxed); }
+
+private:
+    // Strict priority: maskedeki en düşük bit'ten başla
+    std::optional<Ticket> claim_strict() {
+        std::uint64_t mask = ready_mask_.load(std::memory_order_acquire);
+        while (mask) {
+            const auto lane = static_cast<std::size_t>(std::countr_zero(mask));
+            if (auto t = try_lane(lane)) return t;
+            mask &= mask - 1;  // Bu lane boş/yarışta kaybedildi; sonrakine geç
+        }
+        return std::nullopt;
+    }
+
+    // Weighted round robin: mevcut lane'in kredisi bitene kadar ondan al
+    std::optional<Ticket> claim_weighted(Cursor& c) {
+        const std::size_t n = lanes_.size();
+        std::uint64_t mask = ready_mask_.load(std::memory_order_acquire);
+        // Her lane en fazla bir kez denenir (+1: mevcut lane'e kredi yenileme)
+        for (std::size_t attempt = 0; mask && attempt <= n; ++attempt) {
+            if (c.lane >= n) {   // Yeni cursor: ilk tur lane 0'ın tam kredisiyle başlar
+                c.lane = 0;
+                c.credit = weights_[0];
+            }
+            const std::uint64_t bit = std::uint64_t{1} << c.lane;
+            if ((mask & bit) && c.credit > 0) {
+                if (auto t = try_lane(c.lane)) {
+                    --c.credit;
+                    return t;
+                }
+                mask &= ~bit;
+            }
+            // Sıradaki hazır lane'e geç (döngüsel) ve kredisini doldur
+            const std::uint64_t after = (c.lane + 1 < 64) ? (mask & (~std::uint64_t{0} << (c.lane + 1))) : 0;
+            const std::uint64_t next = after ? after : mask;
+            if (!next) break;
+            c.lane = static_cast<std::size_t>(std::countr_zero(next));
+            c.credit = weights_[c.lane];
+        }
+        return std::nullopt;
+    }
+
+    // Lane'den claim dener; lane boşsa ready bitini protokole göre kapatır
+    std::optional<Ticket> try_lane(std::size_t lane) {
+        CircularBuffer& l = *lanes_[lane];
+        if (auto t = l.claim_consumer()) return Ticket{*t, lane};
+        if (l.size_approx() != 0) return std::nullopt;  // Yarış: başka consumer aldı
+
+        const std::uint64_t bit = std::uint64_t{1} << lane;
+        ready_mask_.fetch_and(~bit, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (l.size_approx() != 0) {
+            // Biti kapatırken producer commit etmiş olabilir: geri aç
+            ready_mask_.fetch_or(bit, std::memory_order_relaxed);
+            if (auto t = l.claim_consumer()) return Ticket{*t, lane};
+        }
+        return std::nullopt;
+    }
+
+    Policy policy_;
+    std::vector<unsigned> weights_;
+    std::vector<std::unique_ptr<CircularBuffer>> lanes_;
+
+    // Lane başına "boş olmayabilir" biti; kendi cache line'ında
+    alignas(64) std::atomic<std::uint64_t> ready_mask_{0};
+};
@@ -1,617 +1,475 @@
 // ============================================================================
-// Örnek: Lock-free MPMC (Multiple Producer Multiple Consumer) Halka Buffer
+// Yük Üreteci: CircularBuffer üzerinde ayarlanabilir producer/consumer yükü
 // ============================================================================
-// Bu implementasyon, lock-free (kilit kullanmayan) bir circular buffer sağlar.
-// 
-// TEMEL TASARIM:
-// - Slot içinde veri tutulmuyor; tek bir büyük CPU char dizisi (data_cpu_) var
-// - GPU tarafı simülasyonu için short dizisi (data_gpu_) var
-// - Sabit chunk_size ile bu diziler chunk'lara bölünür
-// - Her slot bir sequence counter tutar (seq) - bu lock-free senkronizasyon için kritik
-// - Ek metadata: rfSignal (std::pair<int,double>) ve size (std::size_t)
-// - Producer: claim -> chunk pointer al (cpu_ptr, gpu_ptr, rf, size_ptr) -> doldur -> commit
-// - Consumer: claim -> pointer'ları al -> oku -> release
+// Deployment boyutlandırmak için: thread sayıları, kapasite, chunk boyutu,
+// süre veya item sayısı, payload boyut dağılımı, bekleme stratejisi ve
+// pinning komut satırından verilir; sonunda throughput, drop ve latency
+// yüzdelikleri yazdırılır. Algoritmanın açıklaması header'dadır.
 //
-// LOCK-FREE ALGORİTMA:
-// Sequence counter pattern kullanılıyor. Her slot'un bir "beklenen sıra numarası" var:
-// - Boş slot: seq == pos (slot'un global pozisyonu)
-// - Dolu slot: seq == pos + 1 (producer doldurdu, consumer bekliyor)
-// - Yeniden boş: seq == pos + capacity (consumer okudu, producer tekrar kullanabilir)
+// Latency: producer commit'ten hemen önce chunk'ın ilk 8 baytına
+// steady_clock zamanını yazar, consumer claim'den hemen sonra okur
+// (commit -> claim, kuyrukta bekleme dahil).
 //
-// Bu sayede mutex/condition_variable olmadan thread-safe çalışma sağlanır.
+// İz: -DMPMC_TRACE ile derlenmişse --trace FILE thread başına claim/commit/
+// release olaylarını ikili dump olarak yazar; trace_export ile Perfetto
+// JSON'una çevrilir.
 //
 // Build: g++ -std=c++20 -O2 -pthread main.cpp -o app
-// Run:   ./app
+// Run:   ./app --help
 // ============================================================================
 
+#include "circular_buffer.hpp"
+#include "topology.hpp"
+#include "trace.hpp"
+
 #include <atomic>
-#include <cstddef>
-#include <cstdio>
 #include <chrono>
-#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <memory>
 #include <mutex>
-#include <optional>
 #include <random>
-#include <sstream>
+#include <string>
 #include <thread>
-#include <utility>
 #include <vector>
 #include <algorithm>
 
 // ============================================================================
-// Lock-free Bounded MPMC Ring Buffer
+// Thread-safe logging helper
 // ============================================================================
-// Bu sınıf, sequence counter pattern kullanarak lock-free çalışan bir circular
-// buffer implementasyonu sağlar. Veri tek bir büyük char dizisinde tutulur ve
-// sabit chunk_size ile bölünür. Her chunk bir slot'a karşılık gelir.
-//
-// ÖNEMLİ: Bu implementasyon wait-free değil, lock-free'dur. Yani bazı thread'ler
-// diğerlerini bekleyebilir ama hiçbir thread mutex/condition_variable ile bloke
-// olmaz - sadece spin/yield yapar.
+// Çok thread'li ortamda cout'ların birbirine karışmaması için mutex ile korunur
 // ============================================================================
-class CircularBuffer {
-public:
-    // Producer/Consumer'ın claim ettiği slot bilgisini taşır
-    struct Ticket {
-        std::size_t pos;               // Slot'un global pozisyon numarası (ring buffer'da döngüsel)
-        char* cpu_ptr;                 // CPU tarafı (char) chunk başlangıcı
-        short* gpu_ptr;                // GPU tarafı (simüle) short chunk başlangıcı
-        std::pair<int, double>* rf;    // Ek metadata: rfSignal
-        std::size_t* size_ptr;         // Ek metadata: yazılan byte sayısı
-    };
+namespace {
+    std::mutex log_mutex;  // Global log mutex (sadece bu dosya içinde görünür)
+
+    // Thread-safe log fonksiyonu: tüm çıktıyı atomik olarak yazar
+    template<typename... Args>
+    void safe_log(Args&&... args) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        (std::cout << ... << std::forward<Args>(args));
+        std::cout << std::endl;  // Her log satırı sonunda newline
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+    }
 
     // ========================================================================
-    // RAII Wrapper: Producer Ticket - Exception safety için
+    // Payload boyut dağılımı: fixed:N | uniform:MIN:MAX | exp:MEAN
     // ========================================================================
-    // Bu class, claim_producer() sonrası otomatik commit_producer() çağırır.
-    // Producer fail olsa bile (exception, early return) slot kaybolmaz.
+    // Boyut her zaman [8, chunk_size] aralığına kırpılır (ilk 8 bayt zaman).
     // ========================================================================
-    class ProducerTicket {
-    public:
-        ProducerTicket(CircularBuffer* buffer, Ticket ticket)
-            : buffer_(buffer), ticket_(ticket), committed_(false) {}
-        
-        ~ProducerTicket() {
-            if (!committed_ && buffer_) {
-                // Exception veya early return durumunda otomatik commit
-                buffer_->commit_producer(ticket_);
+    struct PayloadDist {
+        enum class Kind { Fixed, Uniform, Exp } kind = Kind::Fixed;
+        std::size_t a = 0;   // fixed: boyut, uniform: min, exp: ortalama
+        std::size_t b = 0;   // uniform: max
+        std::string text;
+
+        bool parse(const std::string& s) {
+            text = s;
+            unsigned long x = 0, y = 0;
+            if (std::sscanf(s.c_str(), "fixed:%lu", &x) == 1) {
+                kind = Kind::Fixed;
+            } else if (std::sscanf(s.c_str(), "uniform:%lu:%lu", &x, &y) == 2 && x <= y) {
+                kind = Kind::Uniform;
+            } else if (std::sscanf(s.c_str(), "exp:%lu", &x) == 1 && x > 0) {
+                kind = Kind::Exp;
+            } else {
+                return false;
             }
+            a = x;
+            b = y;
+            return true;
         }
-        
-        // Copy/move delete - sadece bir instance olmalı
-        ProducerTicket(const ProducerTicket&) = delete;
-        ProducerTicket& operator=(const ProducerTicket&) = delete;
-        ProducerTicket(ProducerTicket&&) = delete;
-        ProducerTicket& operator=(ProducerTicket&&) = delete;
-        
-        // Manuel commit (normal kullanım)
-        void commit() {
-            if (!committed_ && buffer_) {
-                buffer_->commit_producer(ticket_);
-                committed_ = true;
+
+        std::size_t sample(std::mt19937_64& rng, std::size_t chunk_size) const {
+            std::size_t n = a;
+            if (kind == Kind::Uniform) {
+                n = std::uniform_int_distribution<std::size_t>(a, b)(rng);
+            } else if (kind == Kind::Exp) {
+                n = static_cast<std::size_t>(std::exponential_distribution<double>(1.0 / a)(rng));
             }
+            return std::clamp<std::size_t>(n, sizeof(std::uint64_t), chunk_size);
         }
-        
-        // Ticket'a erişim
-        Ticket& get() { return ticket_; }
-        const Ticket& get() const { return ticket_; }
-        Ticket* operator->() { return &ticket_; }
-        const Ticket* operator->() const { return &ticket_; }
-        
-    private:
-        CircularBuffer* buffer_;
-        Ticket ticket_;
-        bool committed_;
     };
 
     // ========================================================================
-    // RAII Wrapper: Consumer Ticket - Exception safety için
+    // LatencyHistogram: log-lineer histogram (HDR benzeri, ~%3 çözünürlük)
     // ========================================================================
-    // Bu class, claim_consumer() sonrası otomatik release_consumer() çağırır.
-    // Consumer fail olsa bile slot kaybolmaz.
+    // 0..63 ns birebir; üstünde her 2'nin kuvveti aralığı 32 alt kovaya
+    // bölünür. Consumer başına bir tane; sonda birleştirilir (lock yok).
     // ========================================================================
-    class ConsumerTicket {
+    class LatencyHistogram {
     public:
-        ConsumerTicket(CircularBuffer* buffer, Ticket ticket)
-            : buffer_(buffer), ticket_(ticket), released_(false) {}
-        
-        ~ConsumerTicket() {
-            if (!released_ && buffer_) {
-                // Exception veya early return durumunda otomatik release
-                buffer_->release_consumer(ticket_);
-            }
-        }
-        
-        // Copy/move delete
-        ConsumerTicket(const ConsumerTicket&) = delete;
-        ConsumerTicket& operator=(const ConsumerTicket&) = delete;
-        ConsumerTicket(ConsumerTicket&&) = delete;
-        ConsumerTicket& operator=(ConsumerTicket&&) = delete;
-        
-        // Manuel release (normal kullanım)
-        void release() {
-            if (!released_ && buffer_) {
-                buffer_->release_consumer(ticket_);
-                released_ = true;
-            }
-        }
-        
-        // Ticket'a erişim
-        Ticket& get() { return ticket_; }
-        const Ticket& get() const { return ticket_; }
-        Ticket* operator->() { return &ticket_; }
-        const Ticket* operator->() const { return &ticket_; }
-        
-    private:
-        CircularBuffer* buffer_;
-        Ticket ticket_;
-        bool released_;
-    };
+        static constexpr int kSubBits = 5;
+        static constexpr std::size_t kLinear = 64;
+        static constexpr std::size_t kBuckets = kLinear + (64 - 6) * (1u << kSubBits);
 
-    // Constructor: buffer'ı belirtilen kapasite ve chunk boyutu ile başlatır
-    CircularBuffer(std::size_t capacity_chunks, std::size_t chunk_size)
-        : chunk_size_(chunk_size) {
-        // Kapasiteyi 2'nin kuvveti yap (ör: 7 -> 8, 9 -> 16)
-        // Bu sayede mod işlemi (pos % capacity) yerine bitwise AND (pos & mask) kullanabiliriz
-        // Bitwise AND çok daha hızlıdır ve performans kritik bir noktadır
-        capacity_ = 1;
-        while (capacity_ < capacity_chunks) capacity_ <<= 1;  // power of two
-        
-        // Mask: capacity 8 ise mask = 7 (binary: 0111)
-        // pos & mask işlemi pos % capacity ile aynı sonucu verir ama çok daha hızlı
-        mask_ = capacity_ - 1;
-        
-        // Slot dizisini oluştur (her slot bir sequence counter tutar)
-        // unique_ptr kullanıyoruz çünkü Slot içinde atomic var ve kopyalanamaz
-        slots_ = std::make_unique<Slot[]>(capacity_);
-        
-        // Her slot'u başlangıç durumuna getir: seq = pos (boş durum)
-        // memory_order_relaxed yeterli çünkü henüz thread'ler başlamadı
-        for (std::size_t i = 0; i < capacity_; ++i) {
-            slots_[i].seq.store(i, std::memory_order_relaxed);
-        }
-        
-        // Büyük char dizisini oluştur: capacity * chunk_size byte
-        // Her slot için chunk_size byte ayrılır
-        data_cpu_.resize(capacity_ * chunk_size_);
-
-        // "GPU" (simülasyon) için short dizisi: chunk_size / sizeof(short) kadar eleman
-        shorts_per_chunk_ = chunk_size_ / sizeof(short);
-        if (shorts_per_chunk_ == 0) shorts_per_chunk_ = 1;  // emniyet
-        data_gpu_.resize(capacity_ * shorts_per_chunk_);
-
-        // Metadata dizileri: rfSignal ve size
-        meta_rf_signal_.resize(capacity_);
-        meta_size_.resize(capacity_, 0);
-    }
+        LatencyHistogram() : counts_(kBuckets, 0) {}
 
-    // ========================================================================
-    // Producer: Boş bir slot'u claim eder (non-blocking)
-    // ========================================================================
-    // Veri yoksa (kuyruk doluysa) veya shutdown ise hemen std::nullopt döner.
-    // Başarıyla claim ederse Ticket döner; devamında commit_producer() çağrılmalı.
-    // ========================================================================
-    std::optional<Ticket> claim_producer() {
-        // Shutdown kontrolü
-        if (shutdown_.load(std::memory_order_acquire)) {
-            return std::nullopt;
+        void record(std::uint64_t v) {
+            ++counts_[index(v)];
+            ++total_;
+            if (v > max_) max_ = v;
         }
 
-        // tail_: son yazılan pozisyon (atomik) - sadece okuyoruz, artırmıyoruz
-        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        void merge(const LatencyHistogram& o) {
+            for (std::size_t i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+            total_ += o.total_;
+            max_ = std::max(max_, o.max_);
+        }
 
-        // Ring buffer index
-        Slot& slot = slots_[pos & mask_];
+        // p in [0, 100]; kovanın alt sınırı döner
+        std::uint64_t percentile(double p) const {
+            if (total_ == 0) return 0;
+            const auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total_ - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                seen += counts_[i];
+                if (seen >= rank) return lower_bound(i);
+            }
+            return max_;
+        }
 
-        // Slot'un sequence değerini oku
-        std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        std::uint64_t count() const { return total_; }
+        std::uint64_t max() const { return max_; }
 
-        // diff = seq - pos
-        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    private:
+        static std::size_t index(std::uint64_t v) {
+            if (v < kLinear) return static_cast<std::size_t>(v);
+            const int e = 63 - __builtin_clzll(v);   // >= 6
+            const std::size_t sub = (v >> (e - kSubBits)) & ((1u << kSubBits) - 1);
+            return kLinear + static_cast<std::size_t>(e - 6) * (1u << kSubBits) + sub;
+        }
 
-        if (diff == 0) {  // Slot boş, claim edilebilir
-            // tail_ artırmıyoruz, sadece slot'u döndürüyoruz
-            // tail_ commit_producer() içinde artırılacak
-            char* cpu_p = data_cpu_.data() + (pos & mask_) * chunk_size_;
-            short* gpu_p = data_gpu_.data() + (pos & mask_) * shorts_per_chunk_;
-            auto* rf = &meta_rf_signal_[pos & mask_];
-            auto* sz = &meta_size_[pos & mask_];
-            return Ticket{pos, cpu_p, gpu_p, rf, sz};
+        static std::uint64_t lower_bound(std::size_t i) {
+            if (i < kLinear) return i;
+            const std::size_t e = (i - kLinear) / (1u << kSubBits) + 6;
+            const std::size_t sub = (i - kLinear) % (1u << kSubBits);
+            return (std::uint64_t{1} << e) | (static_cast<std::uint64_t>(sub) << (e - kSubBits));
         }
 
-        // Slot dolu (diff < 0) veya beklenmeyen durum (diff > 0) → veri yokmuş gibi çık
-        return std::nullopt;
-    }
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t total_ = 0;
+        std::uint64_t max_ = 0;
+    };
 
     // ========================================================================
-    // Producer: Chunk'ı doldurduktan sonra slot'u consumer'lara açık hale getirir
-    // ========================================================================
-    // Bu fonksiyon claim_producer()'dan sonra MUTLAKA çağrılmalı!
-    //
-    // tail_ burada artırılır (claim_producer()'da değil).
-    // Sequence'i pos+1 yaparak slot'u "dolu" olarak işaretleriz.
-    // Consumer'lar seq == pos+1 olduğunu görünce bu slot'u okuyabilir.
-    //
-    // memory_order_release: Bu yazıdan önceki tüm yazılar (chunk içine yazılan
-    // veriler) consumer'lar tarafından görülebilir hale gelir.
-    // ========================================================================
-    void commit_producer(const Ticket& t) {
-        // tail_ artır: CAS ile atomik olarak ilerlet
-        // Sadece t.pos == tail_ ise artır (başka biri önce commit ettiyse false döner)
-        std::size_t expected = t.pos;
-        if (!tail_.compare_exchange_strong(expected, t.pos + 1,
-                                           std::memory_order_acq_rel,
-                                           std::memory_order_relaxed)) {
-            // Başka bir producer önce commit etti, bu ticket artık geçersiz
-            // Bu durumda slot'u commit etmiyoruz (tail_ zaten ilerledi)
-            return;
-        }
-        
-        // Sequence'i pos+1 yap = "Bu slot dolu, consumer okuyabilir" sinyali
-        slots_[t.pos & mask_].seq.store(t.pos + 1, std::memory_order_release);
+    // Komut satırı
+    // ========================================================================
+    struct Config {
+        int producers = 3;
+        int consumers = 2;
+        std::size_t capacity = 1024;
+        std::size_t chunk_size = 4096;
+        double duration = 5.0;            // saniye (items == 0 ise)
+        std::uint64_t items = 0;          // producer başına; 0 = süre ile
+        double rate = 0;                  // producer başına item/s; 0 = sınırsız
+        PayloadDist payload;
+        WaitStrategy wait = WaitStrategy::PauseSpin;
+        bool drop = false;                // true: ring doluysa item atılır
+        std::vector<int> pin_cpus;        // boşsa pinning yok
+        Placement placement = Placement::None;
+        bool log = false;
+        std::string trace_path;           // boş değilse iz dump'ı (MPMC_TRACE)
+    };
+
+    void usage(const char* prog) {
+        std::fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -p, --producers N      producer thread sayısı (3)\n"
+            "  -c, --consumers N      consumer thread sayısı (2)\n"
+            "  -n, --capacity N       ring kapasitesi, 2^n'e yuvarlanır (1024)\n"
+            "  -s, --chunk N          chunk boyutu, bayt, >= 8 (4096)\n"
+            "  -d, --duration SEC     süre (5); --items verilirse yok sayılır\n"
+            "  -i, --items N          producer başına item sayısı\n"
+            "  -r, --rate N           producer başına hedef item/s (0 = sınırsız)\n"
+            "      --payload DIST     fixed:N | uniform:MIN:MAX | exp:MEAN (fixed:chunk)\n"
+            "  -w, --wait STRATEGY    busy-spin | pause-spin | yield | sleep | park\n"
+            "      --drop             ring doluysa bekleme, item'ı at (drop say)\n"
+            "      --pin CPUS         thread'leri sırayla pinle: \"0-3,6\" (producer'lar önce)\n"
+            "      --placement P      topolojiden pinle: same-core | same-l3 | cross-socket\n"
+            "      --topology         algılanan topolojiyi yazdır ve çık\n"
+            "      --log              item başına log (yavaş; sadece hata ayıklama)\n"
+            "      --trace FILE       iz dump'ı yaz (MPMC_TRACE ile derlenmiş olmalı)\n"
+            "  -h, --help\n", prog);
     }
 
-    // ========================================================================
-    // Producer: RAII wrapper ile claim (ÖNERİLEN - Exception safe)
-    // ========================================================================
-    // Bu fonksiyon ProducerTicket döndürür; destructor'da otomatik commit yapar.
-    // Producer fail olsa bile (exception, early return) slot kaybolmaz.
-    //
-    // KULLANIM:
-    //   if (auto ticket = buffer.claim_producer_raii()) {
-    //       // ticket->cpu_ptr, ticket->gpu_ptr, vs. kullan
-    //       ticket->commit();  // Manuel commit (isteğe bağlı, destructor zaten yapar)
-    //   }
-    // ========================================================================
-    std::optional<ProducerTicket> claim_producer_raii() {
-        auto opt = claim_producer();
-        if (!opt) return std::nullopt;
-        return ProducerTicket(this, *opt);
+    bool parse_wait(const std::string& s, WaitStrategy& w) {
+        for (auto c : {WaitStrategy::BusySpin, WaitStrategy::PauseSpin, WaitStrategy::Yield,
+                       WaitStrategy::Sleep, WaitStrategy::Park}) {
+            if (s == wait_strategy_name(c)) {
+                w = c;
+                return true;
+            }
+        }
+        return false;
     }
 
-    // ========================================================================
-    // Consumer: Dolu bir slot'u claim eder ve chunk pointer'ı döner (non-blocking)
-    // ========================================================================
-    // Veri yoksa hemen std::nullopt döner; spin/backoff yapmaz.
-    // ÖNEMLİ: Bu fonksiyon döndükten sonra mutlaka release_consumer() çağrılmalı!
-    // ========================================================================
-    std::optional<Ticket> claim_consumer() {
-        // head_: son okunan pozisyon (atomik, birden fazla consumer paylaşır)
-        std::size_t pos = head_.load(std::memory_order_relaxed);
-        
-        // Ring buffer'da döngüsel indeks
-        Slot& slot = slots_[pos & mask_];
-        
-        // Slot'un sequence değerini oku
-        std::size_t seq = slot.seq.load(std::memory_order_acquire);
-        
-        // diff = seq - (pos + 1)
-        intptr_t diff =
-            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
-        
-        if (diff == 0) {  // Slot dolu! Claim etmeyi dene
-            if (head_.compare_exchange_weak(pos, pos + 1,
-                                            std::memory_order_acq_rel,
-                                            std::memory_order_relaxed)) {
-                // Başarılı! Bu slot'u claim ettik
-                char* cpu_p = data_cpu_.data() + (pos & mask_) * chunk_size_;
-                short* gpu_p = data_gpu_.data() + (pos & mask_) * shorts_per_chunk_;
-                auto* rf = &meta_rf_signal_[pos & mask_];
-                auto* sz = &meta_size_[pos & mask_];
-                return Ticket{pos, cpu_p, gpu_p, rf, sz};  // Consumer bu pointer'lardan okuyabilir
+    // Dönüş: 0 devam, 1 --help, 2 hata, 3 --topology
+    int parse_args(int argc, char** argv, Config& cfg) {
+        bool payload_set = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto is = [&](const char* s, const char* l) { return arg == l || (s && arg == s); };
+            auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+            const char* v = nullptr;
+            if (is("-h", "--help")) return 1;
+            if (is(nullptr, "--topology")) return 3;
+            if (is(nullptr, "--drop")) { cfg.drop = true; continue; }
+            if (is(nullptr, "--log")) { cfg.log = true; continue; }
+            if (!(v = value())) {
+                std::fprintf(stderr, "missing value or unknown option %s\n", arg.c_str());
+                return 2;
+            }
+            bool ok = true;
+            if (is("-p", "--producers")) ok = (cfg.producers = std::atoi(v)) > 0;
+            else if (is("-c", "--consumers")) ok = (cfg.consumers = std::atoi(v)) > 0;
+            else if (is("-n", "--capacity")) ok = (cfg.capacity = std::strtoull(v, nullptr, 10)) > 0;
+            else if (is("-s", "--chunk")) ok = (cfg.chunk_size = std::strtoull(v, nullptr, 10)) >= sizeof(std::uint64_t);
+            else if (is("-d", "--duration")) ok = (cfg.duration = std::atof(v)) > 0;
+            else if (is("-i", "--items")) ok = (cfg.items = std::strtoull(v, nullptr, 10)) > 0;
+            else if (is("-r", "--rate")) ok = (cfg.rate = std::atof(v)) >= 0;
+            else if (is(nullptr, "--payload")) ok = payload_set = cfg.payload.parse(v);
+            else if (is("-w", "--wait")) ok = parse_wait(v, cfg.wait);
+            else if (is(nullptr, "--pin")) ok = parse_cpu_list(v, cfg.pin_cpus);
+            else if (is(nullptr, "--trace")) {
+                cfg.trace_path = v;
+                if (!mpmc_trace::kEnabled) {
+                    std::fprintf(stderr, "--trace: built without MPMC_TRACE (cmake -DMPMC_TRACE=ON)\n");
+                    return 2;
+                }
+            }
+            else if (is(nullptr, "--placement")) {
+                const auto p = parse_placement(v);
+                ok = p.has_value();
+                if (ok) cfg.placement = *p;
+            }
+            else {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                return 2;
+            }
+            if (!ok) {
+                std::fprintf(stderr, "invalid value for %s: %s\n", arg.c_str(), v);
+                return 2;
             }
-            // CAS başarısızsa başka consumer aldı; veri yokmuş gibi nullopt dön
-            return std::nullopt;
         }
-        
-        // Slot boş (diff < 0) ya da beklenmeyen durum (diff > 0) → veri yokmuş gibi çık
-        return std::nullopt;
+        if (!payload_set) cfg.payload.parse("fixed:" + std::to_string(cfg.chunk_size));
+        return 0;
     }
 
-    // ========================================================================
-    // Consumer: Chunk'ı okuduktan sonra slot'u producer'lara geri verir
-    // ========================================================================
-    // Bu fonksiyon claim_consumer()'dan sonra MUTLAKA çağrılmalı!
-    //
-    // Sequence'i pos + capacity_ yaparak slot'u "boş" olarak işaretleriz.
-    // Producer'lar seq == pos olduğunu görünce bu slot'a yazabilir.
-    //
-    // Neden pos + capacity_?
-    // - Ring buffer döngüsel çalışır, pos değerleri sürekli artar
-    // - pos + capacity_ yaparak, bir sonraki döngüde aynı slot'a geldiğimizde
-    //   seq değerini doğru hesaplayabiliriz
-    // - Örnek: capacity=8, pos=5 -> seq=13. Bir sonraki döngüde pos=13 geldiğinde
-    //   seq kontrolü: 13 - 13 = 0 (boş) olur
-    //
-    // memory_order_release: Bu yazıdan önceki tüm okumalar (chunk'tan okunan
-    // veriler) tamamlanmış olur.
-    // ========================================================================
-    void release_consumer(const Ticket& t) {
-        // Sequence'i pos + capacity_ yap = "Bu slot boş, producer yazabilir" sinyali
-        slots_[t.pos & mask_].seq.store(t.pos + capacity_,
-                                        std::memory_order_release);
+    // Çağıran thread'i cpu'ya pinler; başarısızsa uyarır (yük yine çalışır)
+    void pin_self(int cpu) {
+        if (!pin_current_thread(cpu)) safe_log("warning: cannot pin thread to cpu ", cpu);
     }
+}
 
-    // ========================================================================
-    // Consumer: RAII wrapper ile claim (ÖNERİLEN - Exception safe)
-    // ========================================================================
-    // Bu fonksiyon ConsumerTicket döndürür; destructor'da otomatik release yapar.
-    // Consumer fail olsa bile slot kaybolmaz.
-    //
-    // KULLANIM:
-    //   if (auto ticket = buffer.claim_consumer_raii()) {
-    //       // ticket->cpu_ptr, ticket->gpu_ptr, vs. kullan
-    //       ticket->release();  // Manuel release (isteğe bağlı, destructor zaten yapar)
-    //   }
-    // ========================================================================
-    std::optional<ConsumerTicket> claim_consumer_raii() {
-        auto opt = claim_consumer();
-        if (!opt) return std::nullopt;
-        return ConsumerTicket(this, *opt);
+// ============================================================================
+// Main: Yük üreteci
+// ============================================================================
+int main(int argc, char** argv) {
+    Config cfg;
+    if (int rc = parse_args(argc, argv, cfg)) {
+        if (rc == 3) {
+            const CpuTopology topo;
+            std::printf("%s\n", topo.describe().c_str());
+            for (const auto& c : topo.cpus()) {
+                std::printf("  cpu %3d  core %3d  socket %d  node %d  L3 %d\n", c.id, c.core, c.package, c.node, c.l3);
+            }
+            return 0;
+        }
+        usage(argv[0]);
+        return rc == 1 ? 0 : 2;
+    }
+    if (cfg.placement != Placement::None) {
+        const auto cpus = CpuTopology().placement(cfg.placement, cfg.producers, cfg.consumers);
+        if (!cpus) {
+            std::fprintf(stderr, "placement %s not available on this machine\n", placement_name(cfg.placement));
+            return 2;
+        }
+        cfg.pin_cpus = *cpus;
     }
 
-    // ========================================================================
-    // Stop: Buffer'ı kapatır, producer/consumer'lara çıkış sinyali gönderir
-    // ========================================================================
-    // Bu fonksiyon çağrıldığında:
-    // - Producer'lar claim_producer()'da nullptr döner ve çıkar
-    // - Consumer'lar claim_consumer()'da nullopt döner ve çıkar
-    //
-    // memory_order_release: Bu yazıdan önceki tüm işlemler tamamlanır
-    // ========================================================================
-    void stop() { shutdown_.store(true, std::memory_order_release); }
+    BufferOptions options;
+    options.producer_wait = cfg.wait;
+    options.consumer_wait = cfg.wait;
+    CircularBuffer buffer(cfg.capacity, cfg.chunk_size, options);
+    const std::size_t chunk_size = buffer.chunk_size();
+
+    // İstatistikler: thread başına biriktirilir, sonda toplanır
+    struct ProducerStats {
+        std::uint64_t produced = 0;
+        std::uint64_t dropped = 0;
+        std::uint64_t bytes = 0;
+    };
+    struct ConsumerStats {
+        std::uint64_t consumed = 0;
+        std::uint64_t bytes = 0;
+        LatencyHistogram latency;
+    };
+    std::vector<ProducerStats> pstats(cfg.producers);
+    std::vector<ConsumerStats> cstats(cfg.consumers);
 
-private:
-    // ========================================================================
-    // Slot: Her slot bir sequence counter tutar
-    // ========================================================================
-    // Sequence counter, lock-free senkronizasyonun kalbidir:
-    // - seq == pos: Slot boş, producer yazabilir
-    // - seq == pos + 1: Slot dolu, consumer okuyabilir
-    // - seq == pos + capacity_: Slot boş (consumer okudu), producer tekrar yazabilir
-    //
-    // Copy/move constructor'lar delete edildi çünkü atomic kopyalanamaz.
-    // Bu yüzden vector yerine unique_ptr kullanıyoruz.
-    // ========================================================================
-    struct Slot {
-        std::atomic<std::size_t> seq{};  // Slot'un beklenen sıra numarası (sequence)
-        Slot() = default;
-        Slot(const Slot&) = delete;      // Atomic kopyalanamaz
-        Slot& operator=(const Slot&) = delete;
-        Slot(Slot&&) = delete;
-        Slot& operator=(Slot&&) = delete;
+    std::atomic<bool> go{false};
+    const auto cpu_for = [&](int thread_index) {
+        return cfg.pin_cpus.empty() ? -1
+                                    : cfg.pin_cpus[static_cast<std::size_t>(thread_index) % cfg.pin_cpus.size()];
     };
 
     // ========================================================================
-    // Backoff: Contention (çakışma) durumunda bekleme stratejisi
+    // Producer: claim -> payload + zaman damgası -> commit
     // ========================================================================
-    // Lock-free algoritmalarda, eğer bir thread CAS başarısız olursa veya
-    // beklediği durum henüz oluşmamışsa, sürekli döngüye girip CPU'yu
-    // boşa harcamak yerine akıllıca beklemelidir.
-    //
-    // STRATEJİ:
-    // 1. İlk 16 denemede: Exponential backoff (1, 2, 4, 8, ... spin)
-    //    - Kısa süreli çakışmalarda hızlı tepki verir
-    //    - atomic_signal_fence: Compiler'ın optimizasyonunu engeller, CPU pipeline'ı temizler
-    // 2. 16 denemeden sonra: Thread yield (OS'a CPU'yu başka thread'e ver)
-    //    - Uzun süreli beklemelerde CPU kaynaklarını boşa harcamaz
-    //
-    // Bu sayede hem düşük latency (kısa bekleme) hem de yüksek throughput
-    // (uzun bekleme) sağlanır.
+    // Süre modunda deadline'a, item modunda N denemeye kadar çalışır.
+    // --drop: ring doluysa item atılır (drop); aksi halde claim_producer_wait.
+    // --rate: sabit aralıklı zamanlama (gecikirse yetişmeye çalışır).
     // ========================================================================
-    struct Backoff {
-        void operator()() {
-            if (count_ < 16) {
-                // Exponential backoff: 1, 2, 4, 8, 16, ... spin
-                for (int i = 0; i < (1 << count_); ++i) {
-                    // Memory fence: Compiler optimizasyonlarını engeller
-                    // CPU pipeline'ını temizler, cache coherence sağlar
-                    std::atomic_signal_fence(std::memory_order_seq_cst);
+    auto producer = [&](int id, Clock::time_point deadline) {
+        if (int cpu = cpu_for(id); cpu >= 0) pin_self(cpu);
+        if constexpr (mpmc_trace::kEnabled) mpmc_trace::name_thread("producer-" + std::to_string(id));
+        std::mt19937_64 rng(0x9E3779B97F4A7C15ull * static_cast<std::uint64_t>(id + 1));
+        ProducerStats& st = pstats[id];
+        const auto period = cfg.rate > 0 ? std::chrono::nanoseconds(static_cast<long long>(1e9 / cfg.rate))
+                                         : std::chrono::nanoseconds(0);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        auto next = Clock::now();
+
+        for (std::uint64_t i = 0; cfg.items ? i < cfg.items : Clock::now() < deadline; ++i) {
+            if (period.count()) {
+                next += period;
+                if (next > Clock::now()) std::this_thread::sleep_until(next);
+            }
+            const std::size_t n = cfg.payload.sample(rng, chunk_size);
+
+            // 1. ADIM: Boş bir chunk claim et. Drop modunda sadece ring doluysa
+            // düşürülür; tail_ slot'u başka producer'da yazılıyorsa tekrar denenir.
+            std::optional<CircularBuffer::Ticket> ticket;
+            if (cfg.drop) {
+                while (!(ticket = buffer.claim_producer()) && !buffer.stopped() &&
+                       buffer.size_approx() < buffer.capacity()) {
+                    std::this_thread::yield();
                 }
-                ++count_;
             } else {
-                // Uzun süre beklediysek, OS'a CPU'yu başka thread'e ver
-                // Bu sayede CPU kaynaklarını boşa harcamayız
-                std::this_thread::yield();
+                ticket = buffer.claim_producer_wait();
             }
-        }
-        int count_{0};  // Kaç kez backoff yaptık
-    };
-
-    // ========================================================================
-    // Member Variables
-    // ========================================================================
-    std::size_t capacity_{0};      // Ring buffer kapasitesi (2'nin kuvveti)
-    std::size_t mask_{0};          // Bitwise AND için mask (capacity - 1)
-    std::size_t chunk_size_{0};    // Her chunk'ın byte cinsinden boyutu
-    std::size_t shorts_per_chunk_{0};  // GPU short kapasitesi (chunk_size / sizeof(short))
-    
-    // Slot dizisi: Her slot bir sequence counter tutar
-    // unique_ptr kullanıyoruz çünkü Slot içinde atomic var ve kopyalanamaz
-    std::unique_ptr<Slot[]> slots_;
-    
-    // CPU tarafı: tüm chunk'lar char dizisinde tutulur
-    std::vector<char> data_cpu_;
-    // GPU tarafı (simülasyon): short dizisi
-    std::vector<short> data_gpu_;
-    // Ek metadata
-    std::vector<std::pair<int, double>> meta_rf_signal_;
-    std::vector<std::size_t> meta_size_;
-    
-    // head_: Consumer'ların okuduğu son pozisyon (atomik)
-    // tail_: Producer'ların yazdığı son pozisyon (atomik)
-    // alignas(64): False sharing'i önlemek için cache line (64 byte) hizalama
-    // Birden fazla thread aynı cache line'ı paylaşırsa performans düşer
-    alignas(64) std::atomic<std::size_t> head_{0};
-    alignas(64) std::atomic<std::size_t> tail_{0};
-    
-    // Shutdown flag: Buffer'ın kapatıldığını gösterir
-    // Producer/Consumer'lar bu flag'i kontrol ederek çıkış yapar
-    alignas(64) std::atomic<bool> shutdown_{false};
-};
-
-// ============================================================================
-// Thread-safe logging helper
-// ============================================================================
-// Çok thread'li ortamda cout'ların birbirine karışmaması için mutex ile korunur
-// ============================================================================
-namespace {
-    std::mutex log_mutex;  // Global log mutex (sadece bu dosya içinde görünür)
-    
-    // Thread-safe log fonksiyonu: tüm çıktıyı atomik olarak yazar
-    template<typename... Args>
-    void safe_log(Args&&... args) {
-        std::lock_guard<std::mutex> lock(log_mutex);
-        (std::cout << ... << std::forward<Args>(args));
-        std::cout << std::endl;  // Her log satırı sonunda newline
-    }
-}
-
-// ============================================================================
-// Main: Test programı
-// ============================================================================
-int main() {
-    // Buffer parametreleri
-    constexpr std::size_t buffer_capacity = 8;   // Ring buffer'da kaç chunk var
-    constexpr std::size_t chunk_size = 64;       // Her chunk kaç byte (örn: 64 byte)
-    constexpr int producer_count = 3;             // Kaç producer thread
-    constexpr int consumer_count = 2;             // Kaç consumer thread
-    constexpr int items_per_producer = 20;        // Her producer kaç item üretecek
-
-    // Lock-free circular buffer oluştur
-    CircularBuffer buffer(buffer_capacity, chunk_size);
-    
-    // İstatistikler için atomik sayaçlar
-    std::atomic<int> produced_total{0};  // Toplam üretilen item sayısı
-    std::atomic<int> consumed_total{0};   // Toplam tüketilen item sayısı
-
-    // ========================================================================
-    // Producer Lambda: Her producer thread bu fonksiyonu çalıştırır
-    // ========================================================================
-    auto producer = [&](int id) {
-        // Rastgele sayı üretici (test için)
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_int_distribution<int> dist(1, 1000);
-        
-        // Her producer belirtilen sayıda item üretir
-        for (int i = 0; i < items_per_producer; ++i) {
-            int value = dist(rng);  // Rastgele bir değer
-            
-            // 1. ADIM: Boş bir chunk claim et (lock-free, non-blocking)
-            auto ticket_opt = buffer.claim_producer();
-            if (!ticket_opt.has_value()) {
-                // Kuyruk doluysa bu item'ı atla veya tekrar denemek istersen continue yaz.
+            if (ticket) {
+                // 2. ADIM: Payload + metadata
+                std::memset(ticket->cpu_ptr + sizeof(std::uint64_t), static_cast<int>(i & 0xFF),
+                            n - sizeof(std::uint64_t));
+                *ticket->rf = {id, static_cast<double>(i)};
+                *ticket->size_ptr = n;
+                const std::uint64_t ts = now_ns();
+                std::memcpy(ticket->cpu_ptr, &ts, sizeof(ts));
+                // 3. ADIM: Consumer'lara aç (claim özel: commit kaybedilmez)
+                buffer.commit_producer(*ticket);
+            }
+            if (!ticket) {
+                ++st.dropped;
                 continue;
             }
-            auto& ticket = *ticket_opt;
-
-            // 2. ADIM: Claim ettiğimiz chunk'a veri yaz
-            // ticket.cpu_ptr, chunk'ın başlangıç adresidir
-            // chunk_size byte'a kadar yazabiliriz
-            int written = std::snprintf(ticket.cpu_ptr, chunk_size, "P%d-%d-%d", id, i, value);
-            if (written < 0) written = 0;
-            std::size_t bytes_written = static_cast<std::size_t>(written);
-            if (bytes_written >= chunk_size) bytes_written = chunk_size - 1;  // null dahil
-
-            // Ek metadata: rfSignal ve size
-            *ticket.rf = {id, static_cast<double>(value) / 1000.0};
-            *ticket.size_ptr = bytes_written + 1;  // null dahil
-
-            // "GPU" buffer'ına da (short) kopyala / simüle et
-            // Byte -> short kopyası: kalan byte'lar üstüne yazılır
-            std::size_t gpu_bytes = (chunk_size / sizeof(short)) * sizeof(short);
-            if (gpu_bytes == 0) gpu_bytes = sizeof(short);
-            std::memset(ticket.gpu_ptr, 0, gpu_bytes);
-            std::memcpy(ticket.gpu_ptr, ticket.cpu_ptr,
-                        std::min(*ticket.size_ptr, gpu_bytes));
-
-            // 3. ADIM: Chunk'ı doldurduk, consumer'lara açık hale getir
-            buffer.commit_producer(ticket);
-            
-            // İstatistik güncelle
-            ++produced_total;
-#ifdef LOG_DEBUG
-            // Thread-safe log: cout'ların birbirine karışmaması için
-            safe_log("P", id, " -> ", ticket.cpu_ptr);
-            // Simülasyon: Gerçek uygulamada bu gecikme olmaz
-            std::this_thread::sleep_for(std::chrono::milliseconds(20));
-#endif
+            ++st.produced;
+            st.bytes += n;
+            if (cfg.log) safe_log("P", id, " -> #", i, " size=", n);
         }
     };
 
     // ========================================================================
-    // Consumer Lambda: Her consumer thread bu fonksiyonu çalıştırır
+    // Consumer: claim -> latency kaydı -> release
+    // ========================================================================
+    // claim_consumer_wait, stop() sonrası ring boşalınca nullopt döner.
     // ========================================================================
     auto consumer = [&](int id) {
-        while (true) {
-            // 1. ADIM: Dolu bir chunk claim et (lock-free)
-            auto ticket = buffer.claim_consumer();
-            if (!ticket.has_value()) break;  // Shutdown ve buffer boş, çık
-            
-            // 2. ADIM: Claim ettiğimiz chunk'tan veri oku
-            // ticket->cpu_ptr: CPU tarafı (char)
-            // ticket->gpu_ptr: GPU tarafı (short, simülasyon)
-            // ticket->rf: rfSignal metadata
-            // ticket->size_ptr: yazılan byte sayısı
-            ++consumed_total;
-#ifdef LOG_DEBUG
-            // Thread-safe log: cout'ların birbirine karışmaması için
-            safe_log("    C", id, " <- ", ticket->cpu_ptr,
-                     " | rfSignal=(", ticket->rf->first, ", ",
-                     ticket->rf->second, ")"
-                     " | size=", *ticket->size_ptr,
-                     " | gpu[0]=", ticket->gpu_ptr[0]);
-#endif
-            
-            // 3. ADIM: Chunk'ı okuduk, producer'lara geri ver
-            // Chunk yeniden kullanılabilir hale gelir
+        if (int cpu = cpu_for(cfg.producers + id); cpu >= 0) pin_self(cpu);
+        if constexpr (mpmc_trace::kEnabled) mpmc_trace::name_thread("consumer-" + std::to_string(id));
+        ConsumerStats& st = cstats[id];
+        while (auto ticket = buffer.claim_consumer_wait()) {
+            std::uint64_t ts;
+            std::memcpy(&ts, ticket->cpu_ptr, sizeof(ts));
+            const std::uint64_t now = now_ns();
+            st.latency.record(now > ts ? now - ts : 0);
+            ++st.consumed;
+            st.bytes += *ticket->size_ptr;
+            if (cfg.log) {
+                safe_log("    C", id, " <- P", ticket->rf->first, " #",
+                         static_cast<std::uint64_t>(ticket->rf->second), " size=", *ticket->size_ptr);
+            }
             buffer.release_consumer(*ticket);
-            
-#ifdef LOG_DEBUG
-            // Simülasyon: Gerçek uygulamada bu gecikme olmaz
-            std::this_thread::sleep_for(std::chrono::milliseconds(35));
-#endif
         }
     };
 
-    // Thread container'ları
     std::vector<std::thread> producers;
     std::vector<std::thread> consumers;
+    for (int i = 0; i < cfg.consumers; ++i) consumers.emplace_back(consumer, i);
 
-    // Producer thread'lerini başlat
-    // Her producer farklı bir ID ile çalışır (0, 1, 2, ...)
-    for (int i = 0; i < producer_count; ++i) {
-        producers.emplace_back(producer, i);
-    }
-    
-    // Consumer thread'lerini başlat
-    // Her consumer farklı bir ID ile çalışır (0, 1, ...)
-    for (int i = 0; i < consumer_count; ++i) {
-        consumers.emplace_back(consumer, i);
-    }
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(cfg.duration));
+    for (int i = 0; i < cfg.producers; ++i) producers.emplace_back(producer, i, deadline);
+    go.store(true, std::memory_order_release);
 
-    // Producer'ların bitmesini bekle
-    // Tüm producer'lar item'larını ürettikten sonra devam ederiz
+    // Producer'lar bitince stop(): consumer'lar kalanları boşaltıp çıkar
     for (auto& t : producers) t.join();
-    
-    // Buffer'ı kapat: Consumer'lara "artık yeni data yok" sinyali gönder
-    // Bu sayede consumer'lar sonsuz döngüden çıkabilir
     buffer.stop();
-    
-    // Consumer'ların bitmesini bekle
-    // Tüm consumer'lar kalan item'ları işledikten sonra devam ederiz
     for (auto& t : consumers) t.join();
+    const double secs = std::chrono::duration<double>(Clock::now() - start).count();
 
-    // Sonuçları yazdır
-    // İdeal durumda: produced_total == consumed_total olmalı
-#ifdef LOG_DEBUG
-    safe_log("Produced: ", produced_total.load(),
-             " | Consumed: ", consumed_total.load());
-#endif
-    return 0;
-}
+    // ========================================================================
+    // Özet
+    // ========================================================================
+    std::uint64_t produced = 0, dropped = 0, consumed = 0, bytes = 0;
+    LatencyHistogram latency;
+    for (const auto& s : pstats) {
+        produced += s.produced;
+        dropped += s.dropped;
+    }
+    for (const auto& s : cstats) {
+        consumed += s.consumed;
+        bytes += s.bytes;
+        latency.merge(s.latency);
+    }
 
+    std::string pins = "none";
+    if (!cfg.pin_cpus.empty()) {
+        pins.clear();
+        for (int c : cfg.pin_cpus) pins += (pins.empty() ? "" : ",") + std::to_string(c);
+    }
+    std::printf("[loadgen] %dP/%dC capacity=%zu chunk=%zu payload=%s wait=%s%s pin=%s%s%s\n",
+                cfg.producers, cfg.consumers, buffer.capacity(), chunk_size, cfg.payload.text.c_str(),
+                wait_strategy_name(cfg.wait), cfg.drop ? " drop" : "", pins.c_str(),
+                cfg.placement != Placement::None ? " placement=" : "",
+                cfg.placement != Placement::None ? placement_name(cfg.placement) : "");
+    std::printf("  elapsed     %10.3f s\n", secs);
+    std::printf("  produced    %10llu\n", static_cast<unsigned long long>(produced));
+    std::printf("  consumed    %10llu  (%.3f Mitems/s, %.1f MB/s)\n", static_cast<unsigned long long>(consumed),
+                consumed / secs / 1e6, bytes / secs / 1e6);
+    std::printf("  dropped     %10llu  (%.2f%%)\n", static_cast<unsigned long long>(dropped),
+                produced + dropped ? 100.0 * dropped / (produced + dropped) : 0.0);
+    std::printf("  latency ns  p50 %llu  p90 %llu  p99 %llu  p99.9 %llu  max %llu\n",
+                static_cast<unsigned long long>(latency.percentile(50)),
+                static_cast<unsigned long long>(latency.percentile(90)),
+                static_cast<unsigned long long>(latency.percentile(99)),
+                static_cast<unsigned long long>(latency.percentile(99.9)),
+                static_cast<unsigned long long>(latency.max()));
+
+    if (!cfg.trace_path.empty()) {
+        const auto dump = mpmc_trace::Registry::instance().snapshot();
+        std::size_t records = 0;
+        for (const auto& t : dump.threads) records += t.records.size();
+        if (!mpmc_trace::write_dump(dump, cfg.trace_path)) {
+            std::fprintf(stderr, "error: cannot write trace %s\n", cfg.trace_path.c_str());
+            return 1;
+        }
+        std::printf("  trace       %10zu records -> %s\n", records, cfg.trace_path.c_str());
+    }
 
+    // İdeal durumda: produced == consumed
+    if (produced != consumed) {
+        std::fprintf(stderr, "error: produced %llu != consumed %llu\n",
+                     static_cast<unsigned long long>(produced), static_cast<unsigned long long>(consumed));
+        return 1;
+    }
+    return 0;
+}
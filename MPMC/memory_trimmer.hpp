@@ -0,0 +1,131 @@
+// ============================================================================
+// MemoryTrimmer: Doluluğa bağlı boş chunk belleği iadesi
+// ============================================================================
+// Ring tepe yüke göre boyutlanır ama günün çoğunda neredeyse boştur; bir kez
+// dokunulmuş chunk sayfaları RSS'te kalır. MemoryTrimmer doluluğu örnekler
+// ve düşük doluluk idle_period boyunca sürerse CircularBuffer::trim_idle()
+// ile boş slot'ların sayfalarını madvise eder:
+//
+//   doluluk <= low_watermark  --idle_period-->  trim_idle(keep_slots)
+//   hâlâ düşükse her idle_period'da tekrar (yavaş ilerleyen tail'in yeniden
+//   dokunduğu sayfalar)
+//   doluluk > low_watermark   -> sayaç sıfırlanır (tepe yükte trim yok)
+//
+// Kapasite değişmez (resize'dan farkı): yük geri geldiğinde ayırma veya
+// kopyalama yoktur, sadece ilk yazımda sayfa fault'u. Buffer trimmable
+// (BufferOptions::trimmable) açılmış olmalıdır; değilse poll() hiçbir şey
+// yapmaz. Depolama pin'liyken (kayıtlı buffer kullanan Recorder) trim
+// atlanır ve Stats::pinned_skips sayılır.
+//
+// Kullanım: kendi döngünüzden poll() veya start() ile arka plan thread'i
+// (her interval'de bir poll()).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+class MemoryTrimmer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        double low_watermark = 0.05;                    // Doluluk oranı eşiği (0..1)
+        std::chrono::milliseconds idle_period{1000};    // Trim'den önce düşük kalma süresi
+        std::chrono::milliseconds interval{100};        // Arka plan örnekleme aralığı
+        std::size_t keep_slots = 64;                    // tail'den sonra sıcak bırakılan boş slot
+        std::size_t step_slots = 256;                   // Kapı kapanması başına en fazla slot
+    };
+
+    struct Stats {
+        std::uint64_t polls = 0;          // Doluluk örneği
+        std::uint64_t trims = 0;          // trim_idle çağrısı
+        std::uint64_t pinned_skips = 0;   // Depolama pin'li olduğu için atlanan trim
+        std::uint64_t bytes_advised = 0;  // madvise edilen toplam bayt
+        std::chrono::nanoseconds max_pause{0};   // En uzun kapı kapanması (adım)
+    };
+
+    explicit MemoryTrimmer(CircularBuffer& buffer) : MemoryTrimmer(buffer, Config{}) {}
+    MemoryTrimmer(CircularBuffer& buffer, Config config) : buffer_(buffer), config_(config) {}
+    ~MemoryTrimmer() { stop(); }
+
+    MemoryTrimmer(const MemoryTrimmer&) = delete;
+    MemoryTrimmer& operator=(const MemoryTrimmer&) = delete;
+
+    // ========================================================================
+    // poll: Doluluğu örnekler, gerekiyorsa trim eder; trim yaptıysa true
+    // ========================================================================
+    bool poll(Clock::time_point now = Clock::now()) {
+        ++stats_.polls;
+        const double occupancy =
+            static_cast<double>(buffer_.size_approx()) / static_cast<double>(buffer_.capacity());
+        if (occupancy > config_.low_watermark) {
+            low_since_.reset();
+            last_trim_.reset();
+            return false;
+        }
+        if (!low_since_) low_since_ = now;
+        if (now - *low_since_ < config_.idle_period) return false;
+        if (last_trim_ && now - *last_trim_ < config_.idle_period) return false;
+
+        last_trim_ = now;
+        if (buffer_.storage_pinned()) {
+            ++stats_.pinned_skips;
+            return false;
+        }
+        const std::size_t bytes = buffer_.trim_idle(config_.keep_slots, config_.step_slots);
+        ++stats_.trims;
+        stats_.bytes_advised += bytes;
+        stats_.max_pause = std::max(stats_.max_pause, buffer_.last_trim_pause());
+        return true;
+    }
+
+    // Arka plan thread'i: her config.interval'de poll()
+    void start() {
+        if (thread_.joinable()) return;
+        stop_ = false;
+        thread_ = std::thread([this] {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_) {
+                cv_.wait_for(lock, config_.interval);
+                if (stop_) break;
+                poll();
+            }
+        });
+    }
+
+    void stop() {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    // start() açıkken stats_ thread'le yarışır; stop() sonrası okuyun
+    const Stats& stats() const { return stats_; }
+    const Config& config() const { return config_; }
+
+private:
+    CircularBuffer& buffer_;
+    Config config_;
+    Stats stats_;
+    std::optional<Clock::time_point> low_since_;
+    std::optional<Clock::time_point> last_trim_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_{false};
+};
@@ -0,0 +1,157 @@
+// ============================================================================
+// PerfCounters: perf_event_open ile donanım/yazılım sayaçları
+// ============================================================================
+// Ops/s tek başına bir düzen değişikliğinin daha az cache miss'ten mi yoksa
+// daha az instruction'dan mı kazandırdığını söylemez. Bu sınıf çağıran
+// process için şu sayaçları açar (pid = 0, cpu = -1):
+//
+//   cycles, instructions, L1D read miss, LLC miss, branch miss  (donanım)
+//   context switch                                              (yazılım)
+//
+// inherit = true: sayaçlar açıldıktan SONRA oluşturulan thread'leri de sayar;
+// thread'in sayımı thread bitince (join) ebeveyne eklenir. Bu yüzden
+// ölçüm: PerfCounters aç -> thread'leri oluştur -> start() -> ... -> join
+// -> stop().
+//
+// Sayaçlar tek tek açılır (grup yok): biri açılamazsa diğerleri çalışır.
+// Çoğullama (multiplexing) olursa değer enabled/running oranıyla ölçeklenir.
+//
+// GERİ DÖNÜŞ: perf_event_paranoid, seccomp/container, PMU'suz VM gibi
+// durumlarda açılamayan sayaç available() == false; Sample'da nullopt ve
+// reason() ilk hatanın açıklamasıdır. Kernel sayımı izinsizse
+// (EACCES/EPERM) exclude_kernel ile tekrar denenir.
+// ============================================================================
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class PerfCounters {
+public:
+    enum Counter { Cycles, Instructions, L1dMisses, LlcMisses, BranchMisses, ContextSwitches, kCount };
+
+    static const char* counter_name(Counter c) {
+        switch (c) {
+            case Cycles: return "cycles";
+            case Instructions: return "instructions";
+            case L1dMisses: return "l1d-misses";
+            case LlcMisses: return "llc-misses";
+            case BranchMisses: return "branch-misses";
+            case ContextSwitches: return "context-switches";
+            case kCount: break;
+        }
+        return "?";
+    }
+
+    // Sayaç değerleri (çoğullamaya göre ölçeklenmiş); nullopt = kullanılamıyor
+    struct Sample {
+        std::array<std::optional<double>, kCount> values;
+        const std::optional<double>& operator[](Counter c) const { return values[c]; }
+    };
+
+    explicit PerfCounters(bool inherit = true) {
+        for (int c = 0; c < kCount; ++c) fds_[c] = open(static_cast<Counter>(c), inherit);
+    }
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(Counter c) const { return fds_[c] >= 0; }
+    bool any() const {
+        for (int fd : fds_) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+    // İlk açılamayan sayacın nedeni ("cycles: No such file or directory")
+    const std::string& reason() const { return reason_; }
+
+    // Sıfırla ve başlat (inherit edilmiş thread sayaçları dahil)
+    void start() {
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    Sample stop() {
+        Sample s;
+        for (int c = 0; c < kCount; ++c) {
+            const int fd = fds_[c];
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            std::uint64_t v[3] = {};   // value, time_enabled, time_running
+            if (::read(fd, v, sizeof(v)) != static_cast<ssize_t>(sizeof(v))) continue;
+            double value = static_cast<double>(v[0]);
+            if (v[2] != 0 && v[2] < v[1]) value *= static_cast<double>(v[1]) / static_cast<double>(v[2]);
+            s.values[c] = value;
+        }
+        return s;
+    }
+
+private:
+    int open(Counter c, bool inherit) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (c) {
+            case Cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case Instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case L1dMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case LlcMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case BranchMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case ContextSwitches:
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+                break;
+            case kCount: return -1;
+        }
+        int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+            // perf_event_paranoid >= 2: sadece kullanıcı alanı sayılabilir
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+        if (fd < 0 && reason_.empty()) reason_ = std::string(counter_name(c)) + ": " + std::strerror(errno);
+        return fd;
+    }
+
+    std::array<int, kCount> fds_{};
+    std::string reason_;
+};
@@ -0,0 +1,448 @@
+// ============================================================================
+// Recorder: Ring'deki chunk'ları io_uring + O_DIRECT ile diske kaydeder
+// ============================================================================
+// Consumer tarafında ham chunk'ları dosyaya yazmak için klasik yol: claim ->
+// write() -> release (chunk başına 1 syscall + page cache kopyası). Recorder:
+//
+//   1. claim_consumer_batch ile ardışık dolu slot'ları tek CAS'la alır
+//   2. Ring sarmasında (wrap) batch'i bellekte bitişik parçalara böler
+//   3. Her parçayı tek bir io_uring yazma isteği olarak kuyruğa koyar;
+//      data_cpu_ bölgesi registered buffer ise IORING_OP_WRITE_FIXED
+//      (istek başına sayfa pin/unpin yok), değilse IORING_OP_WRITEV
+//   4. O_DIRECT açıksa kernel chunk'ı doğrudan ring belleğinden DMA eder
+//      (page cache kopyası yok)
+//   5. Slot'lar yazma TAMAMLANINCA (CQE) release edilir; o ana kadar
+//      producer'lar bu chunk'lara yazamaz
+//
+// Aynı anda en fazla queue_depth yazma uçuşta olur (backpressure: ring dolar,
+// producer'lar WaitStrategy'ye göre bekler).
+//
+// DOSYA FORMATI: Sadece payload; her chunk tam chunk_size bayt, claim
+// sırasıyla art arda (kayıt i -> offset i * chunk_size). Metadata yazılmaz.
+//
+// GERİ DÖNÜŞLER (otomatik):
+// - io_uring_setup başarısız (eski kernel, seccomp) -> senkron pwritev
+// - Buffer kaydı başarısız (RLIMIT_MEMLOCK)       -> IORING_OP_WRITEV
+// - O_DIRECT şartları yok / open EINVAL (tmpfs)    -> buffered I/O
+//   O_DIRECT için BufferOptions::data_alignment ve chunk_size kDirectAlignment
+//   (4096) katı olmalıdır.
+//
+// Recorder tek bir thread'den sürülür (pump/drain); buffer'da başka
+// consumer'lar da olabilir (claim_consumer_batch MPMC güvenlidir).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// ============================================================================
+// IoUring: Minimum io_uring sarmalayıcı (liburing bağımlılığı olmadan)
+// ============================================================================
+// Sadece Recorder'ın ihtiyacı: SQE al, submit et, CQE topla, buffer kaydet.
+// IORING_FEAT_SINGLE_MMAP (5.4+) varsa SQ/CQ halkaları tek mmap'tedir.
+// ============================================================================
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring() { close(); }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // entries: SQ boyutu (kernel 2'nin kuvvetine yuvarlar). Hata: false, errno.
+    bool init(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) return false;
+
+        sq_ring_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        single_mmap_ = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap_ && cq_ring_bytes_ > sq_ring_bytes_) sq_ring_bytes_ = cq_ring_bytes_;
+
+        sq_ring_ = ::mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) return fail();
+        if (single_mmap_) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = ::mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) return fail();
+        }
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE,
+                                                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) return fail();
+
+        char* sq = static_cast<char*>(sq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+        char* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes_ && sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_bytes_);
+        if (cq_ring_ && cq_ring_ != MAP_FAILED && !single_mmap_) ::munmap(cq_ring_, cq_ring_bytes_);
+        if (sq_ring_ && sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_bytes_);
+        if (fd_ >= 0) ::close(fd_);
+        sqes_ = nullptr;
+        cq_ring_ = sq_ring_ = nullptr;
+        fd_ = -1;
+    }
+
+    bool valid() const { return fd_ >= 0; }
+    unsigned sq_entries() const { return sq_entries_; }
+
+    // Tek bir sabit buffer kaydeder (buf_index 0). Hata: false, errno.
+    bool register_buffer(void* base, std::size_t bytes) {
+        iovec iov{base, bytes};
+        return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+    }
+
+    // Boş SQE döner (sıfırlanmış); kuyruk doluysa nullptr. Yayın: submit().
+    io_uring_sqe* get_sqe() {
+        if (pending_ >= sq_entries_) return nullptr;
+        const unsigned tail = *sq_tail_ + pending_;
+        const unsigned idx = tail & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        ++pending_;
+        return sqe;
+    }
+
+    // Bekleyen SQE'leri yayınlar; wait_nr > 0 ise o kadar CQE gelene kadar bekler
+    int submit(unsigned wait_nr = 0) {
+        if (pending_) {
+            __atomic_store_n(sq_tail_, *sq_tail_ + pending_, __ATOMIC_RELEASE);
+        }
+        const unsigned to_submit = pending_;
+        pending_ = 0;
+        if (!to_submit && !wait_nr) return 0;
+        const unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+        int ret;
+        do {
+            ret = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, to_submit, wait_nr, flags,
+                                             nullptr, 0));
+        } while (ret < 0 && errno == EINTR);
+        return ret;
+    }
+
+    // Hazır CQE'leri fn(user_data, res) ile tüketir; tüketilen sayıyı döner
+    template <typename Fn>
+    unsigned reap(Fn&& fn) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            fn(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return n;
+    }
+
+private:
+    bool fail() {
+        const int saved = errno;
+        close();
+        errno = saved;
+        return false;
+    }
+
+    int fd_{-1};
+    bool single_mmap_{false};
+    void* sq_ring_{nullptr};
+    void* cq_ring_{nullptr};
+    io_uring_sqe* sqes_{nullptr};
+    std::size_t sq_ring_bytes_{0}, cq_ring_bytes_{0}, sqes_bytes_{0};
+
+    unsigned* sq_tail_{nullptr};
+    unsigned* sq_array_{nullptr};
+    unsigned sq_mask_{0};
+    unsigned sq_entries_{0};
+    unsigned pending_{0};   // get_sqe ile alınıp henüz yayınlanmamış SQE'ler
+
+    unsigned* cq_head_{nullptr};
+    unsigned* cq_tail_{nullptr};
+    unsigned cq_mask_{0};
+    io_uring_cqe* cqes_{nullptr};
+};
+
+class Recorder {
+public:
+    static constexpr std::size_t kDirectAlignment = 4096;  // O_DIRECT için güvenli hiza
+
+    struct Config {
+        unsigned queue_depth = 32;     // Aynı anda uçuştaki en fazla yazma isteği
+        std::size_t max_batch = 64;    // Yazma isteği başına en fazla chunk
+        bool direct = true;            // Şartlar uygunsa O_DIRECT
+        bool use_io_uring = true;      // false: her zaman senkron pwritev
+        bool register_buffers = true;  // data_cpu_ bölgesini sabit buffer olarak kaydet
+        bool verify_checksum = true;   // Buffer'da checksum lane'i varsa yazmadan önce doğrula
+    };
+
+    struct Stats {
+        std::uint64_t chunks = 0;       // Diske yazılıp release edilen chunk
+        std::uint64_t bytes = 0;        // Yazılan bayt
+        std::uint64_t writes = 0;       // Gönderilen yazma isteği (SQE veya pwritev)
+        std::uint64_t completions = 0;  // Toplanan CQE
+        std::uint64_t errors = 0;       // Başarısız/kısa yazma
+        std::uint64_t checksum_errors = 0;  // CRC'si tutmayan chunk (yine de yazılır)
+    };
+
+    Recorder(CircularBuffer& buffer, const std::string& path)
+        : Recorder(buffer, path, Config{}) {}
+    Recorder(CircularBuffer& buffer, const std::string& path, Config config)
+        : buffer_(buffer), config_(config) {
+        if (config_.queue_depth == 0) config_.queue_depth = 1;
+        if (config_.max_batch == 0) config_.max_batch = 1;
+        batch_.resize(config_.max_batch);
+        open_file(path);
+        if (fd_ < 0) return;
+
+        if (config_.use_io_uring && ring_.init(config_.queue_depth)) {
+            // Kayıt sürdükçe trim/resize sayfaları değiştirmesin (pin_storage)
+            if (config_.register_buffers) {
+                buffer_.pin_storage();
+                fixed_ = ring_.register_buffer(buffer_.chunk_storage(), buffer_.chunk_storage_bytes());
+                if (!fixed_) buffer_.unpin_storage();
+            }
+            requests_.resize(config_.queue_depth);
+            for (unsigned i = 0; i < config_.queue_depth; ++i) free_.push_back(i);
+        }
+    }
+
+    ~Recorder() {
+        drain();
+        ring_.close();
+        if (fixed_) buffer_.unpin_storage();
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // ========================================================================
+    // pump: Tamamlananları release eder, boş istek yuvası kadar yeni yazar
+    // ========================================================================
+    // Non-blocking (io_uring yolunda submit beklemez). Dönüş: bu çağrıda
+    // kuyruğa alınan (pwritev yolunda yazılan) chunk sayısı.
+    // ========================================================================
+    std::size_t pump() {
+        if (fd_ < 0) return 0;
+        if (!ring_.valid()) return pump_sync();
+
+        reap();
+        std::size_t queued = 0;
+        while (!free_.empty()) {
+            const std::size_t n = claim_batch();
+            if (n == 0) break;
+            queued += n;
+            // Ring sarmasında bitişik olmayan parçalara böl
+            std::size_t start = 0;
+            while (start < n) {
+                const std::size_t end = contiguous_end(start, n);
+                if (free_.empty()) {
+                    // Yuva kalmadı: kalan parçayı senkron yaz (nadir; batch > yuva)
+                    write_sync(start, n);
+                    break;
+                }
+                queue_write(start, end);
+                start = end;
+            }
+        }
+        ring_.submit();
+        return queued;
+    }
+
+    // ========================================================================
+    // drain: Uçuştaki tüm yazmalar tamamlanana kadar bekler ve release eder
+    // ========================================================================
+    void drain() {
+        if (!ring_.valid()) return;
+        ring_.submit();
+        while (in_flight_ > 0) {
+            ring_.submit(1);
+            reap();
+        }
+    }
+
+    bool ok() const { return fd_ >= 0; }
+    bool io_uring_active() const { return ring_.valid(); }
+    bool direct_active() const { return direct_; }
+    bool fixed_buffers() const { return fixed_; }
+    unsigned in_flight() const { return in_flight_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    // Uçuştaki bir yazma: hangi slot'lar, nereye, ne kadar
+    struct Request {
+        std::vector<CircularBuffer::Ticket> tickets;
+        iovec iov{};
+        std::uint64_t offset = 0;
+    };
+
+    void open_file(const std::string& path) {
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        const bool aligned =
+            reinterpret_cast<std::uintptr_t>(buffer_.chunk_storage()) % kDirectAlignment == 0 &&
+            buffer_.chunk_size() % kDirectAlignment == 0;
+        if (config_.direct && aligned) {
+            fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct_ = fd_ >= 0;
+        }
+        if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+    }
+
+    // batch_[start..] içinde bellekte bitişik olan son indeks + 1
+    std::size_t contiguous_end(std::size_t start, std::size_t n) const {
+        const std::size_t chunk = buffer_.chunk_size();
+        std::size_t end = start + 1;
+        while (end < n && batch_[end].cpu_ptr == batch_[end - 1].cpu_ptr + chunk) ++end;
+        return end;
+    }
+
+    void queue_write(std::size_t start, std::size_t end) {
+        const unsigned id = free_.back();
+        free_.pop_back();
+        Request& r = requests_[id];
+        r.tickets.assign(batch_.begin() + static_cast<std::ptrdiff_t>(start),
+                         batch_.begin() + static_cast<std::ptrdiff_t>(end));
+        r.iov.iov_base = batch_[start].cpu_ptr;
+        r.iov.iov_len = (end - start) * buffer_.chunk_size();
+        r.offset = next_offset_;
+        next_offset_ += r.iov.iov_len;
+
+        io_uring_sqe* sqe = ring_.get_sqe();
+        sqe->fd = fd_;
+        sqe->off = r.offset;
+        sqe->user_data = id;
+        if (fixed_) {
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            sqe->addr = reinterpret_cast<std::uint64_t>(r.iov.iov_base);
+            sqe->len = static_cast<std::uint32_t>(r.iov.iov_len);
+            sqe->buf_index = 0;
+        } else {
+            sqe->opcode = IORING_OP_WRITEV;
+            sqe->addr = reinterpret_cast<std::uint64_t>(&r.iov);
+            sqe->len = 1;
+        }
+        ++in_flight_;
+        ++stats_.writes;
+    }
+
+    // CQE'leri toplar; tamamlanan isteğin slot'larını release eder
+    void reap() {
+        ring_.reap([this](std::uint64_t user_data, int res) {
+            Request& r = requests_[static_cast<std::size_t>(user_data)];
+            ++stats_.completions;
+            std::size_t done = res > 0 ? static_cast<std::size_t>(res) : 0;
+            if (done < r.iov.iov_len) {
+                // Kısa yazma (ENOSPC yakını vb.): kalanı senkron tamamlamayı dene
+                done += pwrite_all(static_cast<const char*>(r.iov.iov_base) + done,
+                                   r.iov.iov_len - done, r.offset + done);
+                if (done < r.iov.iov_len) ++stats_.errors;
+            }
+            stats_.bytes += done;
+            stats_.chunks += r.tickets.size();
+            for (const auto& t : r.tickets) buffer_.release_consumer(t);
+            --in_flight_;
+            free_.push_back(static_cast<unsigned>(user_data));
+        });
+    }
+
+    // claim_consumer_batch + checksum doğrulaması (buffer zaten claim'de
+    // doğruluyorsa tekrar hesaplanmaz)
+    std::size_t claim_batch() {
+        const std::size_t n = buffer_.claim_consumer_batch(batch_.data(), config_.max_batch);
+        if (config_.verify_checksum && !buffer_.options().verify_on_claim) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!buffer_.verify_checksum(batch_[i])) ++stats_.checksum_errors;
+            }
+        }
+        return n;
+    }
+
+    // io_uring yok: batch'i ring sarmasına göre bölüp pwritev ile yazar
+    std::size_t pump_sync() {
+        const std::size_t n = claim_batch();
+        if (n) write_sync(0, n);
+        return n;
+    }
+
+    void write_sync(std::size_t start, std::size_t n) {
+        const std::size_t chunk = buffer_.chunk_size();
+        std::size_t i = start;
+        while (i < n) {
+            const std::size_t end = contiguous_end(i, n);
+            const std::size_t len = (end - i) * chunk;
+            iovec iov{batch_[i].cpu_ptr, len};
+            ++stats_.writes;
+            ssize_t w;
+            do {
+                w = ::pwritev(fd_, &iov, 1, static_cast<off_t>(next_offset_));
+            } while (w < 0 && errno == EINTR);
+            std::size_t done = w > 0 ? static_cast<std::size_t>(w) : 0;
+            if (done < len) {
+                done += pwrite_all(batch_[i].cpu_ptr + done, len - done, next_offset_ + done);
+                if (done < len) ++stats_.errors;
+            }
+            next_offset_ += len;
+            stats_.bytes += done;
+            stats_.chunks += end - i;
+            for (std::size_t k = i; k < end; ++k) buffer_.release_consumer(batch_[k]);
+            i = end;
+        }
+    }
+
+    // Kalan baytları pwrite ile yazar; yazılan bayt sayısını döner
+    std::size_t pwrite_all(const char* data, std::size_t len, std::uint64_t offset) {
+        std::size_t done = 0;
+        while (done < len) {
+            const ssize_t w = ::pwrite(fd_, data + done, len - done, static_cast<off_t>(offset + done));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            done += static_cast<std::size_t>(w);
+        }
+        return done;
+    }
+
+    CircularBuffer& buffer_;
+    Config config_;
+    Stats stats_;
+    int fd_{-1};
+    bool direct_{false};
+    bool fixed_{false};
+
+    IoUring ring_;
+    std::vector<Request> requests_;              // queue_depth yuva
+    std::vector<unsigned> free_;                 // Boş yuva indeksleri
+    unsigned in_flight_{0};
+    std::uint64_t next_offset_{0};               // Sıradaki yazmanın dosya offset'i
+    std::vector<CircularBuffer::Ticket> batch_;  // claim_consumer_batch çıktısı
+};
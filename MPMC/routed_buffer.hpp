@@ -0,0 +1,291 @@
+// ============================================================================
+// Routed Buffer: Key-affine yönlendirme ile kanal başına sıra garantisi
+// ============================================================================
+// MPMC consumer'larda aynı RF kanalının (rf.first) ardışık iki chunk'ı farklı
+// thread'lerde paralel işlenebilir; stateful filtreler kanal sırası ister.
+// RoutedBuffer, key'i (rf.first) hash'leyerek K partition'dan birine yönlendirir
+// ve her partition'ı aynı anda YALNIZCA BİR consumer'a verir.
+//
+// KATMANLAR:
+//   key --hash--> bucket (kBuckets, sabit) --bucket % K--> partition (sabit)
+//   partition --desired_owner_ / owner_--> consumer (rebalance ile değişir)
+//
+// Key -> partition eşlemesi hiç değişmez; bu yüzden bir key'in tüm item'ları
+// tek bir FIFO'dadır. Rebalance sadece partition -> consumer sahipliğini taşır.
+//
+// SAHİPLİK DEVRİ (handoff):
+// - join()/leave() yeni "desired owner" tablosu hesaplar (kontrol yolu, mutex)
+// - Eski sahip, desired != kendisi olduğunu gördüğünde yeni claim yapmaz;
+//   elindeki tüm item'ları release edince owner_'ı -1 yapar (release).
+//   Bırakma claim döngüsüne bağlı değildir: epoch değişiminde (refresh) elde
+//   item yoksa hemen, varsa son release_consumer'da yapılır. Eski sahip başka
+//   bir partition'da sürekli meşgul olsa bile yeni sahip bekletilmez.
+// - Yeni sahip owner_'ı -1 -> id CAS ile alır (acquire)
+// Böylece bir partition'ın item'ları hiçbir zaman iki consumer'da aynı anda
+// işlenmez; key başına FIFO rebalance sırasında da korunur.
+//
+// HOT KEY RAPORU:
+// Consumer claim'de key'in bucket sayacını artırır. Bucket'a sadece o
+// partition'ın sahibi yazdığı için RMW gerekmez (relaxed load + store).
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+class RoutedBuffer {
+public:
+    static constexpr std::size_t kBuckets = 4096;   // Hot key istatistiği çözünürlüğü
+
+    // Claim edilen slot + ait olduğu partition
+    struct Ticket {
+        CircularBuffer::Ticket slot;   // Partition içindeki slot bilgisi
+        std::size_t partition;         // Partition indeksi
+
+        CircularBuffer::Ticket* operator->() { return &slot; }
+        const CircularBuffer::Ticket* operator->() const { return &slot; }
+    };
+
+    // ========================================================================
+    // Consumer: join() ile alınan consumer tanıtıcısı (thread başına bir tane)
+    // ========================================================================
+    // Yerel partition listesi epoch değiştiğinde yeniden kurulur; claim yolu
+    // paylaşılan bir liste okumaz.
+    // ========================================================================
+    struct Consumer {
+        int id = -1;                          // Consumer id (join sırası değil, tablo indeksi)
+        std::uint64_t epoch = ~std::uint64_t{0};
+        std::vector<std::size_t> partitions;  // İlgilendiği partition'lar (sahip/aday)
+        std::size_t cursor = 0;               // Partition'lar arası round robin
+    };
+
+    // Hot key raporu satırı
+    struct HotKey {
+        int key;              // Bucket'ta en son görülen key (rf.first)
+        std::uint64_t count;  // Bucket'a düşen item sayısı
+        double share;         // Toplam içindeki pay (0..1)
+    };
+
+    RoutedBuffer(std::size_t partitions, std::size_t capacity_per_partition,
+                 std::size_t chunk_size, const BufferOptions& options = {})
+        : partition_count_(partitions == 0 ? 1 : partitions),
+          desired_owner_(partition_count_),
+          owner_(partition_count_),
+          in_flight_(partition_count_),
+          bucket_hits_(kBuckets),
+          bucket_key_(kBuckets) {
+        partitions_.reserve(partition_count_);
+        for (std::size_t i = 0; i < partition_count_; ++i) {
+            partitions_.push_back(std::make_unique<CircularBuffer>(capacity_per_partition, chunk_size,
+                                                                 sub_buffer_options(options, i)));
+            desired_owner_[i].store(-1, std::memory_order_relaxed);
+            owner_[i].store(-1, std::memory_order_relaxed);
+            in_flight_[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            bucket_hits_[b].store(0, std::memory_order_relaxed);
+            bucket_key_[b].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Key'in bucket'ı (Fibonacci hashing; ardışık kanal id'leri dağılır)
+    static std::size_t bucket_of(int key) {
+        const std::uint64_t h = static_cast<std::uint64_t>(static_cast<std::uint32_t>(key)) *
+                                0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 52);  // 64 - log2(kBuckets)
+    }
+
+    // Key'in partition'ı (hiç değişmez)
+    std::size_t partition_of(int key) const { return bucket_of(key) % partition_count_; }
+
+    // ========================================================================
+    // Producer: key'in partition'ında slot claim eder; rf.first = key yazılır
+    // ========================================================================
+    std::optional<Ticket> claim_producer(int key) {
+        const std::size_t p = partition_of(key);
+        auto t = partitions_[p]->claim_producer();
+        if (!t) return std::nullopt;
+        t->rf->first = key;
+        return Ticket{*t, p};
+    }
+
+    bool commit_producer(const Ticket& t) {
+        return partitions_[t.partition]->commit_producer(t.slot);
+    }
+
+    // ========================================================================
+    // join / leave: Consumer grubuna katılma / ayrılma (kontrol yolu)
+    // ========================================================================
+    // leave() çağrılmadan önce consumer elindeki tüm ticket'ları release etmiş
+    // olmalıdır; leave sahip olunan partition'ları serbest bırakır.
+    // ========================================================================
+    Consumer join() {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        int id = 0;
+        while (std::find(active_.begin(), active_.end(), id) != active_.end()) ++id;
+        active_.push_back(id);
+        rebalance_locked();
+        Consumer c;
+        c.id = id;
+        return c;
+    }
+
+    void leave(Consumer& c) {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        active_.erase(std::remove(active_.begin(), active_.end(), c.id), active_.end());
+        rebalance_locked();
+        for (std::size_t p = 0; p < partition_count_; ++p) {
+            int me = c.id;
+            owner_[p].compare_exchange_strong(me, -1, std::memory_order_release,
+                                              std::memory_order_relaxed);
+        }
+        c.id = -1;
+        c.partitions.clear();
+    }
+
+    // ========================================================================
+    // Consumer: Sahip olduğu partition'lardan claim eder (non-blocking)
+    // ========================================================================
+    std::optional<Ticket> claim_consumer(Consumer& c) {
+        if (c.id < 0) return std::nullopt;
+        const std::uint64_t e = epoch_.load(std::memory_order_acquire);
+        if (c.epoch != e) refresh(c, e);
+
+        const std::size_t n = c.partitions.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t idx = c.cursor + i;
+            if (idx >= n) idx -= n;
+            const std::size_t p = c.partitions[idx];
+
+            const int desired = desired_owner_[p].load(std::memory_order_relaxed);
+            int owner = owner_[p].load(std::memory_order_acquire);
+            if (owner != c.id) {
+                // Aday partition: önceki sahip bırakınca devral
+                if (desired != c.id || owner != -1) continue;
+                if (!owner_[p].compare_exchange_strong(owner, c.id, std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+                    continue;
+                }
+            } else if (desired != c.id) {
+                // Devrediliyor: yeni claim yok; elde item kalmadıysa bırak
+                if (in_flight_[p].load(std::memory_order_relaxed) == 0) {
+                    owner_[p].store(-1, std::memory_order_release);
+                }
+                continue;
+            }
+
+            if (auto t = partitions_[p]->claim_consumer()) {
+                in_flight_[p].store(in_flight_[p].load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+                record_hit(t->rf->first);
+                c.cursor = idx;  // Aynı partition'dan devam (batch dostu)
+                return Ticket{*t, p};
+            }
+        }
+        // Hiç item yok: sıradaki claim'de başka partition'dan başla
+        if (n) c.cursor = (c.cursor + 1) % n;
+        return std::nullopt;
+    }
+
+    // Consumer: slot'u geri verir (ticket'ı claim eden consumer çağırmalı)
+    void release_consumer(const Ticket& t) {
+        const std::size_t p = t.partition;
+        partitions_[p]->release_consumer(t.slot);
+        const std::uint32_t left = in_flight_[p].load(std::memory_order_relaxed) - 1;
+        in_flight_[p].store(left, std::memory_order_relaxed);
+        // Devredilen partition'ın son item'ı: yeni sahibi bekletmeden bırak
+        if (left == 0 && desired_owner_[p].load(std::memory_order_relaxed) !=
+                             owner_[p].load(std::memory_order_relaxed)) {
+            owner_[p].store(-1, std::memory_order_release);
+        }
+    }
+
+    void stop() {
+        for (auto& p : partitions_) p->stop();
+    }
+
+    // ========================================================================
+    // hot_keys: En çok item alan bucket'lar (azalan sırada)
+    // ========================================================================
+    std::vector<HotKey> hot_keys(std::size_t top_n) const {
+        std::vector<HotKey> all;
+        std::uint64_t total = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            const std::uint64_t hits = bucket_hits_[b].load(std::memory_order_relaxed);
+            if (!hits) continue;
+            total += hits;
+            all.push_back(HotKey{bucket_key_[b].load(std::memory_order_relaxed), hits, 0.0});
+        }
+        std::sort(all.begin(), all.end(),
+                  [](const HotKey& a, const HotKey& b) { return a.count > b.count; });
+        if (all.size() > top_n) all.resize(top_n);
+        for (auto& h : all) h.share = total ? static_cast<double>(h.count) / total : 0.0;
+        return all;
+    }
+
+    // Partition'ın şu anki sahibi (-1: sahipsiz)
+    int owner_of(std::size_t partition) const {
+        return owner_[partition].load(std::memory_order_relaxed);
+    }
+    std::size_t partition_count() const { return partition_count_; }
+    CircularBuffer& partition(std::size_t i) { return *partitions_[i]; }
+
+private:
+    // desired_owner_ tablosunu aktif consumer'lara round robin dağıtır
+    void rebalance_locked() {
+        for (std::size_t p = 0; p < partition_count_; ++p) {
+            const int owner = active_.empty() ? -1 : active_[p % active_.size()];
+            desired_owner_[p].store(owner, std::memory_order_relaxed);
+        }
+        epoch_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Consumer'ın yerel listesini yeniler: aday olduğu + hâlâ sahip olduğu.
+    // Devredilen ve elde item'ı olmayan partition'lar burada bırakılır;
+    // item'ı olanlar son release_consumer'da bırakılır.
+    void refresh(Consumer& c, std::uint64_t e) {
+        c.partitions.clear();
+        for (std::size_t p = 0; p < partition_count_; ++p) {
+            const bool desired = desired_owner_[p].load(std::memory_order_relaxed) == c.id;
+            bool owned = owner_[p].load(std::memory_order_relaxed) == c.id;
+            if (owned && !desired && in_flight_[p].load(std::memory_order_relaxed) == 0) {
+                owner_[p].store(-1, std::memory_order_release);
+                owned = false;
+            }
+            if (desired || owned) c.partitions.push_back(p);
+        }
+        c.cursor = 0;
+        c.epoch = e;
+    }
+
+    // Sadece partition sahibi yazar → RMW yerine load + store yeterli
+    void record_hit(int key) {
+        const std::size_t b = bucket_of(key);
+        bucket_hits_[b].store(bucket_hits_[b].load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+        bucket_key_[b].store(key, std::memory_order_relaxed);
+    }
+
+    std::size_t partition_count_;
+    std::vector<std::unique_ptr<CircularBuffer>> partitions_;
+
+    std::vector<std::atomic<int>> desired_owner_;        // Rebalance hedefi
+    std::vector<std::atomic<int>> owner_;                // Gerçek sahiplik (lease)
+    std::vector<std::atomic<std::uint32_t>> in_flight_;  // Sahibin release etmediği item'lar
+
+    std::vector<std::atomic<std::uint64_t>> bucket_hits_;
+    std::vector<std::atomic<int>> bucket_key_;
+
+    std::mutex control_mutex_;     // join/leave (hot path'te kullanılmaz)
+    std::vector<int> active_;      // Aktif consumer id'leri
+    alignas(64) std::atomic<std::uint64_t> epoch_{0};
+};
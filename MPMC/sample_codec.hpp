@@ -0,0 +1,352 @@
+// ============================================================================
+// Sample Codec: int16 örnekler için delta + zigzag + bit-packing
+// ============================================================================
+// data_gpu_ chunk'ları yavaş değişen int16 örneklerdir; ardışık farklar
+// küçüktür. Codec (harici bağımlılık yok):
+//
+//   1. Delta    : d_i = x_i - x_{i-1} (16 bit modüler; x_{-1} = 0)
+//   2. Zigzag   : z = (d << 1) ^ (d >> 15)  -> küçük |d| küçük pozitif z
+//   3. Bit-pack : 128 örneklik blok başına b = max(z)'nin bit genişliği;
+//                 blok 1 bayt b + 16*b bayt
+//
+// BLOK DÜZENİ (SIMD-BP128 benzeri, 16 bit lane):
+// 128 örnek 16 satır x 8 lane olarak görülür (satır r = örnek 8r..8r+7).
+// Lane'ler bağımsız paketlenir: satırlar sırayla her lane'in bit akışına
+// eklenir, dolan her 16 bitlik kelime 8 lane birlikte (tek 128 bit vektör)
+// yazılır. Böylece SSE2'de tüm adımlar lane-paralel shift/or olur; skaler
+// fallback aynı formatı lane döngüsüyle üretir.
+//
+// ENCODED FORMAT: uint32 örnek sayısı + ceil(n/128) blok. Son blok sıfır
+// delta ile doldurulur; decoder n'den fazlasını yazmaz.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+class SampleCodec {
+public:
+    static constexpr std::size_t kBlock = 128;   // Blok başına örnek
+    static constexpr std::size_t kLanes = 8;     // 128 bit vektörde 16 bit lane
+    static constexpr std::size_t kRows = kBlock / kLanes;
+
+    // n örnek için en kötü durum encoded boyutu (b = 16)
+    static constexpr std::size_t max_encoded_bytes(std::size_t n) {
+        return sizeof(std::uint32_t) + (n + kBlock - 1) / kBlock * (1 + kBlock * sizeof(short));
+    }
+
+    // ========================================================================
+    // encode: n örneği out'a yazar; yazılan bayt sayısını döner
+    // ========================================================================
+    // out en az max_encoded_bytes(n) bayt olmalıdır.
+    // ========================================================================
+    static std::size_t encode(const short* in, std::size_t n, std::uint8_t* out) {
+        const std::uint32_t count = static_cast<std::uint32_t>(n);
+        std::memcpy(out, &count, sizeof(count));
+        std::uint8_t* p = out + sizeof(count);
+
+        alignas(16) std::uint16_t zz[kBlock];
+        std::uint16_t prev = 0;
+        for (std::size_t base = 0; base < n; base += kBlock) {
+            const std::size_t len = n - base < kBlock ? n - base : kBlock;
+            const std::uint16_t bits = delta_zigzag(in + base, len, prev, zz);
+            prev = static_cast<std::uint16_t>(in[base + len - 1]);
+            const unsigned b = bit_width(bits);
+            *p++ = static_cast<std::uint8_t>(b);
+            pack(zz, b, p);
+            p += b * kLanes * sizeof(std::uint16_t);
+        }
+        return static_cast<std::size_t>(p - out);
+    }
+
+    // ========================================================================
+    // decode: encoded veriyi out'a açar; örnek sayısını döner
+    // ========================================================================
+    // Bozuk/kısa girdi veya max_out yetmezse nullopt döner. Boş chunk
+    // (count = 0 başlığı) geçerlidir ve 0 döner.
+    // ========================================================================
+    static std::optional<std::size_t> decode(const std::uint8_t* in, std::size_t bytes, short* out,
+                                             std::size_t max_out) {
+        std::uint32_t count = 0;
+        if (bytes < sizeof(count)) return std::nullopt;
+        std::memcpy(&count, in, sizeof(count));
+        if (count > max_out) return std::nullopt;
+        const std::uint8_t* p = in + sizeof(count);
+        const std::uint8_t* end = in + bytes;
+
+        alignas(16) std::uint16_t zz[kBlock];
+        std::uint16_t prev = 0;
+        for (std::size_t base = 0; base < count; base += kBlock) {
+            if (p >= end) return std::nullopt;
+            const unsigned b = *p++;
+            const std::size_t block_bytes = b * kLanes * sizeof(std::uint16_t);
+            if (b > 16 || static_cast<std::size_t>(end - p) < block_bytes) return std::nullopt;
+            unpack(p, b, zz);
+            p += block_bytes;
+            const std::size_t len = count - base < kBlock ? count - base : kBlock;
+            prev = unzigzag_prefix(zz, len, prev, out + base);
+        }
+        return count;
+    }
+
+private:
+    static unsigned bit_width(std::uint16_t v) {
+        return v ? 32u - static_cast<unsigned>(__builtin_clz(v)) : 0u;
+    }
+
+    // zz[0..kBlock) = zigzag(delta); len'den sonrası 0. Dönüş: tüm zz'lerin OR'u.
+    static std::uint16_t delta_zigzag(const short* in, std::size_t len, std::uint16_t prev,
+                                      std::uint16_t* zz) {
+        std::size_t i = 0;
+        std::uint16_t bits = 0;
+#if defined(__SSE2__)
+        if (len == kBlock) {
+            // İlk vektörün "önceki" değerleri: prev, in[0..6]
+            __m128i acc = _mm_setzero_si128();
+            __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            __m128i before = _mm_insert_epi16(_mm_slli_si128(cur, 2), prev, 0);
+            for (; i < kBlock; i += kLanes) {
+                if (i) {
+                    cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                    before = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i - 1));
+                }
+                const __m128i d = _mm_sub_epi16(cur, before);
+                const __m128i z = _mm_xor_si128(_mm_slli_epi16(d, 1), _mm_srai_epi16(d, 15));
+                _mm_store_si128(reinterpret_cast<__m128i*>(zz + i), z);
+                acc = _mm_or_si128(acc, z);
+            }
+            acc = _mm_or_si128(acc, _mm_srli_si128(acc, 8));
+            acc = _mm_or_si128(acc, _mm_srli_si128(acc, 4));
+            acc = _mm_or_si128(acc, _mm_srli_si128(acc, 2));
+            return static_cast<std::uint16_t>(_mm_cvtsi128_si32(acc));
+        }
+#endif
+        for (; i < len; ++i) {
+            const std::uint16_t x = static_cast<std::uint16_t>(in[i]);
+            const std::int16_t d = static_cast<std::int16_t>(static_cast<std::uint16_t>(x - prev));
+            const std::uint16_t z = static_cast<std::uint16_t>(
+                static_cast<std::uint16_t>(d << 1) ^ static_cast<std::uint16_t>(d >> 15));
+            zz[i] = z;
+            bits |= z;
+            prev = x;
+        }
+        for (; i < kBlock; ++i) zz[i] = 0;
+        return bits;
+    }
+
+    // zz -> out[0..len); dönüş: son örnek (sonraki bloğun prev'i)
+    static std::uint16_t unzigzag_prefix(const std::uint16_t* zz, std::size_t len, std::uint16_t prev,
+                                         short* out) {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        __m128i carry = _mm_set1_epi16(static_cast<short>(prev));
+        const __m128i one = _mm_set1_epi16(1);
+        for (; i + kLanes <= len; i += kLanes) {
+            const __m128i z = _mm_load_si128(reinterpret_cast<const __m128i*>(zz + i));
+            // unzigzag: (z >> 1) ^ -(z & 1)
+            __m128i d = _mm_xor_si128(_mm_srli_epi16(z, 1),
+                                      _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(z, one)));
+            // 8 lane içi prefix sum (log adım), sonra önceki vektörün son değeri
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+            d = _mm_add_epi16(d, carry);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), d);
+            carry = _mm_shufflehi_epi16(d, 0xFF);
+            carry = _mm_unpackhi_epi64(carry, carry);
+        }
+        if (i) prev = static_cast<std::uint16_t>(out[i - 1]);
+#endif
+        for (; i < len; ++i) {
+            const std::uint16_t z = zz[i];
+            const std::uint16_t d = static_cast<std::uint16_t>((z >> 1) ^ static_cast<std::uint16_t>(-(z & 1)));
+            prev = static_cast<std::uint16_t>(prev + d);
+            out[i] = static_cast<short>(prev);
+        }
+        return prev;
+    }
+
+    // 16 satır x 8 lane -> b adet 8 lane'lik kelime vektörü
+    static void pack(const std::uint16_t* zz, unsigned b, std::uint8_t* out) {
+        if (b == 0) return;
+#if defined(__SSE2__)
+        __m128i acc = _mm_setzero_si128();
+        unsigned fill = 0;
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+        for (std::size_t r = 0; r < kRows; ++r) {
+            const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(zz + r * kLanes));
+            acc = _mm_or_si128(acc, _mm_sll_epi16(v, _mm_cvtsi32_si128(static_cast<int>(fill))));
+            fill += b;
+            if (fill >= 16) {
+                _mm_storeu_si128(dst++, acc);
+                fill -= 16;
+                acc = fill ? _mm_srl_epi16(v, _mm_cvtsi32_si128(static_cast<int>(b - fill)))
+                           : _mm_setzero_si128();
+            }
+        }
+#else
+        std::uint16_t acc[kLanes] = {};
+        unsigned fill = 0;
+        std::uint8_t* dst = out;
+        for (std::size_t r = 0; r < kRows; ++r) {
+            const std::uint16_t* v = zz + r * kLanes;
+            for (std::size_t l = 0; l < kLanes; ++l) acc[l] = static_cast<std::uint16_t>(acc[l] | (v[l] << fill));
+            fill += b;
+            if (fill >= 16) {
+                std::memcpy(dst, acc, sizeof(acc));
+                dst += sizeof(acc);
+                fill -= 16;
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    acc[l] = fill ? static_cast<std::uint16_t>(v[l] >> (b - fill)) : 0;
+                }
+            }
+        }
+#endif
+    }
+
+    // pack'in tersi: b kelime vektörü -> 16 satır x 8 lane
+    static void unpack(const std::uint8_t* in, unsigned b, std::uint16_t* zz) {
+        if (b == 0) {
+            std::memset(zz, 0, kBlock * sizeof(std::uint16_t));
+            return;
+        }
+        const std::uint16_t mask = static_cast<std::uint16_t>(b == 16 ? 0xFFFF : (1u << b) - 1);
+#if defined(__SSE2__)
+        const __m128i vmask = _mm_set1_epi16(static_cast<short>(mask));
+        const __m128i* src = reinterpret_cast<const __m128i*>(in);
+        __m128i word = _mm_loadu_si128(src++);
+        unsigned used = 0;   // word'ün tüketilen bit sayısı
+        for (std::size_t r = 0; r < kRows; ++r) {
+            __m128i v = _mm_srl_epi16(word, _mm_cvtsi32_si128(static_cast<int>(used)));
+            used += b;
+            if (used >= 16) {
+                used -= 16;
+                if (r + 1 < kRows || used) word = _mm_loadu_si128(src++);
+                if (used) v = _mm_or_si128(v, _mm_sll_epi16(word, _mm_cvtsi32_si128(static_cast<int>(b - used))));
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(zz + r * kLanes), _mm_and_si128(v, vmask));
+        }
+#else
+        std::uint16_t word[kLanes];
+        const std::uint8_t* src = in;
+        std::memcpy(word, src, sizeof(word));
+        src += sizeof(word);
+        unsigned used = 0;
+        for (std::size_t r = 0; r < kRows; ++r) {
+            std::uint16_t* v = zz + r * kLanes;
+            for (std::size_t l = 0; l < kLanes; ++l) v[l] = static_cast<std::uint16_t>(word[l] >> used);
+            used += b;
+            if (used >= 16) {
+                used -= 16;
+                if (r + 1 < kRows || used) {
+                    std::memcpy(word, src, sizeof(word));
+                    src += sizeof(word);
+                }
+                if (used) {
+                    for (std::size_t l = 0; l < kLanes; ++l) {
+                        v[l] = static_cast<std::uint16_t>(v[l] | (word[l] << (b - used)));
+                    }
+                }
+            }
+            for (std::size_t l = 0; l < kLanes; ++l) v[l] = static_cast<std::uint16_t>(v[l] & mask);
+        }
+#endif
+    }
+};
+
+// ============================================================================
+// CodecStage: Tüketilen chunk'ları kodlayıp/açıp ikinci bir ring'e aktarır
+// ============================================================================
+// Encode: girdi gpu_ptr (sample_count örnek, bkz. CircularBuffer::sample_count)
+//         -> çıktı cpu_ptr,
+//         *size_ptr = encoded bayt (CaptureWriter sadece size baytı yazar)
+// Decode: girdi cpu_ptr[0..min(*size_ptr, chunk_size)) -> çıktı gpu_ptr,
+//         *size_ptr = örnek sayısı * sizeof(short); çözülemeyen chunk 0 bayt
+// rf ve seq lane'i aynen taşınır. Encode için çıktı chunk_size en az
+// SampleCodec::max_encoded_bytes(girdi shorts_per_chunk) olmalıdır.
+// Çıktı buffer'ına yazan TEK producer CodecStage olmalıdır; girdi
+// buffer'ında başka consumer'lar olabilir.
+// ============================================================================
+class CodecStage {
+public:
+    enum class Mode { Encode, Decode };
+
+    struct Stats {
+        std::uint64_t chunks = 0;
+        std::uint64_t raw_bytes = 0;       // Açık örnek baytı
+        std::uint64_t encoded_bytes = 0;   // Kodlanmış bayt
+        std::uint64_t errors = 0;          // Çözülemeyen / sığmayan chunk
+    };
+
+    CodecStage(CircularBuffer& in, CircularBuffer& out, Mode mode)
+        : in_(in), out_(out), mode_(mode) {}
+
+    // En fazla max_chunks chunk işler (girdi boş / çıktı ring'i doluysa durur)
+    std::size_t pump(std::size_t max_chunks = 64) {
+        std::size_t done = 0;
+        while (done < max_chunks) {
+            auto o = out_.claim_producer();
+            if (!o) break;
+            auto i = in_.claim_consumer();
+            if (!i) {
+                out_.abandon_producer(*o);   // Çıktı slot'u commit edilmez; sonra tekrar kullanılır
+                break;
+            }
+            process(*i, *o);
+            in_.release_consumer(*i);
+            // Tek producer şartı ihlal edildiyse (başka producer slot'u aldı) item kaybolur
+            if (!out_.commit_producer(*o)) ++stats_.errors;
+            ++done;
+        }
+        return done;
+    }
+
+    const Stats& stats() const { return stats_; }
+    // Kodlanmış / açık oran (encode modunda < 1 iyi)
+    double ratio() const {
+        return stats_.raw_bytes ? static_cast<double>(stats_.encoded_bytes) / stats_.raw_bytes : 0.0;
+    }
+
+private:
+    void process(const CircularBuffer::Ticket& i, const CircularBuffer::Ticket& o) {
+        *o.rf = *i.rf;
+        if (i.seq_ptr && o.seq_ptr) *o.seq_ptr = *i.seq_ptr;
+        std::size_t written = 0;
+        if (mode_ == Mode::Encode) {
+            const std::size_t n = in_.sample_count(i);
+            if (SampleCodec::max_encoded_bytes(n) <= out_.chunk_size()) {
+                written = SampleCodec::encode(i.gpu_ptr, n, reinterpret_cast<std::uint8_t*>(o.cpu_ptr));
+                stats_.raw_bytes += n * sizeof(short);
+                stats_.encoded_bytes += written;
+            } else {
+                ++stats_.errors;
+            }
+        } else {
+            // Bozuk size_ptr chunk dışına okutmasın
+            const std::size_t bytes = std::min(*i.size_ptr, in_.chunk_size());
+            const auto n = SampleCodec::decode(reinterpret_cast<const std::uint8_t*>(i.cpu_ptr),
+                                               bytes, o.gpu_ptr, out_.shorts_per_chunk());
+            if (n) written = *n * sizeof(short);
+            else ++stats_.errors;
+            stats_.encoded_bytes += bytes;
+            stats_.raw_bytes += written;
+        }
+        *o.size_ptr = written;
+        ++stats_.chunks;
+    }
+
+    CircularBuffer& in_;
+    CircularBuffer& out_;
+    Mode mode_;
+    Stats stats_;
+};
@@ -0,0 +1,161 @@
+// ============================================================================
+// Producer Sıra Numaraları ve Gap (Kayıp) Tespiti
+// ============================================================================
+// Producer'lar item kaybedebilir (dolu buffer'da claim başarısız, bilinçli
+// drop). Consumer tarafı bunu
+// normalde göremez. BufferOptions::sequence_tracking açıkken her slot'ta
+// 64-bit bir sıra numarası lane'i (Ticket::seq_ptr) bulunur:
+//
+// - ProducerSequencer: Producer başına artan sayaç; her item'a bir numara
+//   damgalar. Drop edilen item da numara tüketir → consumer'da gap görünür.
+// - GapDetector: Consumer başına; rf.first (producer id) ile indekslenen
+//   "beklenen sıradaki numara" tablosu tutar. Hızlı yol tek bir karşılaştırma;
+//   gap/reorder durumunda sayaçlar güncellenir ve callback çağrılır.
+//   Tablo max_producers ile sınırlıdır ve kurulumda ayrılır; aralık dışı
+//   id'ler (bozuk/rastgele rf.first) izlenmez, untracked'ta sayılır.
+//
+// THREAD MODELİ:
+// GapDetector thread-safe DEĞİLDİR; her consumer thread kendi detector'ını
+// kullanmalıdır. Aynı producer'ın item'ları birden fazla consumer'a
+// dağılıyorsa her consumer kendi payında "gap" görür; bu durumda
+// toplam kaybı ölçmek için tek consumer veya ShardedBuffer'da home shard
+// eşlemesi kullanın.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// ProducerSequencer: Producer başına monoton artan sıra numarası
+// ============================================================================
+// KULLANIM:
+//   ProducerSequencer seq;
+//   auto t = buffer.claim_producer();
+//   if (!t) { seq.advance(); continue; }   // item drop edildi → gap oluşur
+//   seq.stamp(*t);
+//   ... veri yaz ...
+//   buffer.commit_producer(*t);   // Tek slot commit'i her zaman başarılı
+//   seq.advance();
+// ============================================================================
+class ProducerSequencer {
+public:
+    explicit ProducerSequencer(std::uint64_t first = 0) : next_(first) {}
+
+    // Sıradaki numarayı slot metadata'sına yazar (sayacı ilerletmez)
+    void stamp(CircularBuffer::Ticket& t) const {
+        if (t.seq_ptr) *t.seq_ptr = next_;
+    }
+
+    // Item tamamlandı (commit edildi veya bilinçli drop edildi)
+    void advance() { ++next_; }
+
+    std::uint64_t next() const { return next_; }
+
+private:
+    std::uint64_t next_;
+};
+
+// ============================================================================
+// GapDetector: Consumer tarafı gap / reorder tespiti
+// ============================================================================
+class GapDetector {
+public:
+    enum class Result { InOrder, Gap, Reordered };
+
+    // Gap/reorder olayı: callback'e iletilir
+    struct Event {
+        Result kind;               // Gap veya Reordered
+        int producer_id;           // rf.first
+        std::uint64_t expected;    // Beklenen numara
+        std::uint64_t observed;    // Gelen numara
+        std::uint64_t missing;     // Gap ise kayıp item sayısı (observed - expected)
+    };
+
+    // Toplam sayaçlar
+    struct Stats {
+        std::uint64_t in_order = 0;     // Beklenen sırada gelen item'lar
+        std::uint64_t gap_events = 0;   // Gap olay sayısı
+        std::uint64_t lost = 0;         // Gap'lerde atlanan toplam numara
+        std::uint64_t reordered = 0;    // Beklenenden küçük numara (geç/çift)
+        std::uint64_t untracked = 0;    // Aralık dışı producer id (izlenmedi)
+    };
+
+    using Callback = std::function<void(const Event&)>;
+
+    static constexpr std::size_t kDefaultMaxProducers = 1024;
+
+    // Producer id'leri [0, max_producers) izlenir
+    explicit GapDetector(Callback on_event = {}, std::size_t max_producers = kDefaultMaxProducers)
+        : expected_(max_producers, 0), seen_(max_producers, false), on_event_(std::move(on_event)) {}
+
+    // ========================================================================
+    // check: (producer_id, seq) çiftini doğrular
+    // ========================================================================
+    // Hızlı yol: tablo lookup + eşitlik kontrolü + artış. Bir producer'ın ilk
+    // item'ı her zaman InOrder sayılır (başlangıç numarası bilinmez).
+    // [0, max_producers) dışındaki id'ler izlenmez: untracked sayılır,
+    // InOrder döner (tablo büyümez).
+    // ========================================================================
+    Result check(int producer_id, std::uint64_t seq) {
+        if (producer_id < 0 || static_cast<std::size_t>(producer_id) >= expected_.size()) {
+            ++stats_.untracked;
+            return Result::InOrder;
+        }
+        const auto id = static_cast<std::size_t>(producer_id);
+        if (!seen_[id]) {
+            seen_[id] = true;
+            expected_[id] = seq + 1;
+            ++stats_.in_order;
+            return Result::InOrder;
+        }
+
+        const std::uint64_t exp = expected_[id];
+        if (seq == exp) {  // Hızlı yol
+            expected_[id] = seq + 1;
+            ++stats_.in_order;
+            return Result::InOrder;
+        }
+
+        if (seq > exp) {
+            // Aradaki numaralar hiç gelmedi
+            ++stats_.gap_events;
+            stats_.lost += seq - exp;
+            expected_[id] = seq + 1;
+            if (on_event_) on_event_(Event{Result::Gap, producer_id, exp, seq, seq - exp});
+            return Result::Gap;
+        }
+
+        // seq < exp: geç gelen (yeniden sıralanmış) veya çift item
+        ++stats_.reordered;
+        if (on_event_) on_event_(Event{Result::Reordered, producer_id, exp, seq, 0});
+        return Result::Reordered;
+    }
+
+    // Ticket'tan doğrudan kontrol (rf.first + seq_ptr); seq lane yoksa InOrder
+    Result check(const CircularBuffer::Ticket& t) {
+        if (!t.seq_ptr) return Result::InOrder;
+        return check(t.rf->first, *t.seq_ptr);
+    }
+
+    const Stats& stats() const { return stats_; }
+    std::size_t max_producers() const { return expected_.size(); }
+    void reset() {
+        std::fill(expected_.begin(), expected_.end(), 0);
+        std::fill(seen_.begin(), seen_.end(), false);
+        stats_ = Stats{};
+    }
+
+private:
+    std::vector<std::uint64_t> expected_;   // producer id -> beklenen numara
+    std::vector<bool> seen_;                // producer id -> en az bir item görüldü mü
+    Stats stats_;
+    Callback on_event_;
+};
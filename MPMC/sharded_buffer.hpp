@@ -0,0 +1,126 @@
+// ============================================================================
+// Sharded MPMC Buffer: Çekirdek başına CircularBuffer shard'ları
+// ============================================================================
+// Tek bir CircularBuffer'da tüm producer'lar tail_ cache line'ına, tüm
+// consumer'lar head_ cache line'ına yüklenir. Thread sayısı arttıkça bu iki
+// satır çekirdekler arasında sürekli gidip gelir ve throughput düşer.
+//
+// ShardedBuffer, N adet bağımsız CircularBuffer (shard) tutar:
+// - Producer: kendi shard'ına yazar (producer id -> shard sabit eşlemesi)
+// - Consumer: önce kendi (home) shard'ını boşaltır, boşsa diğer shard'lardan
+//   sırayla çalar (work stealing)
+//
+// SIRA GARANTİSİ:
+// Bir producer her zaman aynı shard'a yazdığı için (shard_for_producer) ve
+// her shard kendi içinde FIFO olduğu için producer başına FIFO korunur.
+// Shard'lar arasında global bir sıra YOKTUR.
+//
+// NOT: Bir shard'a birden fazla producer yazarsa CircularBuffer'ın normal
+// davranışı geçerlidir (claim özeldir: biri yazarken diğerinin claim'i
+// nullopt döner). En iyi sonuç için shard sayısı >= producer
+// sayısı seçilmelidir.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class ShardedBuffer {
+public:
+    // Claim edilen slot + ait olduğu shard
+    struct Ticket {
+        CircularBuffer::Ticket slot;   // Shard içindeki slot bilgisi (cpu_ptr, gpu_ptr, ...)
+        std::size_t shard;             // Slot'un ait olduğu shard indeksi
+
+        CircularBuffer::Ticket* operator->() { return &slot; }
+        const CircularBuffer::Ticket* operator->() const { return &slot; }
+    };
+
+    // Constructor: shard_count adet shard, her biri capacity_per_shard chunk
+    ShardedBuffer(std::size_t shard_count, std::size_t capacity_per_shard,
+                  std::size_t chunk_size, const BufferOptions& options = {}) {
+        if (shard_count == 0) shard_count = 1;  // emniyet
+        shards_.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            // Her shard ayrı heap nesnesi: head_/tail_ satırları shard'lar
+            // arasında paylaşılmaz (CircularBuffer zaten alignas(64) kullanır)
+            shards_.push_back(std::make_unique<CircularBuffer>(capacity_per_shard, chunk_size,
+                                                             sub_buffer_options(options, i)));
+        }
+    }
+
+    // Producer id'den shard'a sabit eşleme (FIFO için her zaman aynı shard)
+    std::size_t shard_for_producer(std::size_t producer_id) const {
+        return producer_id % shards_.size();
+    }
+
+    // Consumer id'den home shard'a eşleme
+    std::size_t shard_for_consumer(std::size_t consumer_id) const {
+        return consumer_id % shards_.size();
+    }
+
+    // ========================================================================
+    // Producer: Kendi shard'ında boş slot claim eder (non-blocking)
+    // ========================================================================
+    // Shard doluysa diğer shard'lara TAŞMAZ; aksi halde producer başına FIFO
+    // bozulurdu. Dolu/shutdown durumunda std::nullopt döner.
+    // ========================================================================
+    std::optional<Ticket> claim_producer(std::size_t producer_id) {
+        std::size_t s = shard_for_producer(producer_id);
+        auto t = shards_[s]->claim_producer();
+        if (!t) return std::nullopt;
+        return Ticket{*t, s};
+    }
+
+    // Producer: slot'u yayınlar; false ise item kayboldu (bkz. CircularBuffer)
+    bool commit_producer(const Ticket& t) {
+        return shards_[t.shard]->commit_producer(t.slot);
+    }
+
+    // ========================================================================
+    // Consumer: Önce home shard, sonra diğerleri (work stealing)
+    // ========================================================================
+    // Çalma sırası home+1, home+2, ... şeklindedir; böylece farklı home
+    // shard'a sahip consumer'lar aynı kurban shard'a yığılmaz.
+    // ========================================================================
+    std::optional<Ticket> claim_consumer(std::size_t consumer_id) {
+        const std::size_t n = shards_.size();
+        const std::size_t home = shard_for_consumer(consumer_id);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t s = home + i;
+            if (s >= n) s -= n;
+            if (auto t = shards_[s]->claim_consumer()) {
+                return Ticket{*t, s};
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Consumer: slot'u ait olduğu shard'a geri verir
+    void release_consumer(const Ticket& t) {
+        shards_[t.shard]->release_consumer(t.slot);
+    }
+
+    // Tüm shard'ları kapatır
+    void stop() {
+        for (auto& s : shards_) s->stop();
+    }
+
+    std::size_t shard_count() const { return shards_.size(); }
+    CircularBuffer& shard(std::size_t i) { return *shards_[i]; }
+
+    // Tüm shard'ların yaklaşık toplam doluluğu
+    std::size_t size_approx() const {
+        std::size_t total = 0;
+        for (const auto& s : shards_) total += s->size_approx();
+        return total;
+    }
+
+private:
+    std::vector<std::unique_ptr<CircularBuffer>> shards_;
+};
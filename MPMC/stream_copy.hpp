@@ -0,0 +1,125 @@
+// ============================================================================
+// stream_copy: Non-temporal (streaming) store ile bellek kopyası
+// ============================================================================
+// 16-64 KiB chunk yazan producer'lar normal store'larla veriyi cache'ten
+// geçirir ve paylaşılan L2/L3'teki consumer çalışma kümesini dışarı atar.
+// Non-temporal store'lar (MOVNTDQ) write-combining buffer'larından doğrudan
+// belleğe yazar; cache satırı ayrılmaz (RFO de yok).
+//
+// Uygulamalar (çalışma anında seçilir, derleme bayrağı gerekmez):
+//   1. AVX2 : _mm256_stream_si256, 32 bayt/store (64 bayt/iterasyon)
+//   2. SSE2 : _mm_stream_si128, 16 bayt/store (x86-64 tabanı)
+//   3. Diğer: memcpy
+// Hedefin hizasız başı ve kuyruğu normal memcpy ile yazılır.
+//
+// ÖNEMLİ: Streaming store'lar zayıf sıralıdır; veriyi yayınlayan store'dan
+// (slot seq'i) önce _mm_sfence() gerekir. CircularBuffer bunu
+// commit_producer'da yapar (bkz. BufferOptions::streaming_store_threshold).
+// ============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace stream_copy_detail {
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+inline void copy_avx2(char* dst, const char* src, std::size_t n) {
+    for (; n >= 64; n -= 64, dst += 64, src += 64) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+    }
+    for (; n >= 16; n -= 16, dst += 16, src += 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    }
+    std::memcpy(dst, src, n);
+}
+
+inline void copy_sse2(char* dst, const char* src, std::size_t n) {
+    for (; n >= 64; n -= 64, dst += 64, src += 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+    }
+    for (; n >= 16; n -= 16, dst += 16, src += 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    }
+    std::memcpy(dst, src, n);
+}
+#endif
+
+enum class Impl { Memcpy, Sse2, Avx2 };
+
+inline Impl detect() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? Impl::Avx2 : Impl::Sse2;
+#else
+    return Impl::Memcpy;
+#endif
+}
+
+inline Impl active() {
+    static const Impl impl = detect();
+    return impl;
+}
+
+}  // namespace stream_copy_detail
+
+// ============================================================================
+// stream_copy: dst'ye n bayt non-temporal store ile yazar (sfence YAPMAZ)
+// ============================================================================
+inline void stream_copy(void* dst, const void* src, std::size_t n) {
+    auto* d = static_cast<char*>(dst);
+    const auto* s = static_cast<const char*>(src);
+#if defined(__x86_64__)
+    using namespace stream_copy_detail;
+    if (active() != Impl::Memcpy) {
+        // Hizasız baş: normal store ile 32 bayt sınırına kadar
+        const std::size_t head = (32 - (reinterpret_cast<std::uintptr_t>(d) & 31)) & 31;
+        if (head >= n) {
+            std::memcpy(d, s, n);
+            return;
+        }
+        std::memcpy(d, s, head);
+        if (active() == Impl::Avx2) copy_avx2(d + head, s + head, n - head);
+        else copy_sse2(d + head, s + head, n - head);
+        return;
+    }
+#endif
+    std::memcpy(d, s, n);
+}
+
+// Streaming store'ları sonraki store'lardan önce görünür kılar
+inline void stream_fence() {
+#if defined(__x86_64__)
+    _mm_sfence();
+#else
+    std::atomic_thread_fence(std::memory_order_release);
+#endif
+}
+
+// Seçilen uygulamanın adı (bench/log için)
+inline const char* stream_copy_impl_name() {
+    switch (stream_copy_detail::active()) {
+        case stream_copy_detail::Impl::Avx2: return "avx2";
+        case stream_copy_detail::Impl::Sse2: return "sse2";
+        case stream_copy_detail::Impl::Memcpy: break;
+    }
+    return "memcpy";
+}
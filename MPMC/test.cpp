@@ -4,10 +4,40 @@
 // Bu test dosyası CircularBuffer'ın tüm özelliklerini test eder
 // ============================================================================
 
-#include "main.cpp"
+#include "circular_buffer.hpp"
+#include "sharded_buffer.hpp"
+#include "sequence_tracking.hpp"
+#include "lane_buffer.hpp"
+#include "routed_buffer.hpp"
+#include "udp_ingest.hpp"
+#include "recorder.hpp"
+#include "capture.hpp"
+#include "sample_codec.hpp"
+#include "topology.hpp"
+#include "memory_trimmer.hpp"
+#include "trace.hpp"
+#include "perf_counters.hpp"
+#include "stream_copy.hpp"
+#include "aggregate_stage.hpp"
+#include "fir_stage.hpp"
+#include "fft_stage.hpp"
+#include "detect_stage.hpp"
 #include <cassert>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
 #include <thread>
 #include <vector>
 #include <atomic>
@@ -86,12 +116,28 @@ void test_exception_safety() {
         return;
     }
     std::size_t pos1 = ticket1->pos;
+    // Claim özel: commit/abandon edilmemiş slot ikinci producer'a verilmez
+    if (buffer.claim_producer()) {
+        results.report("test_exception_safety", false, "Claimed slot handed out twice");
+        return;
+    }
+    buffer.abandon_producer(*ticket1);
     auto ticket2 = buffer.claim_producer();
     if (!ticket2) {
         results.report("test_exception_safety", false, "Second claim failed");
         return;
     }
     bool success = (ticket2->pos == pos1);
+    buffer.abandon_producer(*ticket2);
+    // RAII: exception'da ticket otomatik commit edilir, slot tıkanmaz
+    try {
+        auto raii = buffer.claim_producer_raii();
+        throw std::runtime_error("producer failed");
+    } catch (const std::runtime_error&) {
+    }
+    auto ticket3 = buffer.claim_producer();
+    success = success && ticket3 && ticket3->pos == pos1 + 1;
+    if (ticket3) buffer.commit_producer(*ticket3);
     results.report("test_exception_safety", success, success ? "" : "Different slots");
 }
 
@@ -107,14 +153,20 @@ void test_multiple_producer_consumer() {
     
     for (int i = 0; i < num_producers; ++i) {
         threads.emplace_back([&, i]() {
-            for (int j = 0; j < items_per_producer; ++j) {
+            for (int j = 0; j < items_per_producer;) {
                 auto ticket = buffer.claim_producer();
-                if (!ticket) continue;
+                if (!ticket) {
+                    // Kuyruk dolu: item'ı atlamak consumer'ları sonsuza dek bekletir
+                    std::this_thread::yield();
+                    continue;
+                }
                 std::snprintf(ticket->cpu_ptr, 64, "P%d-%d", i, j);
                 *ticket->rf = {i, static_cast<double>(j)};
                 *ticket->size_ptr = 10;
+                // Claim özel: commit her zaman yayınlar (kayıp/tekrar yok)
                 buffer.commit_producer(*ticket);
                 ++produced;
+                ++j;
             }
         });
     }
@@ -153,16 +205,15 @@ void test_shutdown() {
 
 void test_capacity_limit() {
     CircularBuffer buffer(4, 64);
-    std::vector<std::optional<CircularBuffer::Ticket>> tickets;
+    // claim tail_'i ilerletmez (bkz. test_exception_safety); buffer'ı
+    // doldurmak için her slot commit edilmeli
+    int filled = 0;
     for (int i = 0; i < 4; ++i) {
         auto ticket = buffer.claim_producer();
-        if (ticket) tickets.push_back(ticket);
+        if (ticket && buffer.commit_producer(*ticket)) ++filled;
     }
     auto ticket5 = buffer.claim_producer();
-    bool success = !ticket5.has_value();
-    for (auto& t : tickets) {
-        if (t) buffer.commit_producer(*t);
-    }
+    bool success = (filled == 4) && !ticket5.has_value();
     results.report("test_capacity_limit", success, success ? "" : "Expected nullopt");
 }
 
@@ -219,6 +270,2314 @@ void test_commit_increments_tail() {
     results.report("test_commit_increments_tail", success, success ? "" : "Same slot");
 }
 
+void test_sharded_fifo_per_producer() {
+    ShardedBuffer buffer(4, 8, 64);
+    constexpr int num_producers = 4;
+    constexpr int items_per_producer = 2000;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_producers; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < items_per_producer;) {
+                auto ticket = buffer.claim_producer(i);
+                if (!ticket) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                ticket->slot.rf->first = i;
+                ticket->slot.rf->second = static_cast<double>(j);
+                buffer.commit_producer(*ticket);
+                ++j;
+            }
+        });
+    }
+
+    // Tek consumer: gözlem sırası = claim sırası, producer başına artan olmalı
+    std::vector<int> last(num_producers, -1);
+    int consumed = 0;
+    bool ordered = true;
+    while (consumed < num_producers * items_per_producer) {
+        auto ticket = buffer.claim_consumer(0);
+        if (!ticket) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = ticket->slot.rf->first;
+        int v = static_cast<int>(ticket->slot.rf->second);
+        if (v != last[p] + 1) ordered = false;
+        last[p] = v;
+        buffer.release_consumer(*ticket);
+        ++consumed;
+    }
+    for (auto& t : threads) t.join();
+    results.report("test_sharded_fifo_per_producer", ordered, ordered ? "" : "Per-producer order broken");
+}
+
+void test_sharded_work_stealing() {
+    ShardedBuffer buffer(4, 4, 64);
+    auto ticket = buffer.claim_producer(2);  // shard 2
+    if (!ticket) {
+        results.report("test_sharded_work_stealing", false, "claim_producer nullopt");
+        return;
+    }
+    std::snprintf(ticket->slot.cpu_ptr, 64, "steal-me");
+    buffer.commit_producer(*ticket);
+
+    // Consumer 0'ın home shard'ı boş; shard 2'den çalmalı
+    auto consumer_ticket = buffer.claim_consumer(0);
+    bool success = consumer_ticket && consumer_ticket->shard == 2 &&
+                   std::string(consumer_ticket->slot.cpu_ptr) == "steal-me";
+    if (consumer_ticket) buffer.release_consumer(*consumer_ticket);
+    success = success && !buffer.claim_consumer(1).has_value();
+    results.report("test_sharded_work_stealing", success, success ? "" : "Steal failed");
+}
+
+void test_sequence_gap_detection() {
+    BufferOptions options;
+    options.sequence_tracking = true;
+    CircularBuffer buffer(8, 64, options);
+    ProducerSequencer seq;
+
+    // 0, 1 commit; 2 drop; 3 commit → consumer 1 gap (1 kayıp) görmeli
+    for (int i = 0; i < 4; ++i) {
+        if (i == 2) {
+            seq.advance();
+            continue;
+        }
+        auto ticket = buffer.claim_producer();
+        if (!ticket || !ticket->seq_ptr) {
+            results.report("test_sequence_gap_detection", false, "claim/seq lane missing");
+            return;
+        }
+        *ticket->rf = {7, 0.0};
+        seq.stamp(*ticket);
+        buffer.commit_producer(*ticket);
+        seq.advance();
+    }
+
+    int callbacks = 0;
+    GapDetector detector([&](const GapDetector::Event& e) {
+        if (e.kind == GapDetector::Result::Gap && e.expected == 2 && e.observed == 3) ++callbacks;
+    });
+    while (auto ticket = buffer.claim_consumer()) {
+        detector.check(*ticket);
+        buffer.release_consumer(*ticket);
+    }
+    const auto& st = detector.stats();
+    bool success = st.in_order == 2 && st.gap_events == 1 && st.lost == 1 &&
+                   st.reordered == 0 && callbacks == 1;
+    results.report("test_sequence_gap_detection", success, success ? "" : "Unexpected gap stats");
+}
+
+void test_sequence_reorder_detection() {
+    GapDetector detector;
+    detector.check(1, 10);
+    detector.check(1, 11);
+    detector.check(2, 0);
+    auto r = detector.check(1, 11);  // çift/geç item
+    bool no_seq_lane = true;
+    {
+        CircularBuffer buffer(4, 64);  // sequence_tracking kapalı
+        auto t = buffer.claim_producer();
+        no_seq_lane = t && t->seq_ptr == nullptr;
+    }
+    // Aralık dışı id'ler tabloyu büyütmez, untracked sayılır
+    GapDetector bounded({}, 4);
+    const bool untracked = bounded.check(1 << 30, 5) == GapDetector::Result::InOrder &&
+                           bounded.check(-1, 5) == GapDetector::Result::InOrder &&
+                           bounded.check(3, 0) == GapDetector::Result::InOrder &&
+                           bounded.check(3, 2) == GapDetector::Result::Gap &&
+                           bounded.stats().untracked == 2 && bounded.max_producers() == 4;
+    bool success = r == GapDetector::Result::Reordered &&
+                   detector.stats().reordered == 1 && detector.stats().in_order == 3 &&
+                   no_seq_lane && untracked;
+    results.report("test_sequence_reorder_detection", success, success ? "" : "Reorder not detected");
+}
+
+void test_lane_strict_priority() {
+    LaneBuffer buffer(3, 8, 64);
+    // Önce bulk (lane 2), sonra kontrol (lane 0) mesajı
+    for (std::size_t lane : {2u, 2u, 0u}) {
+        auto t = buffer.claim_producer(lane);
+        if (!t) {
+            results.report("test_lane_strict_priority", false, "claim_producer nullopt");
+            return;
+        }
+        t->slot.rf->first = static_cast<int>(lane);
+        buffer.commit_producer(*t);
+    }
+    LaneBuffer::Cursor cursor;
+    std::vector<std::size_t> order;
+    while (auto t = buffer.claim_consumer(cursor)) {
+        order.push_back(t->lane);
+        buffer.release_consumer(*t);
+    }
+    bool success = order == std::vector<std::size_t>{0, 2, 2} && buffer.ready_mask() == 0;
+    results.report("test_lane_strict_priority", success, success ? "" : "Wrong drain order");
+}
+
+void test_lane_weighted_round_robin() {
+    LaneBuffer buffer(2, 64, 64, LaneBuffer::Policy::WeightedRoundRobin, {3, 1});
+    for (std::size_t lane = 0; lane < 2; ++lane) {
+        for (int i = 0; i < 40; ++i) {
+            auto t = buffer.claim_producer(lane);
+            if (t) buffer.commit_producer(*t);
+        }
+    }
+    // İki lane de doluyken ilk 40 item'da 3:1 oran beklenir; ilk tur lane 0'la başlar
+    LaneBuffer::Cursor cursor;
+    int per_lane[2] = {0, 0};
+    std::string first_round;
+    for (int i = 0; i < 40; ++i) {
+        auto t = buffer.claim_consumer(cursor);
+        if (!t) break;
+        ++per_lane[t->lane];
+        if (i < 4) first_round += static_cast<char>('0' + t->lane);
+        buffer.release_consumer(*t);
+    }
+    bool success = per_lane[0] == 30 && per_lane[1] == 10 && first_round == "0001";
+    results.report("test_lane_weighted_round_robin", success,
+                   success ? "" : "Unexpected ratio " + std::to_string(per_lane[0]) + ":" +
+                                      std::to_string(per_lane[1]));
+}
+
+void test_lane_concurrent_no_lost_items() {
+    LaneBuffer buffer(4, 16, 64);
+    constexpr int items_per_lane = 5000;
+    std::vector<std::thread> producers;
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+        producers.emplace_back([&, lane]() {
+            for (int i = 0; i < items_per_lane;) {
+                auto t = buffer.claim_producer(lane);
+                if (!t) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                buffer.commit_producer(*t);
+                ++i;
+            }
+        });
+    }
+    std::atomic<int> consumed{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; ++c) {
+        consumers.emplace_back([&]() {
+            LaneBuffer::Cursor cursor;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (consumed.load() < 4 * items_per_lane &&
+                   std::chrono::steady_clock::now() < deadline) {
+                auto t = buffer.claim_consumer(cursor);
+                if (!t) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                buffer.release_consumer(*t);
+                ++consumed;
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+    for (auto& t : consumers) t.join();
+    bool success = consumed.load() == 4 * items_per_lane;
+    results.report("test_lane_concurrent_no_lost_items", success,
+                   success ? "" : "Stranded items: " + std::to_string(consumed.load()));
+}
+
+void test_routed_per_key_fifo_with_rebalance() {
+    RoutedBuffer buffer(8, 16, 64);
+    constexpr int num_keys = 16;
+    constexpr int items_per_key = 1500;
+    std::vector<std::atomic<int>> last_seen(num_keys);
+    for (auto& v : last_seen) v.store(-1);
+    std::atomic<int> consumed{0};
+    std::atomic<bool> order_ok{true};
+    std::atomic<bool> producers_done{false};
+
+    // Tek producer tüm key'leri sırayla üretir (key başına artan değer)
+    std::thread producer([&]() {
+        for (int i = 0; i < items_per_key; ++i) {
+            for (int k = 0; k < num_keys;) {
+                auto t = buffer.claim_producer(k);
+                if (!t) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                t->slot.rf->second = static_cast<double>(i);
+                buffer.commit_producer(*t);
+                ++k;
+            }
+        }
+        producers_done = true;
+    });
+
+    auto consume = [&](RoutedBuffer::Consumer& c, int max_items) {
+        for (int n = 0; n < max_items && consumed.load() < num_keys * items_per_key;) {
+            auto t = buffer.claim_consumer(c);
+            if (!t) {
+                std::this_thread::yield();
+                continue;
+            }
+            const int key = t->slot.rf->first;
+            const int v = static_cast<int>(t->slot.rf->second);
+            // Partition sahipliği tekil olduğu için key'e eşzamanlı erişim yok
+            if (last_seen[key].load(std::memory_order_relaxed) != v - 1) order_ok = false;
+            last_seen[key].store(v, std::memory_order_relaxed);
+            buffer.release_consumer(*t);
+            ++consumed;
+            ++n;
+        }
+    };
+
+    // C0 baştan beri var; C1 ortada katılır; C2 katılır ve erken ayrılır
+    std::thread c0([&]() {
+        auto c = buffer.join();
+        consume(c, num_keys * items_per_key);
+        buffer.leave(c);
+    });
+    std::thread c1([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        auto c = buffer.join();
+        consume(c, num_keys * items_per_key);
+        buffer.leave(c);
+    });
+    std::thread c2([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        auto c = buffer.join();
+        consume(c, 3000);
+        buffer.leave(c);
+    });
+    producer.join();
+    c0.join();
+    c1.join();
+    c2.join();
+
+    bool success = order_ok.load() && consumed.load() == num_keys * items_per_key;
+    results.report("test_routed_per_key_fifo_with_rebalance", success,
+                   success ? "" : "Per-key order broken or items lost");
+}
+
+void test_routed_hot_keys() {
+    RoutedBuffer buffer(4, 256, 64);
+    auto produce = [&](int key, int count) {
+        for (int i = 0; i < count; ++i) {
+            auto t = buffer.claim_producer(key);
+            if (t) buffer.commit_producer(*t);
+        }
+    };
+    produce(5, 90);
+    for (int k = 10; k < 19; ++k) produce(k, 10);
+    auto c = buffer.join();
+    while (auto t = buffer.claim_consumer(c)) buffer.release_consumer(*t);
+    auto hot = buffer.hot_keys(3);
+    bool success = !hot.empty() && hot[0].key == 5 && hot[0].count == 90 &&
+                   hot[0].share > 0.49 && hot[0].share < 0.51;
+    buffer.leave(c);
+    results.report("test_routed_hot_keys", success, success ? "" : "Hot key not reported");
+}
+
+void test_routed_handoff_while_busy() {
+    RoutedBuffer buffer(2, 128, 64);
+    int keys[2] = {-1, -1};
+    for (int k = 0; keys[0] < 0 || keys[1] < 0; ++k) {
+        if (keys[buffer.partition_of(k)] < 0) keys[buffer.partition_of(k)] = k;
+    }
+    auto produce = [&](std::size_t p, int count) {
+        for (int i = 0; i < count; ++i) {
+            auto t = buffer.claim_producer(keys[p]);
+            if (t) buffer.commit_producer(*t);
+        }
+    };
+
+    // A iki partition'ın da sahibi olur
+    auto a = buffer.join();
+    produce(0, 1);
+    produce(1, 1);
+    for (int i = 0; i < 2; ++i) {
+        if (auto t = buffer.claim_consumer(a)) buffer.release_consumer(*t);
+    }
+    bool success = buffer.owner_of(0) == a.id && buffer.owner_of(1) == a.id;
+
+    // A P1'den bir item tutarken B katılır (P1 -> B); A P0'da sürekli meşgul
+    produce(0, 64);
+    produce(1, 9);
+    auto held = buffer.claim_consumer(a);
+    success = success && held && held->partition == 1;
+    auto b = buffer.join();
+    int a_items = 0;
+    int b_items = 0;
+    for (int round = 0; round < 16; ++round) {
+        if (auto t = buffer.claim_consumer(a)) {
+            success = success && t->partition == 0;
+            buffer.release_consumer(*t);
+            ++a_items;
+        }
+        // Eski sahip elindeki son P1 item'ını release eder; claim döngüsü P1'e hiç uğramaz
+        if (round == 2 && held) buffer.release_consumer(*held);
+        if (auto t = buffer.claim_consumer(b)) {
+            success = success && t->partition == 1;
+            buffer.release_consumer(*t);
+            ++b_items;
+        }
+    }
+    // B, P0 hâlâ doluyken P1'in kalan 8 item'ını almış olmalı
+    success = success && b_items == 8 && a_items == 16 && buffer.owner_of(1) == b.id &&
+              buffer.partition(0).size_approx() > 0;
+    while (auto t = buffer.claim_consumer(a)) buffer.release_consumer(*t);
+    buffer.leave(b);
+    buffer.leave(a);
+    results.report("test_routed_handoff_while_busy", success,
+                   success ? "" : "New owner starved while old owner busy on another partition");
+}
+
+void test_readiness_fd_edge_signalling() {
+    BufferOptions options;
+    options.readiness_fd = true;
+    CircularBuffer buffer(8, 64, options);
+    auto readable = [&]() {
+        pollfd pfd{buffer.event_fd(), POLLIN, 0};
+        return ::poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+    };
+    bool success = buffer.event_fd() >= 0 && buffer.arm_readiness() && !readable();
+
+    // İlk commit fd'yi okunabilir yapar; ikinci commit syscall yapmaz
+    for (int i = 0; i < 2; ++i) {
+        auto t = buffer.claim_producer();
+        if (t) buffer.commit_producer(*t);
+    }
+    success = success && readable() && buffer.readiness_signals() == 1;
+    // Veri varken arm beklemeye izin vermemeli
+    success = success && !buffer.arm_readiness();
+
+    buffer.drain_readiness();
+    while (auto t = buffer.claim_consumer()) buffer.release_consumer(*t);
+    success = success && !readable() && buffer.arm_readiness();
+    buffer.stop();
+    success = success && readable();
+    results.report("test_readiness_fd_edge_signalling", success, success ? "" : "Unexpected readiness state");
+}
+
+void test_wait_strategies_blocking_claims() {
+    bool success = true;
+    std::string msg;
+    for (auto w : {WaitStrategy::BusySpin, WaitStrategy::PauseSpin, WaitStrategy::Yield,
+                   WaitStrategy::Sleep, WaitStrategy::Park}) {
+        BufferOptions options;
+        options.producer_wait = w;
+        options.consumer_wait = w;
+        options.sleep_interval = std::chrono::microseconds(10);
+        CircularBuffer buffer(4, 64, options);  // Küçük kapasite: producer da bekler
+        constexpr int items = 300;
+        std::atomic<int> consumed{0};
+        std::thread consumer([&]() {
+            while (auto t = buffer.claim_consumer_wait(std::chrono::seconds(5))) {
+                buffer.release_consumer(*t);
+                if (++consumed == items) break;
+            }
+        });
+        for (int i = 0; i < items;) {
+            auto t = buffer.claim_producer_wait(std::chrono::seconds(5));
+            if (!t) break;
+            buffer.commit_producer(*t);
+            ++i;
+        }
+        consumer.join();
+        if (consumed.load() != items) {
+            success = false;
+            msg += std::string(wait_strategy_name(w)) + " lost items; ";
+        }
+    }
+    results.report("test_wait_strategies_blocking_claims", success, msg);
+}
+
+void test_wait_park_stop_and_timeout() {
+    BufferOptions options;
+    options.consumer_wait = WaitStrategy::Park;
+    CircularBuffer buffer(4, 64, options);
+
+    // Timeout: boş ring'de nullopt dönmeli
+    auto t0 = std::chrono::steady_clock::now();
+    bool timed_out = !buffer.claim_consumer_wait(std::chrono::milliseconds(20)).has_value();
+    bool waited = std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(15);
+
+    // stop(): park etmiş consumer uyanıp nullopt dönmeli
+    std::atomic<bool> returned{false};
+    std::thread consumer([&]() {
+        auto t = buffer.claim_consumer_wait();
+        returned = !t.has_value();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    buffer.stop();
+    consumer.join();
+    bool success = timed_out && waited && returned.load();
+    results.report("test_wait_park_stop_and_timeout", success, success ? "" : "Park wake/timeout failed");
+}
+
+void test_udp_ingest_loopback() {
+    CircularBuffer buffer(16, 64);
+    int rx = UdpIngest::open_socket(0, "127.0.0.1");
+    int tx = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx < 0 || tx < 0) {
+        results.report("test_udp_ingest_loopback", false, "socket setup failed");
+        if (rx >= 0) ::close(rx);
+        if (tx >= 0) ::close(tx);
+        return;
+    }
+    sockaddr_in dst{};
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(UdpIngest::local_port(rx));
+    ::inet_pton(AF_INET, "127.0.0.1", &dst.sin_addr);
+
+    // 10 normal datagram + 1 chunk'tan büyük (kesilmeli)
+    constexpr int count = 10;
+    for (int i = 0; i < count; ++i) {
+        char msg[32];
+        int len = std::snprintf(msg, sizeof(msg), "pkt-%d", i);
+        ::sendto(tx, msg, static_cast<std::size_t>(len) + 1, 0, reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+    }
+    std::vector<char> big(200, 'x');
+    ::sendto(tx, big.data(), big.size(), 0, reinterpret_cast<sockaddr*>(&dst), sizeof(dst));
+
+    UdpIngest::Config config;
+    config.batch = 4;
+    config.channel = 3;
+    UdpIngest ingest(buffer, rx, config);
+    std::size_t total = 0;
+    for (int attempt = 0; attempt < 100 && total < count + 1; ++attempt) {
+        total += ingest.poll_once(MSG_WAITFORONE);
+    }
+
+    bool success = total == count + 1 && ingest.stats().truncated == 1 &&
+                   ingest.stats().syscalls < total;
+    for (int i = 0; i < count && success; ++i) {
+        auto t = buffer.claim_consumer();
+        char expect[32];
+        std::snprintf(expect, sizeof(expect), "pkt-%d", i);
+        success = t && std::string(t->cpu_ptr) == expect &&
+                  *t->size_ptr == std::strlen(expect) + 1 && t->rf->first == 3;
+        if (t) buffer.release_consumer(*t);
+    }
+    auto last = buffer.claim_consumer();
+    success = success && last && *last->size_ptr == 64;
+    ::close(rx);
+    ::close(tx);
+    results.report("test_udp_ingest_loopback", success, success ? "" : "Datagrams not ingested correctly");
+}
+
+void test_recorder_writes_in_claim_order() {
+    constexpr std::size_t chunk = 4096;
+    constexpr std::size_t count = 200;
+    bool success = true;
+    std::string detail;
+    // io_uring (mümkünse O_DIRECT + registered buffer) ve senkron pwritev yolu
+    for (bool use_ring : {true, false}) {
+        BufferOptions options;
+        options.data_alignment = Recorder::kDirectAlignment;
+        CircularBuffer buffer(16, chunk, options);
+        const std::string path = "/tmp/mpmc_recorder_test_" + std::to_string(::getpid()) + ".bin";
+
+        Recorder::Config config;
+        config.queue_depth = 4;
+        config.max_batch = 3;
+        config.use_io_uring = use_ring;
+        std::size_t recorded = 0;
+        {
+            Recorder recorder(buffer, path, config);
+            if (!recorder.ok()) {
+                success = false;
+                detail = "cannot open " + path;
+                break;
+            }
+            std::thread producer([&] {
+                for (std::size_t i = 0; i < count;) {
+                    auto t = buffer.claim_producer();
+                    if (!t) { std::this_thread::yield(); continue; }
+                    std::memset(t->cpu_ptr, static_cast<int>(i & 0xFF), chunk);
+                    std::memcpy(t->cpu_ptr, &i, sizeof(i));
+                    buffer.commit_producer(*t);
+                    ++i;
+                }
+            });
+            while (recorder.stats().chunks < count) {
+                if (!recorder.pump()) std::this_thread::yield();
+            }
+            producer.join();
+            recorder.drain();
+            recorded = recorder.stats().chunks;
+            if (use_ring && !recorder.io_uring_active()) detail = "io_uring unavailable, pwritev used";
+            // Kayıtlı buffer depolamayı Recorder yaşadıkça pin'ler
+            success = success && recorder.stats().errors == 0 &&
+                      buffer.storage_pinned() == recorder.fixed_buffers();
+        }
+        success = success && !buffer.storage_pinned();
+
+        // Dosya: kayıt i = chunk i, sırayla ve tam boy
+        int fd = ::open(path.c_str(), O_RDONLY);
+        std::vector<char> block(chunk);
+        for (std::size_t i = 0; i < count && success; ++i) {
+            std::size_t id = 0;
+            success = ::pread(fd, block.data(), chunk, static_cast<off_t>(i * chunk)) == static_cast<ssize_t>(chunk);
+            std::memcpy(&id, block.data(), sizeof(id));
+            success = success && id == i &&
+                      block[chunk - 1] == static_cast<char>(i & 0xFF);
+        }
+        success = success && recorded == count &&
+                  ::lseek(fd, 0, SEEK_END) == static_cast<off_t>(count * chunk) &&
+                  buffer.size_approx() == 0;
+        ::close(fd);
+        ::unlink(path.c_str());
+        if (!success && detail.empty()) detail = use_ring ? "io_uring path corrupt" : "pwritev path corrupt";
+    }
+    results.report("test_recorder_writes_in_claim_order", success, success ? "" : detail);
+}
+
+void test_journal_survives_crash() {
+    const std::string path = "/tmp/mpmc_journal_test_" + std::to_string(::getpid()) + ".ring";
+    ::unlink(path.c_str());
+    BufferOptions options;
+    options.journal_path = path;
+    options.sequence_tracking = true;
+    options.journal_sync_items = 4;
+
+    // Child: 8 item commit; 0,1,2'yi claim et, 0 ve 2'yi release et (1 in-flight,
+    // 2'nin yeri delik), bir item daha commit et ve _exit ile "çök"
+    // (destructor/sync yok). Geriye kalan: 1,3,4,5,6,7,8
+    pid_t child = ::fork();
+    if (child == 0) {
+        CircularBuffer buffer(8, 64, options);
+        auto produce = [&](int i) {
+            auto t = buffer.claim_producer();
+            if (!t) ::_exit(2);
+            std::snprintf(t->cpu_ptr, 64, "item-%d", i);
+            *t->rf = {i % 3, i * 0.5};
+            *t->size_ptr = static_cast<std::size_t>(i);
+            *t->seq_ptr = 100 + static_cast<std::uint64_t>(i);
+            if (!buffer.commit_producer(*t)) ::_exit(3);
+        };
+        for (int i = 0; i < 8; ++i) produce(i);
+        auto a = buffer.claim_consumer();
+        auto b = buffer.claim_consumer();
+        auto c = buffer.claim_consumer();
+        if (!a || !b || !c) ::_exit(5);
+        buffer.release_consumer(*a);
+        buffer.release_consumer(*c);
+        produce(8);
+        ::_exit(buffer.journal_syncs() >= 2 ? 0 : 4);
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    bool success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    // Parent: yeniden aç; tüketilmemiş 7 item sırayla ve delik olmadan gelmeli
+    if (success) {
+        CircularBuffer buffer(8, 64, options);
+        success = buffer.journaled() && !buffer.journal_was_clean() &&
+                  buffer.recovered_items() == 7 && buffer.size_approx() == 7;
+        for (int i : {1, 3, 4, 5, 6, 7, 8}) {
+            if (!success) break;
+            auto t = buffer.claim_consumer();
+            char expect[16];
+            std::snprintf(expect, sizeof(expect), "item-%d", i);
+            success = t && std::string(t->cpu_ptr) == expect && t->rf->first == i % 3 &&
+                      t->rf->second == i * 0.5 && *t->size_ptr == static_cast<std::size_t>(i) &&
+                      *t->seq_ptr == 100 + static_cast<std::uint64_t>(i);
+            if (t) buffer.release_consumer(*t);
+        }
+        success = success && !buffer.claim_consumer();
+        // Ring kurtarmadan sonra normal çalışır (wrap dahil)
+        for (int i = 0; i < 12 && success; ++i) {
+            auto p = buffer.claim_producer();
+            success = p && buffer.commit_producer(*p);
+            auto c = buffer.claim_consumer();
+            success = success && c;
+            if (c) buffer.release_consumer(*c);
+        }
+    }
+    // Düzgün kapanıştan sonra: boş ve clean
+    if (success) {
+        CircularBuffer buffer(8, 64, options);
+        success = buffer.journal_was_clean() && buffer.recovered_items() == 0;
+    }
+    // Farklı geometri reddedilir
+    if (success) {
+        bool threw = false;
+        try {
+            CircularBuffer wrong(16, 64, options);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        success = threw;
+    }
+    ::unlink(path.c_str());
+
+    // Producer (her commit'te) ve flusher aynı anda sync eder; checkpoint tutarlı kalır
+    if (success) {
+        BufferOptions concurrent = options;
+        concurrent.journal_sync_items = 1;
+        concurrent.journal_sync_interval = std::chrono::milliseconds(1);
+        {
+            CircularBuffer buffer(64, 64, concurrent);
+            std::vector<std::thread> producers;
+            for (int p = 0; p < 2; ++p) {
+                producers.emplace_back([&] {
+                    for (int i = 0; i < 2000;) {
+                        auto t = buffer.claim_producer();
+                        if (!t) {
+                            if (auto c = buffer.claim_consumer()) buffer.release_consumer(*c);
+                            continue;
+                        }
+                        buffer.commit_producer(*t);
+                        ++i;
+                    }
+                });
+            }
+            for (auto& t : producers) t.join();
+            success = buffer.journal_syncs() >= 4000;
+        }
+        CircularBuffer reopened(64, 64, concurrent);
+        success = success && reopened.journal_was_clean() &&
+                  reopened.recovered_items() == reopened.size_approx();
+        ::unlink(path.c_str());
+    }
+
+    // Sarmalayıcılar: her shard kendi "<path>.<i>" dosyasını kullanır
+    if (success) {
+        BufferOptions sharded_options;
+        sharded_options.journal_path = path;
+        {
+            ShardedBuffer sharded(2, 8, 64, sharded_options);
+            for (int i = 0; i < 3; ++i) {
+                auto t = sharded.claim_producer(1);
+                success = success && t && sharded.commit_producer(*t);
+            }
+        }
+        ShardedBuffer sharded(2, 8, 64, sharded_options);
+        success = success && sharded.shard(0).recovered_items() == 0 &&
+                  sharded.shard(1).recovered_items() == 3 &&
+                  ::access((path + ".0").c_str(), F_OK) == 0 && ::access(path.c_str(), F_OK) != 0;
+        ::unlink((path + ".0").c_str());
+        ::unlink((path + ".1").c_str());
+    }
+    results.report("test_journal_survives_crash", success, success ? "" : "Journal did not restore unconsumed items");
+}
+
+void test_capture_index_seek_and_replay() {
+    const std::string path = "/tmp/mpmc_capture_test_" + std::to_string(::getpid()) + ".cap";
+    constexpr int count = 1000;
+    constexpr std::uint64_t step_ns = 20000;   // 20 µs -> toplam ~20 ms
+    bool success = true;
+
+    CircularBuffer source(16, 64);
+    {
+        CaptureWriter::Config config;
+        config.records_per_block = 64;
+        config.gpu_lane = true;
+        CaptureWriter writer(path, source, config);
+        for (int i = 0; i < count; ++i) {
+            auto t = source.claim_producer();
+            int len = std::snprintf(t->cpu_ptr, 64, "rec-%d", i) + 1;
+            t->gpu_ptr[0] = static_cast<short>(i);
+            *t->rf = {i % 4, i * 0.25};
+            *t->size_ptr = static_cast<std::size_t>(len);
+            source.commit_producer(*t);
+            auto c = source.claim_consumer();
+            writer.append(*c, static_cast<std::uint64_t>(i) * step_ns);
+            source.release_consumer(*c);
+        }
+    }
+
+    {
+        CaptureReader reader(path);
+        success = !reader.index_rebuilt() && reader.record_count() == count &&
+                  reader.block_count() == (count + 63) / 64 &&
+                  reader.first_block(300 * step_ns) == 300 / 64;
+        // Zaman aralığı + kanal filtresi: 300..399 içinde kanal 2 -> 25 kayıt
+        int seen = 0;
+        reader.for_each(300 * step_ns, 399 * step_ns, 2, [&](const CaptureRecord& r) {
+            const int i = static_cast<int>(r.t_ns / step_ns);
+            char expect[16];
+            std::snprintf(expect, sizeof(expect), "rec-%d", i);
+            success = success && i % 4 == 2 && std::string(r.payload) == expect &&
+                      r.rf.second == i * 0.25 && r.gpu && r.gpu[0] == i;
+            ++seen;
+            return true;
+        });
+        success = success && seen == 25;
+
+        // Replay: orijinal hızda ~20 ms sürmeli, max hızda çok daha kısa
+        for (double speed : {1.0, 0.0}) {
+            CircularBuffer target(64, 64);
+            std::atomic<int> received{0};
+            std::atomic<bool> ordered{true};
+            std::thread consumer([&] {
+                int next = 0;
+                while (next < count) {
+                    auto t = target.claim_consumer_wait(std::chrono::seconds(2));
+                    if (!t) break;
+                    char expect[16];
+                    std::snprintf(expect, sizeof(expect), "rec-%d", next);
+                    if (std::string(t->cpu_ptr) != expect || t->gpu_ptr[0] != next) ordered = false;
+                    target.release_consumer(*t);
+                    ++next;
+                }
+                received = next;
+            });
+            CaptureReplay::Config config;
+            config.speed = speed;
+            CaptureReplay replay(reader, target, config);
+            auto st = replay.run();
+            consumer.join();
+            success = success && st.records == count && received == count && ordered;
+            if (speed == 1.0) success = success && st.seconds >= 0.019;
+        }
+    }
+
+    // Bozuk dosyalar: taşan trailer, dosya dışı indeks girdisi, dev kayıt boyu,
+    // bozuk başlık. Okuma sınır dışına çıkmaz; indeks yeniden kurulur.
+    if (success) {
+        std::vector<char> image;
+        {
+            std::ifstream in(path, std::ios::binary);
+            image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        const std::string bad = path + ".bad";
+        auto write_bad = [&](const std::vector<char>& bytes) {
+            std::ofstream out(bad, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+        CaptureFormat::Trailer tr;
+        std::memcpy(&tr, image.data() + image.size() - sizeof(tr), sizeof(tr));
+        const std::size_t blocks = (count + 63) / 64;
+        auto count_records = [&](CaptureReader& reader) {
+            int n = 0;
+            reader.for_each(0, ~std::uint64_t{0}, -1, [&](const CaptureRecord& r) {
+                success = success && r.size <= 64;
+                ++n;
+                return true;
+            });
+            return n;
+        };
+
+        // block_count * sizeof(IndexEntry) 2^64'te sarar ve eski eşitlik kontrolünü geçer
+        std::vector<char> wrapped = image;
+        CaptureFormat::Trailer wtr = tr;
+        wtr.block_count += std::uint64_t{1} << 61;
+        std::memcpy(wrapped.data() + wrapped.size() - sizeof(wtr), &wtr, sizeof(wtr));
+        write_bad(wrapped);
+        {
+            CaptureReader reader(bad);
+            success = success && reader.index_rebuilt() && reader.block_count() == blocks &&
+                      count_records(reader) == count;
+        }
+
+        // İndeks girdisi dosya dışını gösterir
+        std::vector<char> outside = image;
+        const std::uint64_t far = image.size() * 16;
+        std::memcpy(outside.data() + tr.index_offset, &far, sizeof(far));
+        write_bad(outside);
+        {
+            CaptureReader reader(bad);
+            success = success && reader.index_rebuilt() && reader.block_count() == blocks &&
+                      count_records(reader) == count;
+        }
+
+        // İlk bloğun ikinci kaydının boyu dev: bloğun kalanı atlanır, diğerleri okunur
+        std::vector<char> huge = image;
+        const std::size_t record_bytes =
+            sizeof(CaptureFormat::RecordHeader) + 8 + CaptureFormat::pad8(source.shorts_per_chunk() * 2);
+        const std::size_t second = sizeof(CaptureFormat::FileHeader) + sizeof(CaptureFormat::BlockHeader) +
+                                   record_bytes + offsetof(CaptureFormat::RecordHeader, size);
+        const std::uint32_t giant = 0xFFFFFFF0u;
+        std::memcpy(huge.data() + second, &giant, sizeof(giant));
+        write_bad(huge);
+        {
+            CaptureReader reader(bad);
+            success = success && !reader.index_rebuilt() && count_records(reader) == count - 63;
+        }
+
+        // Bozuk başlık fırlatır; fd ve eşleme sızmaz
+        auto open_fds = [] {
+            std::size_t n = 0;
+            for (int fd = 0; fd < 1024; ++fd) n += ::fcntl(fd, F_GETFD) != -1;
+            return n;
+        };
+        std::vector<char> header = image;
+        header[0] ^= 0x55;
+        write_bad(header);
+        const std::size_t fds_before = open_fds();
+        bool threw = false;
+        try {
+            CaptureReader reader(bad);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        success = success && threw && open_fds() == fds_before;
+        ::unlink(bad.c_str());
+    }
+
+    // Trailer'sız (yarım yazılmış) dosya: indeks blok başlıklarından kurulur
+    if (success) {
+        struct stat st{};
+        ::stat(path.c_str(), &st);
+        std::uint64_t last_block = 0;
+        {
+            CaptureReader reader(path);
+            last_block = reader.index().back().offset;
+        }
+        success = ::truncate(path.c_str(), static_cast<off_t>(last_block + 100)) == 0;
+        CaptureReader reader(path);
+        success = success && reader.index_rebuilt() && reader.block_count() == (count + 63) / 64 - 1;
+    }
+    ::unlink(path.c_str());
+
+    // Yazma hatası (ENOSPC): constructor fırlatır ve fd sızmaz
+    {
+        const int probe = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        ::close(probe);
+        bool threw = false;
+        try {
+            CaptureWriter writer("/dev/full", source);
+        } catch (const std::system_error&) {
+            threw = true;
+        }
+        const int after = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        ::close(after);
+        success = success && threw && after == probe;
+    }
+    results.report("test_capture_index_seek_and_replay", success, success ? "" : "Capture index/replay mismatch");
+}
+
+void test_sample_codec_roundtrip_and_stage() {
+    bool success = true;
+    // Kenar boyutlar + yavaş değişen / tam aralık / uç değer sinyaller
+    std::uint32_t state = 12345;
+    auto next = [&]() { state = state * 1664525u + 1013904223u; return state >> 8; };
+    for (std::size_t n : {0u, 1u, 7u, 127u, 128u, 129u, 1000u}) {
+        for (int kind = 0; kind < 3 && success; ++kind) {
+            std::vector<short> x(n), y(n);
+            int v = 0;
+            for (auto& e : x) {
+                if (kind == 0) v += static_cast<int>(next() % 17) - 8;
+                else if (kind == 1) v = static_cast<short>(next());
+                else v = (next() & 1) ? 32767 : -32768;
+                e = static_cast<short>(v);
+            }
+            std::vector<std::uint8_t> enc(SampleCodec::max_encoded_bytes(n));
+            const std::size_t bytes = SampleCodec::encode(x.data(), n, enc.data());
+            const auto got = SampleCodec::decode(enc.data(), bytes, y.data(), n);
+            success = got && *got == n && x == y && bytes <= enc.size();
+            // Yavaş değişen sinyal (|d| <= 8 -> 5 bit) belirgin şekilde küçülmeli
+            if (kind == 0 && n == 1000) success = success && bytes * 3 < n * sizeof(short);
+        }
+    }
+    // Kısa/bozuk girdi reddedilir
+    std::vector<short> sink(8);
+    const std::uint8_t bogus[6] = {8, 0, 0, 0, 17, 0};
+    success = success && !SampleCodec::decode(bogus, sizeof(bogus), sink.data(), sink.size());
+
+    // Pipeline: raw -> Encode -> encoded -> Decode -> decoded
+    constexpr std::size_t chunk = 512;   // 256 örnek
+    CircularBuffer raw(8, chunk), encoded(8, SampleCodec::max_encoded_bytes(chunk / 2)), decoded(8, chunk);
+    CodecStage enc_stage(raw, encoded, CodecStage::Mode::Encode);
+    CodecStage dec_stage(encoded, decoded, CodecStage::Mode::Decode);
+    int base = 0;
+    for (int c = 0; c < 20 && success; ++c) {
+        auto t = raw.claim_producer();
+        for (std::size_t i = 0; i < chunk / 2; ++i) t->gpu_ptr[i] = static_cast<short>(base + static_cast<int>(i % 7));
+        *t->size_ptr = c == 19 ? 10 * sizeof(short) : chunk;
+        *t->rf = {c, 1.5};
+        raw.commit_producer(*t);
+        success = enc_stage.pump() == 1 && dec_stage.pump() == 1;
+        auto out = decoded.claim_consumer();
+        // Son chunk kısa: sadece *size_ptr kadar örnek kodlanır
+        const std::size_t samples = c == 19 ? 10 : chunk / 2;
+        success = success && out && out->rf->first == c && *out->size_ptr == samples * sizeof(short);
+        for (std::size_t i = 0; success && i < samples; ++i) {
+            success = out->gpu_ptr[i] == static_cast<short>(base + static_cast<int>(i % 7));
+        }
+        if (out) decoded.release_consumer(*out);
+        base += 100;
+    }
+    // Boş chunk (count = 0 başlığı) hata değildir
+    if (auto t = raw.claim_producer()) {
+        *t->size_ptr = 0;
+        raw.commit_producer(*t);
+        success = success && enc_stage.pump() == 1 && dec_stage.pump() == 1;
+        auto out = decoded.claim_consumer();
+        success = success && out && *out->size_ptr == 0;
+        if (out) decoded.release_consumer(*out);
+    }
+    success = success && enc_stage.stats().errors == 0 && dec_stage.stats().errors == 0 &&
+              enc_stage.ratio() < 0.6;
+    // Bozuk *size_ptr chunk dışına okutmaz: chunk_size'a kırpılır; başlığın
+    // istediği bloklar 16 baytlık chunk'a sığmadığı için hata sayılır
+    CircularBuffer tiny(4, 16);
+    CodecStage tiny_stage(tiny, decoded, CodecStage::Mode::Decode);
+    if (auto t = tiny.claim_producer()) {
+        const std::uint32_t count = chunk / 2;
+        std::memcpy(t->cpu_ptr, &count, sizeof(count));
+        std::memset(t->cpu_ptr + sizeof(count), 16, tiny.chunk_size() - sizeof(count));
+        *t->size_ptr = std::size_t{1} << 20;
+        tiny.commit_producer(*t);
+        success = success && tiny_stage.pump() == 1 && tiny_stage.stats().errors == 1 &&
+                  tiny_stage.stats().encoded_bytes == tiny.chunk_size();
+        auto out = decoded.claim_consumer();
+        success = success && out && *out->size_ptr == 0;
+        if (out) decoded.release_consumer(*out);
+    }
+    results.report("test_sample_codec_roundtrip_and_stage", success, success ? "" : "Codec round trip failed");
+}
+
+void test_checksum_detects_corruption() {
+    bool success = true;
+    std::string detail;
+    // Standart test vektörü + farklı uzunluklarda skaler referansla uyum
+    success = crc32c("123456789", 9) == 0xE3069283u;
+    std::vector<unsigned char> data(5000);
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<unsigned char>(i * 131 + 7);
+    for (std::size_t n : {0u, 1u, 7u, 8u, 767u, 768u, 769u, 4096u, 5000u}) {
+        success = success && crc32c_update(~0u, data.data(), n) ==
+                             crc32c_detail::update_scalar(~0u, data.data(), n);
+    }
+    if (!success) detail = std::string("crc32c mismatch (") + crc32c_impl_name() + ")";
+
+    // Commit'te hesaplanır; commit sonrası bozulan chunk claim'de yakalanır
+    constexpr std::size_t chunk = 4096;
+    BufferOptions options;
+    options.checksum = true;
+    options.verify_on_claim = true;
+    CircularBuffer buffer(8, chunk, options);
+    for (int i = 0; i < 4 && success; ++i) {
+        auto t = buffer.claim_producer();
+        std::memset(t->cpu_ptr, i, chunk);
+        *t->size_ptr = chunk - i;
+        *t->rf = {i, i * 0.5};
+        success = t->crc_ptr != nullptr && buffer.commit_producer(*t);
+    }
+    if (success) {
+        auto first = buffer.claim_consumer();
+        buffer.release_consumer(*first);
+        success = buffer.checksum_mismatches() == 0 && buffer.checksum_verified() == 1;
+    }
+    if (success) {
+        // Slot 1'in payload'ı commit'ten sonra bozulur -> batch claim'de yakalanır
+        buffer.chunk_storage()[1 * chunk + 100] ^= 0x40;
+        CircularBuffer::Ticket rest[3];
+        const std::size_t n = buffer.claim_consumer_batch(rest, 3);
+        success = n == 3 && buffer.checksum_mismatches() == 1 && buffer.checksum_verified() == 4;
+        // rf de kapsanır
+        rest[1].rf->first ^= 1;
+        success = success && !buffer.verify_checksum(rest[1]) && buffer.checksum_mismatches() == 2;
+        rest[1].rf->first ^= 1;
+        success = success && buffer.verify_checksum(rest[1]) && buffer.verify_checksum(rest[2]);
+        for (auto& t : rest) buffer.release_consumer(t);
+        if (!success) detail = "corruption not detected";
+    }
+
+    // Recorder: claim'de doğrulama kapalıysa kendisi doğrular ve sayar
+    if (success) {
+        BufferOptions ropt;
+        ropt.checksum = true;
+        CircularBuffer rbuf(8, chunk, ropt);
+        const std::string path = "/tmp/mpmc_crc_test_" + std::to_string(::getpid()) + ".bin";
+        Recorder::Config config;
+        config.use_io_uring = false;
+        Recorder recorder(rbuf, path, config);
+        for (int i = 0; i < 3; ++i) {
+            auto t = rbuf.claim_producer();
+            std::memset(t->cpu_ptr, i, chunk);
+            *t->size_ptr = chunk;
+            rbuf.commit_producer(*t);
+            if (i == 1) t->cpu_ptr[0] ^= 1;
+        }
+        while (recorder.stats().chunks < 3) recorder.pump();
+        success = recorder.stats().checksum_errors == 1 && recorder.stats().errors == 0;
+        ::unlink(path.c_str());
+        if (!success) detail = "recorder checksum_errors wrong";
+    }
+    results.report("test_checksum_detects_corruption", success, success ? "" : detail);
+}
+
+void test_topology_placements() {
+    // Sahte sysfs: 2 soket x 2 çekirdek x 2 SMT (Linux numaralandırması:
+    // kardeşler i ve i+4; soket 0 = 0,1,4,5), soket başına L3 ve NUMA düğümü
+    const std::string root = "/tmp/mpmc_topo_" + std::to_string(::getpid());
+    auto put = [](const std::string& path, const std::string& text) {
+        std::system(("mkdir -p " + path.substr(0, path.rfind('/'))).c_str());
+        std::ofstream(path) << text << "\n";
+    };
+    const char* l3[2] = {"0-1,4-5", "2-3,6-7"};
+    put(root + "/cpu/online", "0-7");
+    put(root + "/node/possible", "0-1");
+    put(root + "/node/node0/cpulist", l3[0]);
+    put(root + "/node/node1/cpulist", l3[1]);
+    for (int c = 0; c < 8; ++c) {
+        const std::string dir = root + "/cpu/cpu" + std::to_string(c);
+        const int pkg = (c % 4) / 2;
+        put(dir + "/topology/physical_package_id", std::to_string(pkg));
+        put(dir + "/topology/thread_siblings_list", std::to_string(c % 4) + "," + std::to_string(c % 4 + 4));
+        put(dir + "/cache/index0/level", "1");
+        put(dir + "/cache/index0/type", "Instruction");
+        put(dir + "/cache/index0/shared_cpu_list", "0");
+        put(dir + "/cache/index1/level", "3");
+        put(dir + "/cache/index1/type", "Unified");
+        put(dir + "/cache/index1/shared_cpu_list", l3[pkg]);
+    }
+    put(root + "/single/online", "0");
+    // Tek sayıda kardeşli çekirdek: {0,1,2} ve {4,5}
+    put(root + "/odd/online", "0-2,4-5");
+    for (int c : {0, 1, 2, 4, 5}) {
+        put(root + "/odd/cpu" + std::to_string(c) + "/topology/thread_siblings_list", c < 3 ? "0-2" : "4-5");
+    }
+
+    bool success = true;
+    std::vector<int> list;
+    success = parse_cpu_list("0-2,5,7-8\n", list) && list == std::vector<int>{0, 1, 2, 5, 7, 8} &&
+              !parse_cpu_list("3-1", list);
+
+    const CpuTopology topo(root + "/cpu", false);
+    success = success && topo.cpus().size() == 8 && topo.cores().size() == 4 &&
+              topo.l3_domains().size() == 2 && topo.packages().size() == 2 && topo.numa_nodes().size() == 2 &&
+              topo.cpus()[6].node == 1 && topo.cpus()[6].core == 2;
+
+    auto same_core = topo.placement(Placement::SameCore, 2, 2);
+    success = success && same_core && *same_core == std::vector<int>{0, 1, 4, 5};  // P0/C0 = 0/4, P1/C1 = 1/5
+    // Çiftler çekirdek içinde kalır: P1/C1 = 4/5 (2/4 değil)
+    const CpuTopology odd(root + "/odd", false);
+    auto odd_core = odd.placement(Placement::SameCore, 2, 2);
+    success = success && odd.cores().size() == 2 && odd_core && *odd_core == std::vector<int>{0, 4, 1, 5};
+    auto same_l3 = topo.placement(Placement::SameL3, 1, 1);
+    success = success && same_l3 && *same_l3 == std::vector<int>{0, 1};
+    auto cross = topo.placement(Placement::CrossSocket, 2, 1);
+    success = success && cross && *cross == std::vector<int>{0, 1, 2};
+    auto none = topo.placement(Placement::None, 1, 1);
+    success = success && none && none->empty();
+
+    // Tek CPU: hiçbir yerleşim karşılanamaz
+    const CpuTopology single(root + "/single", false);
+    success = success && single.cpus().size() == 1 && !single.placement(Placement::SameCore, 1, 1) &&
+              !single.placement(Placement::SameL3, 1, 1) && !single.placement(Placement::CrossSocket, 1, 1);
+
+    std::system(("rm -rf " + root).c_str());
+    results.report("test_topology_placements", success, success ? "" : "Topology/placement mismatch");
+}
+
+void test_online_resize_no_loss() {
+    bool success = true;
+    std::string detail;
+
+    // Tek thread: item'lar büyütme/küçültmede sırasıyla korunur; sığmayan küçültme reddedilir
+    {
+        BufferOptions options;
+        options.resizable = true;
+        options.sequence_tracking = true;
+        CircularBuffer buffer(16, 32, options);
+        for (std::uint64_t i = 0; i < 10; ++i) {
+            auto t = buffer.claim_producer();
+            std::memcpy(t->cpu_ptr, &i, sizeof(i));
+            *t->seq_ptr = i;
+            buffer.commit_producer(*t);
+        }
+        // Bir item tüketilip head ilerletilir: taşıma pos & mask ile yapılır
+        auto first = buffer.claim_consumer();
+        buffer.release_consumer(*first);
+        success = !buffer.resize(8) && buffer.capacity() == 16 &&
+                  buffer.resize(64) && buffer.capacity() == 64 &&
+                  buffer.resize(9) && buffer.capacity() == 16;
+        // claim edilip bırakılan batch kapıyı tıkamaz
+        CircularBuffer::Ticket spare[2];
+        const std::size_t n = buffer.claim_producer_batch(spare, 2);
+        for (std::size_t i = 0; i < n; ++i) buffer.abandon_producer(spare[i]);
+        success = success && n == 2 && buffer.resize(16);
+        for (std::uint64_t i = 1; i < 10 && success; ++i) {
+            auto t = buffer.claim_consumer();
+            std::uint64_t v = 0;
+            if (t) std::memcpy(&v, t->cpu_ptr, sizeof(v));
+            success = t && v == i && *t->seq_ptr == i;
+            if (t) buffer.release_consumer(*t);
+        }
+        // Yeniden yazılabilir: 16 slot'un tamamı dolar
+        for (int i = 0; i < 16 && success; ++i) {
+            auto t = buffer.claim_producer();
+            success = t && buffer.commit_producer(*t);
+        }
+        success = success && !buffer.claim_producer() && buffer.resize(16);
+        if (!success) detail = "single-thread migrate failed";
+
+        CircularBuffer fixed(8, 32);
+        success = success && !fixed.resize(16) && fixed.capacity() == 8;
+    }
+
+    // Eşzamanlı: 2P/2C çalışırken kapasite sürekli değişir; her item tam bir kez
+    if (success) {
+        constexpr int producers = 2;
+        constexpr int consumers = 2;
+        constexpr std::uint32_t per_producer = 20000;
+        BufferOptions options;
+        options.resizable = true;
+        options.consumer_wait = WaitStrategy::Yield;
+        options.producer_wait = WaitStrategy::Yield;
+        CircularBuffer buffer(4, 16, options);
+
+        std::atomic<int> producers_done{0};
+        std::vector<std::vector<std::uint8_t>> seen(consumers * producers,
+                                                    std::vector<std::uint8_t>(per_producer, 0));
+        std::atomic<bool> order_ok{true};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (std::uint32_t i = 0; i < per_producer;) {
+                    auto t = buffer.claim_producer_wait();
+                    if (!t) break;
+                    const std::uint32_t v[2] = {static_cast<std::uint32_t>(p), i};
+                    std::memcpy(t->cpu_ptr, v, sizeof(v));
+                    buffer.commit_producer(*t);
+                    ++i;
+                }
+                producers_done.fetch_add(1);
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&, c] {
+                std::int64_t last[producers] = {-1, -1};
+                while (auto t = buffer.claim_consumer_wait()) {
+                    std::uint32_t v[2];
+                    std::memcpy(v, t->cpu_ptr, sizeof(v));
+                    buffer.release_consumer(*t);
+                    if (v[0] >= producers || v[1] >= per_producer) { order_ok = false; continue; }
+                    // Tek consumer bir producer'ın item'larını artan sırada görür
+                    if (static_cast<std::int64_t>(v[1]) <= last[v[0]]) order_ok = false;
+                    last[v[0]] = v[1];
+                    ++seen[c * producers + v[0]][v[1]];
+                }
+            });
+        }
+        std::size_t grown = 0, shrunk = 0, refused = 0;
+        const std::size_t sizes[] = {64, 8, 256, 4, 1024, 2, 32};
+        for (std::size_t k = 0; producers_done.load() < producers; ++k) {
+            const std::size_t before = buffer.capacity();
+            const std::size_t target = sizes[k % 7];
+            if (!buffer.resize(target)) ++refused;
+            else if (target > before) ++grown;
+            else if (target < before) ++shrunk;
+            std::this_thread::yield();
+        }
+        buffer.stop();
+        for (auto& t : threads) t.join();
+
+        for (int p = 0; p < producers && success; ++p) {
+            for (std::uint32_t i = 0; i < per_producer && success; ++i) {
+                int total = 0;
+                for (int c = 0; c < consumers; ++c) total += seen[c * producers + p][i];
+                success = total == 1;
+            }
+        }
+        success = success && order_ok && grown > 0 && shrunk > 0 && buffer.size_approx() == 0;
+        if (!success) {
+            detail = "concurrent resize lost/duplicated items (grown=" + std::to_string(grown) +
+                     " shrunk=" + std::to_string(shrunk) + " refused=" + std::to_string(refused) + ")";
+        }
+    }
+    results.report("test_online_resize_no_loss", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 29: Memory trim - boş slot sayfaları iade edilir, dolu item'lar korunur
+// ============================================================================
+// mincore ile chunk sayfalarının RSS'te olup olmadığı okunur: trim sonrası
+// boş slot sayfaları yerleşik değildir, dolu slot'lar ve keep_slots sıcak
+// kalır. Eşzamanlı kısımda agresif trim altında payload'lar bozulmamalı.
+// ============================================================================
+void test_memory_trim_idle_slots() {
+    bool success = true;
+    std::string detail;
+    constexpr std::size_t kPage = 4096;
+
+    auto resident = [](char* p, std::size_t pages) {
+        std::vector<unsigned char> vec(pages);
+        std::size_t n = 0;
+        if (::mincore(p, pages * kPage, vec.data()) != 0) return std::size_t(0);
+        for (auto v : vec) n += v & 1;
+        return n;
+    };
+
+    {
+        BufferOptions options;
+        options.trimmable = true;
+        options.data_alignment = kPage;
+        CircularBuffer buffer(16, kPage, options);
+        char* base = buffer.chunk_storage();
+
+        // Tüm chunk'lara dokun, sonra 4 item bırakıp gerisini tüket
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < 16; ++i) {
+                auto t = buffer.claim_producer();
+                std::memset(t->cpu_ptr, 0x40 + i, kPage);
+                buffer.commit_producer(*t);
+            }
+            for (int i = 0; i < (round == 0 ? 16 : 12); ++i) {
+                auto t = buffer.claim_consumer();
+                buffer.release_consumer(*t);
+            }
+        }
+        // Şimdi head = 28, tail = 32: dolu index'ler 12..15, boş 0..11
+        const std::size_t before = resident(base, 16);
+        // keep 2 -> index 0..1 sıcak, 2..11 iade edilir (3'er slot'luk adımlarla)
+        const std::size_t advised = buffer.trim_idle(2, 3);
+        const std::size_t after_free = resident(base + 2 * kPage, 10);
+        const std::size_t after_keep = resident(base, 2) + resident(base + 12 * kPage, 4);
+        success = before == 16 && advised >= 10 * kPage && after_free == 0 && after_keep == 6 &&
+                  buffer.trims() == 1;
+        for (int i = 12; i < 16 && success; ++i) {
+            auto t = buffer.claim_consumer();
+            success = t && static_cast<unsigned char>(t->cpu_ptr[0]) == 0x40 + i &&
+                      static_cast<unsigned char>(t->cpu_ptr[kPage - 1]) == 0x40 + i;
+            if (t) buffer.release_consumer(*t);
+        }
+        // Sıcak slot eski içeriğini korur; bırakılan slot sıfır sayfa olarak döner
+        for (int i = 0; i < 3 && success; ++i) {
+            auto t = buffer.claim_producer();
+            success = t && static_cast<unsigned char>(t->cpu_ptr[0]) == (i < 2 ? 0x40 + i : 0);
+            if (t) buffer.commit_producer(*t);
+        }
+        if (!success) detail = "idle slot pages not released or items damaged";
+
+        CircularBuffer plain(4, kPage);
+        success = success && plain.trim_idle() == 0;
+
+    }
+
+    // Pin'li depolama (kayıtlı buffer'lı Recorder) trim/resize edilmez
+    if (success) {
+        BufferOptions options;
+        options.trimmable = true;
+        options.resizable = true;
+        options.data_alignment = kPage;
+        CircularBuffer buffer(8, kPage, options);
+        for (int i = 0; i < 8; ++i) {
+            auto t = buffer.claim_producer();
+            std::memset(t->cpu_ptr, 1, kPage);
+            buffer.commit_producer(*t);
+            buffer.release_consumer(*buffer.claim_consumer());
+        }
+        MemoryTrimmer::Config config;
+        config.idle_period = std::chrono::milliseconds(0);
+        MemoryTrimmer trimmer(buffer, config);
+        buffer.pin_storage();
+        success = buffer.storage_pinned() && buffer.trim_idle() == 0 && !buffer.resize(16) &&
+                  !trimmer.poll() && trimmer.stats().pinned_skips == 1 &&
+                  resident(buffer.chunk_storage(), 8) == 8;
+        buffer.unpin_storage();
+        success = success && !buffer.storage_pinned() && buffer.trim_idle() > 0;
+        if (!success) detail = "pinned storage trimmed or resized";
+    }
+
+    // MemoryTrimmer: yüksek dolulukta trim yok, idle_period sonrası var
+    if (success) {
+        BufferOptions options;
+        options.trimmable = true;
+        CircularBuffer buffer(16, 256, options);
+        MemoryTrimmer::Config config;
+        config.low_watermark = 0.25;
+        config.idle_period = std::chrono::milliseconds(10);
+        config.keep_slots = 0;
+        MemoryTrimmer trimmer(buffer, config);
+        for (int i = 0; i < 8; ++i) buffer.commit_producer(*buffer.claim_producer());
+        const auto t0 = MemoryTrimmer::Clock::now();
+        success = !trimmer.poll(t0) && !trimmer.poll(t0 + std::chrono::milliseconds(50));
+        for (int i = 0; i < 8; ++i) buffer.release_consumer(*buffer.claim_consumer());
+        success = success && !trimmer.poll(t0 + std::chrono::milliseconds(60)) &&
+                  trimmer.poll(t0 + std::chrono::milliseconds(70)) &&
+                  !trimmer.poll(t0 + std::chrono::milliseconds(75)) &&
+                  trimmer.poll(t0 + std::chrono::milliseconds(80)) && trimmer.stats().trims == 2;
+        if (!success) detail = "trimmer watermark/idle logic wrong";
+    }
+
+    // Eşzamanlı: 1P/1C akarken arka plan trimmer'ı sürekli trim eder
+    if (success) {
+        BufferOptions options;
+        options.trimmable = true;
+        options.data_alignment = kPage;
+        options.producer_wait = WaitStrategy::Yield;
+        options.consumer_wait = WaitStrategy::Yield;
+        CircularBuffer buffer(32, kPage, options);
+        MemoryTrimmer::Config config;
+        config.low_watermark = 1.0;
+        config.idle_period = std::chrono::milliseconds(0);
+        config.interval = std::chrono::milliseconds(0);
+        config.keep_slots = 0;
+        MemoryTrimmer trimmer(buffer, config);
+        trimmer.start();
+
+        constexpr std::uint32_t items = 20000;
+        std::atomic<bool> payload_ok{true};
+        std::thread producer([&] {
+            for (std::uint32_t i = 0; i < items; ++i) {
+                auto t = buffer.claim_producer_wait();
+                if (!t) break;
+                std::memset(t->cpu_ptr, static_cast<int>(i & 0xFF), kPage);
+                std::memcpy(t->cpu_ptr, &i, sizeof(i));
+                buffer.commit_producer(*t);
+            }
+        });
+        std::uint32_t next = 0;
+        std::thread consumer([&] {
+            while (next < items) {
+                auto t = buffer.claim_consumer_wait(std::chrono::milliseconds(500));
+                if (!t) break;
+                std::uint32_t v = 0;
+                std::memcpy(&v, t->cpu_ptr, sizeof(v));
+                if (v != next || static_cast<unsigned char>(t->cpu_ptr[kPage - 1]) != (next & 0xFF)) {
+                    payload_ok = false;
+                }
+                buffer.release_consumer(*t);
+                ++next;
+            }
+        });
+        producer.join();
+        consumer.join();
+        trimmer.stop();
+        success = payload_ok && next == items && trimmer.stats().trims > 0;
+        if (!success) {
+            detail = "payload damaged under concurrent trim (consumed=" + std::to_string(next) +
+                     " trims=" + std::to_string(trimmer.stats().trims) + ")";
+        }
+    }
+    results.report("test_memory_trim_idle_slots", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 30: Trace - halka, stall katlama, dump ve Chrome JSON
+// ============================================================================
+// Kayıt halkası ve dışa aktarım MPMC_TRACE'ten bağımsız test edilir;
+// MPMC_TRACE ile derlenmişse CircularBuffer kancaları da kontrol edilir.
+// ============================================================================
+void test_trace_export_chrome_json() {
+    using namespace mpmc_trace;
+    bool success = true;
+    std::string detail;
+
+    // Producer: claim/commit x3, sonra aynı pos'ta 5 kez full (tek kayda katlanır)
+    ThreadLog producer(101, "producer-0", 64);
+    for (std::size_t pos = 0; pos < 3; ++pos) {
+        producer.append(Event::ProducerClaim, 0, pos, 1);
+        producer.append(Event::Commit, 0, pos, 1);
+    }
+    for (int i = 0; i < 5; ++i) producer.append(Event::Full, 0, 3, 1);
+    producer.append(Event::ProducerClaim, 0, 3, 1);
+    // Consumer: batch claim x3, release'ler; sonra bırakılmayan bir claim
+    ThreadLog consumer(102, "consumer \"0\"", 64);
+    consumer.append(Event::Empty, 0, 0, 1);
+    consumer.append(Event::ConsumerClaim, 0, 0, 3);
+    for (std::size_t pos = 0; pos < 3; ++pos) consumer.append(Event::Release, 0, pos, 1);
+
+    Dump dump;
+    dump.ticks_per_us = 1000.0;
+    dump.threads = {producer.snapshot(), consumer.snapshot()};
+    const auto& precs = dump.threads[0].records;
+    success = precs.size() == 8 && precs[6].event == static_cast<std::uint8_t>(Event::Full) &&
+              precs[6].count == 5 && dump.threads[1].records.size() == 5;
+    if (!success) detail = "record/coalescing wrong";
+
+    // Halka taşması: en eski kayıtlar düşer, sıra korunur
+    ThreadLog small(103, "small", 4);
+    for (std::size_t pos = 0; pos < 10; ++pos) small.append(Event::Release, 1, pos, 1);
+    const auto sd = small.snapshot();
+    success = success && sd.dropped == 6 && sd.records.size() == 4 && sd.records.front().pos == 6 &&
+              sd.records.back().pos == 9;
+    if (!success && detail.empty()) detail = "ring overflow wrong";
+
+    // İkili dump gidiş-dönüş
+    const std::string path = "/tmp/mpmc_trace_test.bin";
+    Dump loaded;
+    success = success && write_dump(dump, path) && read_dump(path, loaded) && loaded.threads.size() == 2 &&
+              loaded.threads[1].name == "consumer \"0\"" && loaded.threads[0].records.size() == 8 &&
+              loaded.threads[0].records[6].count == 5 && loaded.ticks_per_us == 1000.0;
+    // Bozuk kayıt sayısı (ilk thread'in count alanı, offset 40) dev ayırma yerine false döner
+    if (std::FILE* f = std::fopen(path.c_str(), "r+b")) {
+        const std::uint64_t huge = std::uint64_t{1} << 60;
+        std::fseek(f, 40, SEEK_SET);
+        std::fwrite(&huge, sizeof(huge), 1, f);
+        std::fclose(f);
+        Dump corrupt;
+        success = success && !read_dump(path, corrupt);
+    }
+    std::remove(path.c_str());
+    if (!success && detail.empty()) detail = "dump roundtrip failed";
+
+    // Chrome JSON: dilimler, batch, stall, flow ve açık claim
+    std::ostringstream json;
+    write_chrome_json(loaded, json);
+    const std::string j = json.str();
+    auto count = [&](const std::string& needle) {
+        std::size_t n = 0;
+        for (auto at = j.find(needle); at != std::string::npos; at = j.find(needle, at + 1)) ++n;
+        return n;
+    };
+    success = success && j.rfind("{\"displayTimeUnit\"", 0) == 0 && j.find("\n]}") != std::string::npos &&
+              count("\"name\":\"produce\"") == 3 && count("\"name\":\"consume x3\"") == 1 &&
+              count("\"produce (open)\"") == 1 && count("\"polls\":5") == 1 &&
+              count("\"ph\":\"s\"") == 3 && count("\"ph\":\"f\"") == 3 &&
+              count("consumer \\\"0\\\"") == 1;
+    if (!success && detail.empty()) detail = "chrome json content wrong";
+
+#ifdef MPMC_TRACE
+    // Buffer kancaları: ayrı bir thread'in halkasında olay sırası
+    if (success) {
+        std::uint32_t tid = 0;
+        std::thread([&] {
+            tid = current_tid();
+            CircularBuffer buffer(2, 64);
+            for (int i = 0; i < 3; ++i) {
+                if (auto t = buffer.claim_producer()) buffer.commit_producer(*t);
+            }
+            while (auto t = buffer.claim_consumer()) buffer.release_consumer(*t);
+        }).join();
+        std::vector<std::uint8_t> events;
+        for (const auto& t : Registry::instance().snapshot().threads) {
+            if (t.tid != tid) continue;
+            for (const auto& r : t.records) events.push_back(r.event);
+        }
+        auto ev = [](Event e) { return static_cast<std::uint8_t>(e); };
+        const std::vector<std::uint8_t> expect = {
+            ev(Event::ProducerClaim), ev(Event::Commit), ev(Event::ProducerClaim), ev(Event::Commit),
+            ev(Event::Full), ev(Event::ConsumerClaim), ev(Event::Release), ev(Event::ConsumerClaim),
+            ev(Event::Release), ev(Event::Empty)};
+        success = events == expect;
+        if (!success) detail = "buffer hooks emitted unexpected events";
+    }
+#endif
+    results.report("test_trace_export_chrome_json", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 31: PerfCounters - izinsiz/PMU'suz ortamda zarif geri dönüş
+// ============================================================================
+// Her sayaç ya açılır ve değer verir ya da nullopt + reason(). Context
+// switch (yazılım sayacı) açıldıysa inherit ile sonradan oluşturulan
+// thread'in uykuları sayılmalıdır.
+// ============================================================================
+void test_perf_counters_degrade() {
+    bool success = true;
+    std::string detail;
+
+    PerfCounters counters;
+    std::thread sleeper;
+    counters.start();
+    sleeper = std::thread([] {
+        for (int i = 0; i < 5; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    sleeper.join();
+    const auto sample = counters.stop();
+
+    bool all = true;
+    for (int c = 0; c < PerfCounters::kCount; ++c) {
+        const auto k = static_cast<PerfCounters::Counter>(c);
+        all = all && counters.available(k);
+        if (counters.available(k) != sample[k].has_value() || (sample[k] && *sample[k] < 0)) {
+            success = false;
+            detail = std::string("inconsistent counter ") + PerfCounters::counter_name(k);
+        }
+    }
+    // Biri açılamadıysa neden verilmeli
+    if (success && !all && counters.reason().empty()) {
+        success = false;
+        detail = "missing reason for unavailable counter";
+    }
+    if (success && sample[PerfCounters::ContextSwitches] && *sample[PerfCounters::ContextSwitches] < 5) {
+        success = false;
+        detail = "inherited thread context switches not counted";
+    }
+    results.report("test_perf_counters_degrade", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 32: consume_batch + prefetch - sıra, release ve her mesafede doğruluk
+// ============================================================================
+void test_consume_batch_prefetch() {
+    bool success = true;
+    std::string detail;
+    for (std::size_t d : {0u, 1u, 3u, 100u}) {
+        BufferOptions options;
+        options.prefetch_distance = d;
+        options.prefetch_bytes = 4096;           // chunk'tan büyük: kırpılır
+        CircularBuffer buffer(8, 64, options);
+        std::uint32_t next_write = 0, next_read = 0;
+        for (int round = 0; round < 20 && success; ++round) {
+            // Ring'i sararak doldur (claim_producer prefetch'i pos + d'ye)
+            while (auto t = buffer.claim_producer()) {
+                std::memcpy(t->cpu_ptr, &next_write, sizeof(next_write));
+                buffer.commit_producer(*t);
+                ++next_write;
+            }
+            const std::size_t max = 1 + round % 5;
+            std::size_t n = buffer.consume_batch(max, [&](const CircularBuffer::Ticket& t) {
+                std::uint32_t v = 0;
+                std::memcpy(&v, t.cpu_ptr, sizeof(v));
+                success = success && v == next_read;
+                ++next_read;
+            });
+            success = success && n == max && buffer.size_approx() == 8 - max;
+        }
+        while (buffer.consume_batch(64, [&](const CircularBuffer::Ticket&) { ++next_read; })) {
+        }
+        success = success && next_read == next_write && buffer.size_approx() == 0 &&
+                  buffer.consume_batch(4, [](const CircularBuffer::Ticket&) {}) == 0;
+        if (!success) {
+            detail = "order/count wrong at prefetch_distance=" + std::to_string(d);
+            break;
+        }
+    }
+    results.report("test_consume_batch_prefetch", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 33: Streaming store yazımı (stream_copy / write_chunk)
+// ============================================================================
+// stream_copy hizasız hedef/kaynak ofsetleri ve 0..300 bayt boyutlarında
+// memcpy ile aynı sonucu vermeli, [dst, dst+n) dışına dokunmamalı.
+// write_chunk eşiğin altı/üstü boyutlarda payload'ı ve size'ı yazmalı;
+// checksum + verify_on_claim ile başka thread'deki consumer commit'ten
+// sonra NT store'ların tamamını görmeli (commit_producer sfence'i).
+// ============================================================================
+void test_streaming_store_write() {
+    bool success = true;
+    std::string detail;
+
+    std::vector<unsigned char> src(512), dst(512);
+    for (std::size_t i = 0; i < src.size(); ++i) src[i] = static_cast<unsigned char>(i * 7 + 3);
+    for (std::size_t off = 0; off < 32 && success; ++off) {
+        for (std::size_t n = 0; n <= 300 && success; ++n) {
+            std::fill(dst.begin(), dst.end(), 0xEE);
+            stream_copy(dst.data() + off, src.data() + (n % 5), n);
+            stream_fence();
+            for (std::size_t i = 0; i < dst.size(); ++i) {
+                const bool inside = i >= off && i < off + n;
+                const unsigned char want = inside ? src[i - off + n % 5] : 0xEE;
+                if (dst[i] != want) {
+                    success = false;
+                    detail = "stream_copy mismatch off=" + std::to_string(off) + " n=" + std::to_string(n);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (success) {
+        BufferOptions options;
+        options.streaming_store_threshold = 256;
+        options.checksum = true;
+        options.verify_on_claim = true;
+        constexpr std::size_t chunk = 4096;
+        CircularBuffer buffer(16, chunk, options);
+        const std::size_t sizes[] = {0, 1, 255, 256, 257, 1000, 4095, 4096, 5000};
+        constexpr int kItems = 2000;
+        std::vector<unsigned char> payload(8192);
+        for (std::size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<unsigned char>(i ^ (i >> 8));
+
+        std::thread producer([&] {
+            for (int i = 0; i < kItems;) {
+                auto t = buffer.claim_producer();
+                if (!t) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const std::size_t n = sizes[i % std::size(sizes)];
+                // Ofset: kaynağı her item'da kaydır (hizasız yükler)
+                buffer.write_chunk(*t, payload.data() + i % 61, n);
+                *t->rf = {i, 0.0};
+                buffer.commit_producer(*t);
+                ++i;
+            }
+        });
+        int received = 0;
+        while (received < kItems && success) {
+            auto t = buffer.claim_consumer();
+            if (!t) {
+                std::this_thread::yield();
+                continue;
+            }
+            const int i = t->rf->first;
+            const std::size_t want = std::min(sizes[i % std::size(sizes)], chunk);
+            if (i != received || *t->size_ptr != want ||
+                std::memcmp(t->cpu_ptr, payload.data() + i % 61, want) != 0) {
+                success = false;
+                detail = "write_chunk payload wrong at item " + std::to_string(received);
+            }
+            buffer.release_consumer(*t);
+            ++received;
+        }
+        producer.join();
+        if (success && buffer.checksum_mismatches() != 0) {
+            success = false;
+            detail = "checksum mismatches: " + std::to_string(buffer.checksum_mismatches());
+        }
+    }
+    results.report("test_streaming_store_write", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 34: Commit zamanı + TTL ve bayat item'ların toplu atlanması
+// ============================================================================
+// skip_expired ilk taze item'da durur (süresiz item'lar hiç bayatlamaz),
+// atlanan slot'lar producer'lara geri döner. 1P/2C akışta (resizable kapı
+// açık) her item ya tüketilir ya atlanır, tam bir kez; sonunda resize
+// kapısı boşalır.
+// ============================================================================
+void test_expiry_skip_stale_items() {
+    bool success = true;
+    std::string detail;
+    using namespace std::chrono_literals;
+
+    {
+        BufferOptions options;
+        options.expiry = true;
+        options.item_ttl = 100us;
+        CircularBuffer buffer(32, 16, options);
+        const std::uint64_t before = CircularBuffer::steady_now_ns();
+        for (int i = 0; i < 20; ++i) {
+            auto t = buffer.claim_producer();
+            t->rf->first = i;
+            if (i >= 10 && i < 15) buffer.commit_producer(*t, 0ns);   // Süresiz
+            else buffer.commit_producer(*t);
+        }
+        const std::uint64_t after = CircularBuffer::steady_now_ns();
+        // Henüz bayat değil
+        if (buffer.skip_expired(before) != 0) {
+            success = false;
+            detail = "skipped fresh items";
+        }
+        const std::size_t skipped = buffer.skip_expired(after + 1'000'000'000ull);
+        auto t = buffer.claim_consumer();
+        if (success && (skipped != 10 || !t || t->rf->first != 10 || buffer.expired_skipped() != 10 ||
+                        t->expiry->ttl_ns != 0 || t->expiry->commit_ns < before ||
+                        t->expiry->commit_ns > after)) {
+            success = false;
+            detail = "skip_expired stopped at wrong slot (skipped " + std::to_string(skipped) + ")";
+        }
+        if (t) buffer.release_consumer(*t);
+        // Atlanan slot'lar tekrar yazılabilir: 9 dolu item, 23 boş slot
+        std::size_t free_slots = 0;
+        while (auto p = buffer.claim_producer()) {
+            buffer.commit_producer(*p);
+            ++free_slots;
+        }
+        if (success && free_slots != 23) {
+            success = false;
+            detail = "skipped slots not reusable: " + std::to_string(free_slots);
+        }
+        // 4 süresiz item head'te: hiçbir zaman atlanmaz
+        if (success && buffer.skip_expired(after + 1'000'000'000'000ull) != 0) {
+            success = false;
+            detail = "skipped item without ttl";
+        }
+    }
+
+    if (success) {
+        BufferOptions options;
+        options.expiry = true;
+        options.item_ttl = 20us;
+        options.resizable = true;
+        CircularBuffer buffer(256, 16, options);
+        constexpr int kItems = 200000;
+        std::vector<std::atomic<int>> seen(kItems);
+        std::atomic<int> consumed{0};
+        std::atomic<bool> done{false};
+        std::thread producer([&] {
+            for (int i = 0; i < kItems;) {
+                auto t = buffer.claim_producer();
+                if (!t) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                t->rf->first = i;
+                buffer.commit_producer(*t);
+                ++i;
+            }
+        });
+        std::vector<std::thread> consumers;
+        for (int c = 0; c < 2; ++c) {
+            consumers.emplace_back([&, c] {
+                int n = 0;
+                while (!done.load(std::memory_order_acquire) || buffer.size_approx() != 0) {
+                    // Consumer 1 yavaş: bayat item'lar birikir
+                    if (c == 1 && ++n % 64 == 0) std::this_thread::sleep_for(50us);
+                    buffer.skip_expired();
+                    if (auto t = buffer.claim_consumer()) {
+                        seen[t->rf->first].fetch_add(1, std::memory_order_relaxed);
+                        buffer.release_consumer(*t);
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        producer.join();
+        done.store(true, std::memory_order_release);
+        for (auto& t : consumers) t.join();
+
+        const std::uint64_t total = static_cast<std::uint64_t>(consumed.load()) + buffer.expired_skipped();
+        int duplicates = 0;
+        for (auto& v : seen) duplicates += v.load() > 1;
+        if (total != kItems || duplicates != 0) {
+            success = false;
+            detail = "consumed " + std::to_string(consumed.load()) + " + skipped " +
+                     std::to_string(buffer.expired_skipped()) + ", duplicates " + std::to_string(duplicates);
+        } else if (!buffer.resize(512)) {
+            success = false;
+            detail = "resize failed after skip_expired (gate leak?)";
+        }
+    }
+    results.report("test_expiry_skip_stale_items", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 35: AggregateStage pencereli kanal özetleri
+// ============================================================================
+// Tek kanal, kanal başına burst ve round-robin akışlarında (SIMD ve skaler)
+// özetler referans hesapla aynı olmalı; pencere ring sarmasından bağımsız
+// (window_items 2'nin kuvveti değil), aralık dışı kanallar sayılıp atlanır,
+// küçük çıktı ring'inde geri basınçla hiçbir özet kaybolmaz.
+// ============================================================================
+void test_aggregate_stage_windows() {
+    bool success = true;
+    std::string detail;
+    constexpr std::size_t kItems = 5000;
+    constexpr std::size_t kWindow = 300;
+    constexpr int kChannels = 5;
+
+    auto channel_of = [](int pattern, std::size_t i) {
+        if (pattern == 0) return 3;
+        if (pattern == 1) return static_cast<int>((i / 37) % kChannels);
+        if (i % 97 == 0) return 9999;   // Aralık dışı
+        return static_cast<int>(i % kChannels);
+    };
+    auto value_of = [](std::size_t i) { return 1e6 + std::sin(0.1 * static_cast<double>(i)) * 50.0 + (i % 7); };
+
+    for (int pattern = 0; pattern < 3 && success; ++pattern) {
+        for (int simd = 0; simd < 2 && success; ++simd) {
+            CircularBuffer in(64, 16);
+            CircularBuffer out(4, sizeof(WindowSummary));
+            AggregateStage::Config config;
+            config.window_items = kWindow;
+            config.max_channels = 16;
+            config.simd = simd != 0;
+            AggregateStage stage(in, out, config);
+
+            // Referans: (pencere, kanal) -> değerler
+            std::map<std::pair<std::uint64_t, int>, std::vector<double>> ref;
+            std::size_t dropped = 0;
+            for (std::size_t i = 0; i < kItems; ++i) {
+                const int ch = channel_of(pattern, i);
+                if (ch >= 16) ++dropped;
+                else ref[{i / kWindow, ch}].push_back(value_of(i));
+            }
+
+            std::vector<WindowSummary> got;
+            std::size_t produced = 0;
+            auto drain_out = [&] {
+                while (auto t = out.claim_consumer()) {
+                    WindowSummary s;
+                    std::memcpy(&s, t->cpu_ptr, sizeof(s));
+                    got.push_back(s);
+                    out.release_consumer(*t);
+                }
+            };
+            while (produced < kItems) {
+                while (produced < kItems) {
+                    auto t = in.claim_producer();
+                    if (!t) break;
+                    *t->rf = {channel_of(pattern, produced), value_of(produced)};
+                    in.commit_producer(*t);
+                    ++produced;
+                }
+                stage.pump(1000);
+                drain_out();
+            }
+            while (stage.pump(1000) || stage.pending()) drain_out();
+            while (!stage.flush()) drain_out();
+            drain_out();
+
+            const auto& st = stage.stats();
+            if (got.size() != ref.size() || st.dropped != dropped || st.items != kItems ||
+                (simd && pattern < 2 && st.simd_items == 0 && aggregate_detail::has_avx2())) {
+                success = false;
+                detail = "pattern " + std::to_string(pattern) + ": " + std::to_string(got.size()) + " summaries vs " +
+                         std::to_string(ref.size()) + ", dropped " + std::to_string(st.dropped);
+                break;
+            }
+            for (const auto& s : got) {
+                auto it = ref.find({s.window, s.channel});
+                if (it == ref.end()) {
+                    success = false;
+                    detail = "unexpected summary";
+                    break;
+                }
+                const auto& v = it->second;
+                double mn = v[0], mx = v[0], sum = 0;
+                for (double x : v) {
+                    mn = std::min(mn, x);
+                    mx = std::max(mx, x);
+                    sum += x;
+                }
+                const double mean = sum / v.size();
+                double var = 0;
+                for (double x : v) var += (x - mean) * (x - mean);
+                var /= v.size();
+                if (s.count != v.size() || s.min != mn || s.max != mx || std::abs(s.mean - mean) > 1e-6 ||
+                    std::abs(s.variance - var) > 1e-6 * std::max(1.0, var)) {
+                    success = false;
+                    detail = "pattern " + std::to_string(pattern) + (simd ? " simd" : " scalar") + ": window " +
+                             std::to_string(s.window) + " channel " + std::to_string(s.channel) + " mismatch";
+                    break;
+                }
+            }
+        }
+    }
+    results.report("test_aggregate_stage_windows", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 36: FirStage FIR + seyreltme
+// ============================================================================
+// İki kanal chunk'ları araya girerek akar; chunk uzunluğu (250 örnek) D'nin
+// katı değil, tap sayıları 16'nın katı değil. Her kanalın çıktısı tüm
+// akış üzerinde doğrudan hesaplanan referansla, SIMD ve skaler yol
+// birbiriyle bit-bit aynı olmalı. Sığmayan çıktı chunk'ı errors'ta sayılır.
+// ============================================================================
+void test_fir_stage_decimation() {
+    bool success = true;
+    std::string detail;
+    constexpr std::size_t kChunk = 250;   // short
+    constexpr int kChunksPerChannel = 12;
+
+    auto sample = [](int ch, std::size_t i) {
+        const double x = 12000.0 * std::sin(0.013 * static_cast<double>(i) * (ch + 1)) +
+                         3000.0 * std::sin(0.9 * static_cast<double>(i)) + static_cast<double>((i * 7919) % 601) - 300;
+        return static_cast<short>(x);
+    };
+
+    const std::pair<std::size_t, std::size_t> configs[] = {{1, 1}, {21, 4}, {64, 8}, {37, 3}, {16, 16}};
+    std::vector<short> previous;   // Önceki (skaler) çalışmanın çıktısı
+    for (const auto& [tap_count, dec] : configs) {
+        std::vector<short> taps = FirDecimator::lowpass_taps(tap_count, 0.45 / static_cast<double>(dec));
+        taps[0] = static_cast<short>(taps[0] - 123);   // Simetrik değil: ters çevirme hatası görünür
+        for (int simd = 0; simd < 2 && success; ++simd) {
+            CircularBuffer in(8, kChunk * sizeof(short));
+            CircularBuffer out(8, kChunk * sizeof(short));
+            FirStage stage(in, out, taps, dec, simd != 0);
+            std::vector<short> got[2];
+            std::size_t next[2] = {0, 0};
+            int sent = 0;
+            while (sent < 2 * kChunksPerChannel) {
+                while (sent < 2 * kChunksPerChannel) {
+                    auto t = in.claim_producer();
+                    if (!t) break;
+                    const int ch = sent % 2;
+                    for (std::size_t i = 0; i < kChunk; ++i) t->gpu_ptr[i] = sample(ch, next[ch] + i);
+                    *t->size_ptr = kChunk * sizeof(short);
+                    next[ch] += kChunk;
+                    *t->rf = {ch, 0.0};
+                    in.commit_producer(*t);
+                    ++sent;
+                }
+                stage.pump();
+                while (auto t = out.claim_consumer()) {
+                    const std::size_t n = *t->size_ptr / sizeof(short);
+                    got[t->rf->first].insert(got[t->rf->first].end(), t->gpu_ptr, t->gpu_ptr + n);
+                    out.release_consumer(*t);
+                }
+            }
+            while (stage.pump()) {
+                while (auto t = out.claim_consumer()) {
+                    const std::size_t n = *t->size_ptr / sizeof(short);
+                    got[t->rf->first].insert(got[t->rf->first].end(), t->gpu_ptr, t->gpu_ptr + n);
+                    out.release_consumer(*t);
+                }
+            }
+
+            std::vector<short> all;
+            for (int ch = 0; ch < 2 && success; ++ch) {
+                const std::size_t total = kChunk * kChunksPerChannel;
+                const std::size_t expected = (total + dec - 1) / dec;
+                if (got[ch].size() != expected) {
+                    success = false;
+                    detail = "taps " + std::to_string(tap_count) + " D=" + std::to_string(dec) + ": " +
+                             std::to_string(got[ch].size()) + " outputs, expected " + std::to_string(expected);
+                    break;
+                }
+                for (std::size_t m = 0; m < expected; ++m) {
+                    std::int64_t acc = 0;
+                    for (std::size_t k = 0; k < tap_count; ++k) {
+                        const std::size_t idx = m * dec;
+                        if (idx >= k) acc += static_cast<std::int64_t>(taps[k]) * sample(ch, idx - k);
+                    }
+                    const std::int64_t y = std::clamp<std::int64_t>((acc + (1 << 14)) >> 15, -32768, 32767);
+                    if (got[ch][m] != y) {
+                        success = false;
+                        detail = std::string(simd ? "simd" : "scalar") + " taps " + std::to_string(tap_count) +
+                                 " D=" + std::to_string(dec) + " ch " + std::to_string(ch) + " output " +
+                                 std::to_string(m) + " = " + std::to_string(got[ch][m]) + ", expected " +
+                                 std::to_string(y);
+                        break;
+                    }
+                }
+                all.insert(all.end(), got[ch].begin(), got[ch].end());
+            }
+            if (success && simd && all != previous) {
+                success = false;
+                detail = "simd and scalar outputs differ";
+            }
+            previous = all;
+            if (success && (stage.stats().errors != 0 || stage.stats().in_samples != 2 * kChunk * kChunksPerChannel)) {
+                success = false;
+                detail = "stage stats wrong";
+            }
+        }
+        if (!success) break;
+    }
+
+    // Çıktı chunk'ı max_output'tan küçük: chunk sayılır, örnek yazılmaz
+    if (success) {
+        CircularBuffer in(4, 64 * sizeof(short));
+        CircularBuffer out(4, 8 * sizeof(short));
+        FirStage stage(in, out, {16384, 16384}, 2);
+        auto t = in.claim_producer();
+        *t->size_ptr = in.chunk_size();
+        in.commit_producer(*t);
+        stage.pump();
+        auto o = out.claim_consumer();
+        success = o && *o->size_ptr == 0 && stage.stats().errors == 1;
+        if (o) out.release_consumer(*o);
+        if (!success) detail = "undersized output chunk not reported";
+    }
+    results.report("test_fir_stage_decimation", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 37: FftStage güç spektrumu
+// ============================================================================
+// 4..2048 noktada (tek/çift log2) ve farklı batch boylarında SIMD ve skaler
+// spektrum naif double DFT ile aynı olmalı. Stage rf/seq/size'ı taşır, kısa
+// chunk'ları sıfır dolgulu referansla aynı işler; geçersiz boy reddedilir.
+// ============================================================================
+void test_fft_stage_power_spectrum() {
+    bool success = true;
+    std::string detail;
+
+    auto sample = [](std::size_t chunk, std::size_t t) {
+        const double x = 9000.0 * std::sin(0.37 * static_cast<double>(t) + static_cast<double>(chunk)) +
+                         4000.0 * std::cos(1.9 * static_cast<double>(t)) +
+                         static_cast<double>((t * 7919 + chunk * 104729) % 2001) - 1000;
+        return static_cast<short>(x);
+    };
+    // Naif çift duyarlıklı DFT (pencereli, 1/32768 ölçekli)
+    auto reference = [](const std::vector<short>& x) {
+        const std::size_t n = x.size();
+        const double pi = std::numbers::pi;
+        std::vector<double> p(n / 2 + 1);
+        for (std::size_t k = 0; k <= n / 2; ++k) {
+            double re = 0, im = 0;
+            for (std::size_t t = 0; t < n; ++t) {
+                const double w = (0.5 - 0.5 * std::cos(2 * pi * static_cast<double>(t) / static_cast<double>(n))) / 32768.0;
+                const double a = -2 * pi * static_cast<double>(k * t % n) / static_cast<double>(n);
+                re += x[t] * w * std::cos(a);
+                im += x[t] * w * std::sin(a);
+            }
+            p[k] = re * re + im * im;
+        }
+        return p;
+    };
+
+    // Plan: her boy (tek/çift log2), her batch doluluğu, simd ve skaler
+    for (std::size_t n : {4, 8, 32, 256, 2048}) {
+        std::vector<std::vector<short>> in(FftPlan::kBatch, std::vector<short>(n));
+        std::vector<std::vector<double>> ref(FftPlan::kBatch);
+        for (std::size_t b = 0; b < FftPlan::kBatch; ++b) {
+            for (std::size_t t = 0; t < n; ++t) in[b][t] = sample(b, t);
+            ref[b] = reference(in[b]);
+        }
+        for (int simd = 0; simd < 2 && success; ++simd) {
+            FftPlan plan(n, simd != 0);
+            for (std::size_t count : {std::size_t{1}, std::size_t{5}, FftPlan::kBatch}) {
+                std::vector<std::vector<float>> out(count, std::vector<float>(plan.bins(), -1.0f));
+                const short* src[FftPlan::kBatch];
+                float* dst[FftPlan::kBatch];
+                for (std::size_t b = 0; b < count; ++b) {
+                    src[b] = in[b].data();
+                    dst[b] = out[b].data();
+                }
+                plan.power_spectrum(src, count, dst);
+                for (std::size_t b = 0; b < count && success; ++b) {
+                    const double peak = *std::max_element(ref[b].begin(), ref[b].end());
+                    for (std::size_t k = 0; k < plan.bins(); ++k) {
+                        if (std::abs(out[b][k] - ref[b][k]) > 1e-4 * peak + 1e-9) {
+                            success = false;
+                            detail = std::string(simd ? "simd" : "scalar") + " n=" + std::to_string(n) + " chunk " +
+                                     std::to_string(b) + " bin " + std::to_string(k) + " = " +
+                                     std::to_string(out[b][k]) + ", expected " + std::to_string(ref[b][k]);
+                            break;
+                        }
+                    }
+                }
+                if (!success) break;
+            }
+        }
+        if (!success) break;
+    }
+
+    // Stage: 11 chunk (bir tam + bir kısmi batch), rf/seq taşınır; her üçüncü
+    // chunk kısa (*size_ptr < n örnek): kalanı yok sayılır, sıfırla doldurulur
+    if (success) {
+        constexpr std::size_t kN = 64;
+        BufferOptions options;
+        options.sequence_tracking = true;
+        CircularBuffer in(16, 100 * sizeof(short), options);
+        CircularBuffer out(16, (kN / 2 + 1) * sizeof(float), options);
+        FftStage stage(in, out, kN);
+        FftPlan plan(kN, false);
+        for (std::size_t c = 0; c < 11; ++c) {
+            auto t = in.claim_producer();
+            for (std::size_t i = 0; i < in.shorts_per_chunk(); ++i) t->gpu_ptr[i] = sample(c, i);
+            *t->size_ptr = c % 3 == 2 ? (kN / 2 + c) * sizeof(short) : in.chunk_size();
+            *t->rf = {static_cast<int>(c), 0.5 * static_cast<double>(c)};
+            *t->seq_ptr = 100 + c;
+            in.commit_producer(*t);
+        }
+        const std::size_t done = stage.pump();
+        std::size_t c = 0;
+        while (auto t = out.claim_consumer()) {
+            std::vector<short> x(kN);
+            const std::size_t valid = c % 3 == 2 ? kN / 2 + c : kN;
+            for (std::size_t i = 0; i < valid; ++i) x[i] = sample(c, i);
+            std::vector<float> want(plan.bins());
+            const short* src[1] = {x.data()};
+            float* dst[1] = {want.data()};
+            plan.power_spectrum(src, 1, dst);
+            const auto* got = reinterpret_cast<const float*>(t->cpu_ptr);
+            const double peak = *std::max_element(want.begin(), want.end());
+            bool same = *t->size_ptr == plan.bins() * sizeof(float) && t->rf->first == static_cast<int>(c) &&
+                        *t->seq_ptr == 100 + c;
+            for (std::size_t k = 0; k < plan.bins() && same; ++k) same = std::abs(got[k] - want[k]) <= 1e-5 * peak;
+            out.release_consumer(*t);
+            if (!same) {
+                success = false;
+                detail = "stage output " + std::to_string(c) + " wrong";
+                break;
+            }
+            ++c;
+        }
+        if (success && (done != 11 || c != 11 || stage.stats().batches != 2 || stage.stats().errors != 0)) {
+            success = false;
+            detail = "stage processed " + std::to_string(done) + " chunks, read " + std::to_string(c) + ", batches " +
+                     std::to_string(stage.stats().batches);
+        }
+    }
+
+    // Geçersiz boy / küçük çıktı chunk'ı reddedilir
+    if (success) {
+        bool threw = false;
+        try {
+            FftPlan bad(48);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CircularBuffer in(4, 64 * sizeof(short));
+        CircularBuffer out(4, 16 * sizeof(float));
+        try {
+            FftStage bad(in, out, 64);
+            threw = false;
+        } catch (const std::invalid_argument&) {
+        }
+        if (!threw) {
+            success = false;
+            detail = "invalid fft configuration accepted";
+        }
+    }
+    results.report("test_fft_stage_power_spectrum", success, success ? "" : detail);
+}
+
+// ============================================================================
+// TEST 38: DetectStage eşik/tepe olayları
+// ============================================================================
+// İki kanallı gürültü + bilinen burst akışında (chunk sınırını aşan, hold
+// boşluklu, -32768 tepeli, flush ile kapanan) SIMD ve skaler olaylar
+// referans run'larla aynı olmalı. Küçük olay ring'inde geri basınç, küçük
+// olay chunk'ının reddi ve gürültü artışında eşik uyumu da denetlenir.
+// ============================================================================
+void test_detect_stage_events() {
+    bool success = true;
+    std::string detail;
+    constexpr std::size_t kChunk = 1000;   // short (16'nın katı değil: kuyruk yolu)
+    constexpr std::size_t kChunksPerChannel = 10;
+    constexpr std::size_t kHold = 4;
+
+    // Kanal başına akış: ±200 gürültü + bilinen burst'ler (|x| >= 3000)
+    std::vector<short> stream[2];
+    std::uint32_t lcg = 12345;
+    for (int ch = 0; ch < 2; ++ch) {
+        stream[ch].resize(kChunk * kChunksPerChannel);
+        for (auto& x : stream[ch]) {
+            lcg = lcg * 1664525u + 1013904223u;
+            x = static_cast<short>(static_cast<int>(lcg >> 16) % 401 - 200);
+        }
+    }
+    auto burst = [&](int ch, std::size_t at, std::size_t len, int amp) {
+        for (std::size_t k = 0; k < len; ++k) {
+            const int v = amp + 10 * static_cast<int>(k);
+            stream[ch][at + k] = static_cast<short>((k % 2) ? -std::min(v, 32768) : std::min(v, 32767));
+        }
+    };
+    burst(0, 1500, 40, 3000);           // Tek burst
+    burst(0, 2990, 25, 4000);           // Chunk sınırını aşar
+    burst(0, 5000, 28, 3000);           // Blok sonunda tam hold'luk boşluk: tek run
+    burst(0, 5032, 10, 3500);
+    burst(0, 5500, 5, 3000);            // 3 örneklik boşluk: tek run
+    burst(0, 5508, 5, 3000);
+    burst(0, 6000, 10, 3000);           // 6 örneklik boşluk (> hold): iki run
+    burst(0, 6016, 10, 3000);
+    burst(1, 4100, 3, 32760);           // -32768 tepe
+    burst(1, 9990, 10, 5000);           // Akış sonunda açık: flush ile
+    // Referans: |x| > 1000 run'ları (her eşik 200 < T < 3000 aynı sonucu verir)
+    auto reference = [&](int ch) {
+        std::vector<PeakEvent> events;
+        const auto& x = stream[ch];
+        bool active = false;
+        PeakEvent e{};
+        std::uint64_t last = 0;
+        int peak_mag = 0;
+        for (std::uint64_t p = 0; p < x.size(); ++p) {
+            const int a = std::min(std::abs(static_cast<int>(x[p])), 32767);
+            if (a <= 1000) continue;
+            if (active && p - last - 1 > kHold) {
+                e.duration = static_cast<std::uint32_t>(last - e.offset + 1);
+                events.push_back(e);
+                active = false;
+            }
+            if (!active) {
+                e = PeakEvent{};
+                e.offset = p;
+                e.channel = ch;
+                peak_mag = -1;
+                active = true;
+            }
+            last = p;
+            if (a > peak_mag) {
+                peak_mag = a;
+                e.peak = x[p];
+                e.peak_offset = static_cast<std::uint32_t>(p - e.offset);
+            }
+        }
+        if (active) {
+            e.duration = static_cast<std::uint32_t>(last - e.offset + 1);
+            events.push_back(e);
+        }
+        return events;
+    };
+
+    for (int simd = 0; simd < 2 && success; ++simd) {
+        CircularBuffer in(8, kChunk * sizeof(short));
+        CircularBuffer out(2, sizeof(PeakEvent));   // Küçük: geri basınç
+        DetectStage::Config config;
+        config.hold = kHold;
+        config.simd = simd != 0;
+        DetectStage stage(in, out, config);
+        std::vector<PeakEvent> got[2];
+        auto drain = [&] {
+            while (auto t = out.claim_consumer()) {
+                PeakEvent e;
+                std::memcpy(&e, t->cpu_ptr, sizeof(e));
+                if (*t->size_ptr != sizeof(e) || t->rf->first != e.channel) e.channel = -1;
+                if (e.channel == 0 || e.channel == 1) got[e.channel].push_back(e);
+                out.release_consumer(*t);
+            }
+        };
+        std::size_t sent = 0;
+        while (sent < 2 * kChunksPerChannel) {
+            while (sent < 2 * kChunksPerChannel) {
+                auto t = in.claim_producer();
+                if (!t) break;
+                const int ch = static_cast<int>(sent % 2);
+                std::memcpy(t->gpu_ptr, stream[ch].data() + (sent / 2) * kChunk, kChunk * sizeof(short));
+                *t->size_ptr = kChunk * sizeof(short);
+                *t->rf = {ch, 0.0};
+                in.commit_producer(*t);
+                ++sent;
+            }
+            stage.pump();
+            drain();
+        }
+        while (stage.pump() || !stage.flush() || stage.pending()) drain();
+        drain();
+
+        for (int ch = 0; ch < 2 && success; ++ch) {
+            const auto want = reference(ch);
+            bool same = got[ch].size() == want.size();
+            for (std::size_t k = 0; k < want.size() && same; ++k) {
+                same = got[ch][k].offset == want[k].offset && got[ch][k].duration == want[k].duration &&
+                       got[ch][k].peak == want[k].peak && got[ch][k].peak_offset == want[k].peak_offset &&
+                       got[ch][k].threshold > 200 && got[ch][k].threshold < 3000;
+            }
+            if (!same) {
+                success = false;
+                detail = std::string(simd ? "simd" : "scalar") + " ch " + std::to_string(ch) + ": " +
+                         std::to_string(got[ch].size()) + " events, expected " + std::to_string(want.size());
+            }
+        }
+        // Taban: ±200 düzgün gürültüde ortalama |x| ~100; eşik ~600
+        if (success && (std::abs(stage.noise_floor(0) - 100.0) > 15.0 || stage.threshold(0) != std::lround(6.0 * stage.noise_floor(0)) ||
+                        stage.stats().errors != 0 || stage.stats().out_full == 0 ||
+                        stage.stats().samples != 2 * kChunk * kChunksPerChannel)) {
+            success = false;
+            detail = "floor " + std::to_string(stage.noise_floor(0)) + ", threshold " +
+                     std::to_string(stage.threshold(0)) + ", out_full " + std::to_string(stage.stats().out_full);
+        }
+    }
+
+    // Uyarlanır taban: gürültü 10x artınca eşik yükselir, yerleşince yanlış olay yok
+    if (success) {
+        CircularBuffer in(8, 512 * sizeof(short));
+        CircularBuffer out(256, sizeof(PeakEvent));
+        DetectStage stage(in, out);
+        std::uint64_t settled_events = 0;
+        for (int c = 0; c < 120; ++c) {
+            const int amp = c < 20 ? 100 : 1000;
+            auto t = in.claim_producer();
+            for (std::size_t i = 0; i < 512; ++i) {
+                lcg = lcg * 1664525u + 1013904223u;
+                t->gpu_ptr[i] = static_cast<short>(static_cast<int>(lcg >> 16) % (2 * amp + 1) - amp);
+            }
+            *t->size_ptr = 512 * sizeof(short);
+            *t->rf = {3, 0.0};
+            in.commit_producer(*t);
+            const std::uint64_t before = stage.stats().events;
+            stage.pump();
+            if (c >= 100) settled_events += stage.stats().events - before;
+            while (auto o = out.claim_consumer()) out.release_consumer(*o);
+        }
+        if (settled_events != 0 || stage.threshold(3) < 2500 || stage.threshold(-1) != 0) {
+            success = false;
+            detail = "adaptive floor: threshold " + std::to_string(stage.threshold(3)) + ", settled events " +
+                     std::to_string(settled_events);
+        }
+    }
+
+    // PeakEvent'e sığmayan olay chunk'ı reddedilir (kesik olay yazılmaz)
+    if (success) {
+        CircularBuffer in(4, 64 * sizeof(short));
+        CircularBuffer out(4, sizeof(PeakEvent) - 8);
+        bool threw = false;
+        try {
+            DetectStage bad(in, out);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        if (!threw) {
+            success = false;
+            detail = "undersized event chunk accepted";
+        }
+    }
+    results.report("test_detect_stage_events", success, success ? "" : detail);
+}
+
 int main() {
     std::cout << "========================================" << std::endl;
     std::cout << "MPMC Circular Buffer Test Suite" << std::endl;
@@ -233,6 +2592,37 @@ int main() {
     test_capacity_limit();
     test_thread_safety();
     test_commit_increments_tail();
+    test_sharded_fifo_per_producer();
+    test_sharded_work_stealing();
+    test_sequence_gap_detection();
+    test_sequence_reorder_detection();
+    test_lane_strict_priority();
+    test_lane_weighted_round_robin();
+    test_lane_concurrent_no_lost_items();
+    test_routed_per_key_fifo_with_rebalance();
+    test_routed_hot_keys();
+    test_routed_handoff_while_busy();
+    test_readiness_fd_edge_signalling();
+    test_wait_strategies_blocking_claims();
+    test_wait_park_stop_and_timeout();
+    test_udp_ingest_loopback();
+    test_recorder_writes_in_claim_order();
+    test_journal_survives_crash();
+    test_capture_index_seek_and_replay();
+    test_sample_codec_roundtrip_and_stage();
+    test_checksum_detects_corruption();
+    test_topology_placements();
+    test_online_resize_no_loss();
+    test_memory_trim_idle_slots();
+    test_trace_export_chrome_json();
+    test_perf_counters_degrade();
+    test_consume_batch_prefetch();
+    test_streaming_store_write();
+    test_expiry_skip_stale_items();
+    test_aggregate_stage_windows();
+    test_fir_stage_decimation();
+    test_fft_stage_power_spectrum();
+    test_detect_stage_events();
     
     results.summary();
     return (results.failed == 0) ? 0 : 1;
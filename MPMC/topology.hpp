@@ -0,0 +1,247 @@
+// ============================================================================
+// CpuTopology: /sys/devices/system/cpu'dan çekirdek, cache ve NUMA domain'leri
+// ============================================================================
+// Producer/consumer çiftinin aynı SMT kardeşinde, aynı L3'te veya farklı
+// soketlerde olması throughput'u ~3x değiştirir. Bu modül sysfs'ten şunları
+// okur ve taskset yerine hazır yerleşimler (Placement) sunar:
+//
+//   topology/core_id, physical_package_id   -> fiziksel çekirdek, soket
+//   cache/indexN/{level,type,shared_cpu_list}-> L2 / L3 domain'i
+//   ../node/nodeN/cpulist                   -> NUMA düğümü
+//
+// Domain kimliği, domain'deki en küçük CPU numarasıdır. Varsayılan olarak
+// sadece process'in affinity maskesindeki online CPU'lar dikkate alınır
+// (container/cgroup kısıtları).
+//
+// YERLEŞİMLER (thread listesi: önce producer'lar, sonra consumer'lar):
+//   SameCore   : producer i ve consumer i aynı çekirdeğin SMT kardeşlerinde
+//   SameL3     : Aynı L3'te farklı fiziksel çekirdekler, çekirdek başına bir thread
+//   CrossSocket: Producer'lar bir sokette, consumer'lar diğerinde
+// Topoloji yerleşimi karşılayamıyorsa (SMT yok, tek soket, ...) nullopt.
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+enum class Placement { None, SameCore, SameL3, CrossSocket };
+
+inline const char* placement_name(Placement p) {
+    switch (p) {
+        case Placement::None: return "none";
+        case Placement::SameCore: return "same-core";
+        case Placement::SameL3: return "same-l3";
+        case Placement::CrossSocket: return "cross-socket";
+    }
+    return "?";
+}
+
+inline std::optional<Placement> parse_placement(const std::string& s) {
+    for (auto p : {Placement::None, Placement::SameCore, Placement::SameL3, Placement::CrossSocket}) {
+        if (s == placement_name(p)) return p;
+    }
+    return std::nullopt;
+}
+
+// "0-3,8,10-11" biçimindeki CPU listesini çözer (sysfs ve --pin biçimi)
+inline bool parse_cpu_list(const std::string& s, std::vector<int>& out) {
+    std::size_t i = 0;
+    while (i < s.size() && s[i] != '\n') {
+        char* end = nullptr;
+        const long lo = std::strtol(s.c_str() + i, &end, 10);
+        if (end == s.c_str() + i || lo < 0) return false;
+        long hi = lo;
+        i = static_cast<std::size_t>(end - s.c_str());
+        if (i < s.size() && s[i] == '-') {
+            hi = std::strtol(s.c_str() + i + 1, &end, 10);
+            if (hi < lo) return false;
+            i = static_cast<std::size_t>(end - s.c_str());
+        }
+        for (long c = lo; c <= hi; ++c) out.push_back(static_cast<int>(c));
+        if (i < s.size() && s[i] == ',') ++i;
+        else if (i < s.size() && s[i] != '\n') return false;
+    }
+    return !out.empty();
+}
+
+// Çağıran thread'i tek CPU'ya pinler
+inline bool pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+class CpuTopology {
+public:
+    struct Cpu {
+        int id;
+        int core;        // Fiziksel çekirdek domain'i (SMT kardeşleri aynı)
+        int package;     // Soket
+        int node;        // NUMA düğümü (bilinmiyorsa 0)
+        int l2;          // L2 domain'i (-1: bilinmiyor)
+        int l3;          // L3 / LLC domain'i (-1: bilinmiyor)
+    };
+
+    explicit CpuTopology(const std::string& root = "/sys/devices/system/cpu",
+                         bool restrict_to_affinity = true) {
+        std::vector<int> online;
+        if (!parse_cpu_list(read(root + "/online"), online)) online = {0};
+        if (restrict_to_affinity) filter_affinity(online);
+
+        std::map<int, int> node_of;
+        std::vector<int> nodes;
+        if (parse_cpu_list(read(root + "/../node/possible"), nodes)) {
+            for (int n : nodes) {
+                std::vector<int> list;
+                if (!parse_cpu_list(read(root + "/../node/node" + std::to_string(n) + "/cpulist"), list)) continue;
+                for (int c : list) node_of[c] = n;
+            }
+        }
+
+        for (int c : online) {
+            const std::string dir = root + "/cpu" + std::to_string(c);
+            Cpu cpu{c, c, 0, 0, -1, -1};
+            cpu.package = read_int(dir + "/topology/physical_package_id", 0);
+            std::vector<int> siblings;
+            if (parse_cpu_list(read(dir + "/topology/thread_siblings_list"), siblings)) cpu.core = siblings.front();
+            if (auto it = node_of.find(c); it != node_of.end()) cpu.node = it->second;
+            for (int idx = 0;; ++idx) {
+                const std::string cache = dir + "/cache/index" + std::to_string(idx);
+                const int level = read_int(cache + "/level", -1);
+                if (level < 0) break;
+                if (read(cache + "/type").rfind("Instruction", 0) == 0) continue;
+                std::vector<int> shared;
+                if (!parse_cpu_list(read(cache + "/shared_cpu_list"), shared)) continue;
+                if (level == 2) cpu.l2 = shared.front();
+                if (level == 3) cpu.l3 = shared.front();
+            }
+            cpus_.push_back(cpu);
+        }
+        // L3 bilgisi yoksa (bazı VM'ler) soket LLC kabul edilir
+        for (auto& cpu : cpus_) {
+            if (cpu.l3 < 0) cpu.l3 = -2 - cpu.package;
+        }
+    }
+
+    const std::vector<Cpu>& cpus() const { return cpus_; }
+
+    // Domain listeleri: her biri CPU numaraları (artan)
+    std::vector<std::vector<int>> cores() const { return group([](const Cpu& c) { return c.core; }); }
+    std::vector<std::vector<int>> l3_domains() const { return group([](const Cpu& c) { return c.l3; }); }
+    std::vector<std::vector<int>> numa_nodes() const { return group([](const Cpu& c) { return c.node; }); }
+    std::vector<std::vector<int>> packages() const { return group([](const Cpu& c) { return c.package; }); }
+
+    // ========================================================================
+    // placement: producers + consumers thread'i için CPU listesi
+    // ========================================================================
+    // Sonuç: önce producer'ların, sonra consumer'ların CPU'su. Thread sayısı
+    // uygun CPU'dan fazlaysa liste başa sarar (oversubscription).
+    // None -> boş liste (pinning yok).
+    // ========================================================================
+    std::optional<std::vector<int>> placement(Placement p, int producers, int consumers) const {
+        const int total = producers + consumers;
+        std::vector<int> out;
+        if (p == Placement::None) return out;
+
+        if (p == Placement::SameCore) {
+            // (producer, consumer) çiftleri çekirdek içinde kurulur: her çekirdekten
+            // ikişer kardeş. Tek sayıda kardeşi olan çekirdekte (SMT4'te 3'ü
+            // affinity'de kalan gibi) artan thread kullanılmaz.
+            std::vector<std::pair<int, int>> pairs;
+            for (const auto& core : cores()) {
+                for (std::size_t k = 0; k + 1 < core.size(); k += 2) pairs.emplace_back(core[k], core[k + 1]);
+            }
+            if (pairs.empty()) return std::nullopt;
+            for (int i = 0; i < producers; ++i) out.push_back(pairs[i % pairs.size()].first);
+            for (int i = 0; i < consumers; ++i) out.push_back(pairs[i % pairs.size()].second);
+            return out;
+        }
+
+        if (p == Placement::SameL3) {
+            // En çok fiziksel çekirdeği olan L3; her çekirdekten ilk thread
+            std::vector<int> best;
+            for (const auto& l3 : l3_domains()) {
+                auto firsts = one_per_core(l3);
+                if (firsts.size() > best.size()) best = std::move(firsts);
+            }
+            if (best.size() < 2) return std::nullopt;
+            for (int i = 0; i < total; ++i) out.push_back(best[i % best.size()]);
+            return out;
+        }
+
+        // CrossSocket: producer'lar ilk, consumer'lar ikinci sokette (çekirdek başına bir)
+        const auto pkgs = packages();
+        if (pkgs.size() < 2) return std::nullopt;
+        const auto a = one_per_core(pkgs[0]);
+        const auto b = one_per_core(pkgs[1]);
+        for (int i = 0; i < producers; ++i) out.push_back(a[i % a.size()]);
+        for (int i = 0; i < consumers; ++i) out.push_back(b[i % b.size()]);
+        return out;
+    }
+
+    // Tek satırlık özet: "8 cpus, 4 cores, 1 L3, 1 socket, 1 node"
+    std::string describe() const {
+        return std::to_string(cpus_.size()) + " cpus, " + std::to_string(cores().size()) + " cores, " +
+               std::to_string(l3_domains().size()) + " L3, " + std::to_string(packages().size()) +
+               " socket, " + std::to_string(numa_nodes().size()) + " node";
+    }
+
+private:
+    static std::string read(const std::string& path) {
+        std::ifstream in(path);
+        std::string s;
+        std::getline(in, s);
+        return s;
+    }
+
+    static int read_int(const std::string& path, int fallback) {
+        const std::string s = read(path);
+        return s.empty() ? fallback : std::atoi(s.c_str());
+    }
+
+    static void filter_affinity(std::vector<int>& cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return;
+        cpus.erase(std::remove_if(cpus.begin(), cpus.end(),
+                                  [&](int c) { return c >= CPU_SETSIZE || !CPU_ISSET(c, &set); }),
+                   cpus.end());
+    }
+
+    // Listeden her fiziksel çekirdeğin ilk CPU'su (SMT kardeşleri atlanır)
+    std::vector<int> one_per_core(const std::vector<int>& list) const {
+        std::vector<int> firsts;
+        for (int c : list) {
+            if (std::none_of(firsts.begin(), firsts.end(), [&](int f) { return cpu(f).core == cpu(c).core; })) {
+                firsts.push_back(c);
+            }
+        }
+        return firsts;
+    }
+
+    const Cpu& cpu(int id) const {
+        return *std::find_if(cpus_.begin(), cpus_.end(), [&](const Cpu& c) { return c.id == id; });
+    }
+
+    template <typename Key>
+    std::vector<std::vector<int>> group(Key key) const {
+        std::map<int, std::vector<int>> m;
+        for (const auto& c : cpus_) m[key(c)].push_back(c.id);
+        std::vector<std::vector<int>> out;
+        for (auto& [k, v] : m) out.push_back(std::move(v));
+        return out;
+    }
+
+    std::vector<Cpu> cpus_;
+};
@@ -0,0 +1,460 @@
+// ============================================================================
+// Trace: Thread başına ikili olay kaydı ve Chrome/Perfetto JSON dışa aktarımı
+// ============================================================================
+// Throughput düştüğünde hangi thread'in claim, commit veya release'te
+// beklediğini görmek için. Derleme zamanında seçilir: MPMC_TRACE tanımlıysa
+// (cmake -DMPMC_TRACE=ON) CircularBuffer her claim/commit/release/full/empty
+// olayını çağıran thread'in özel halkasına ekler; tanımlı değilse kancalar
+// tamamen kaybolur (sıfır maliyet).
+//
+// KAYIT (16 bayt): TSC zaman damgası, slot pos'unun alt 32 biti, adet
+// (batch claim'de slot sayısı, full/empty'de ardışık deneme sayısı), olay
+// ve ring kimliği (buffer başına). Aynı pos'ta ardışık full/empty denemeleri
+// tek kayda katlanır; spin döngüsü halkayı doldurmaz.
+//
+// HALKA: Thread başına sabit boyut (varsayılan 64K kayıt = 1 MiB), sadece
+// sahibi yazar, doluysa en eskinin üzerine yazar (dropped sayılır). Kilit
+// veya paylaşılan cache line yok. Thread'in ilk olayında Registry'ye eklenir
+// ve process sonuna kadar yaşar (thread bittikten sonra da okunabilir).
+//
+// DIŞA AKTARIM:
+//   Registry::snapshot() -> Dump (TSC -> us kalibrasyonu dahil)
+//   write_dump/read_dump : İkili dosya (app --trace, trace_export girdisi)
+//   write_chrome_json    : Chrome trace event JSON (ui.perfetto.dev,
+//                          chrome://tracing). Thread başına iz:
+//     produce / consume : claim -> commit/release aralığı (X); batch claim
+//                         tek aralık ("consume x16")
+//     full / empty      : Bekleme aralığı, ilk denemeden thread'in bir
+//                         sonraki olayına kadar (args.polls)
+//     item akışı        : Producer commit'inden aynı slot'u claim eden
+//                         consumer'a ok (flow s/f)
+// Snapshot izlenen thread'ler dururken alınmalıdır (halkalar kilitsizdir).
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace mpmc_trace {
+
+#ifdef MPMC_TRACE
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+enum class Event : std::uint8_t {
+    ProducerClaim,   // count: claim edilen slot (batch'te > 1)
+    Commit,
+    CommitLost,      // commit_producer false (sırasız batch commit'i)
+    Abandon,
+    ConsumerClaim,   // count: claim edilen slot (batch'te > 1)
+    Release,
+    Full,            // Producer claim'i başarısız; count: ardışık deneme
+    Empty            // Consumer claim'i başarısız; count: ardışık deneme
+};
+
+inline const char* event_name(Event e) {
+    switch (e) {
+        case Event::ProducerClaim: return "producer-claim";
+        case Event::Commit: return "commit";
+        case Event::CommitLost: return "commit-lost";
+        case Event::Abandon: return "abandon";
+        case Event::ConsumerClaim: return "consumer-claim";
+        case Event::Release: return "release";
+        case Event::Full: return "full";
+        case Event::Empty: return "empty";
+    }
+    return "?";
+}
+
+struct Record {
+    std::uint64_t tsc;
+    std::uint32_t pos;      // Slot pos'unun alt 32 biti
+    std::uint16_t count;
+    std::uint8_t event;     // Event
+    std::uint8_t ring;      // Buffer kimliği (Registry::next_ring)
+};
+static_assert(sizeof(Record) == 16, "Record 16 bayt olmalı");
+
+// Zaman damgası: x86'da TSC (serileştirmesiz, ~20 döngü), diğerlerinde ns
+inline std::uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+#endif
+}
+
+inline std::uint32_t current_tid() { return static_cast<std::uint32_t>(::syscall(SYS_gettid)); }
+
+struct ThreadDump {
+    std::uint32_t tid = 0;
+    std::string name;
+    std::uint64_t dropped = 0;        // Halka taştığı için kaybolan en eski kayıtlar
+    std::vector<Record> records;      // Kronolojik
+};
+
+struct Dump {
+    double ticks_per_us = 1000.0;
+    std::vector<ThreadDump> threads;
+};
+
+// ============================================================================
+// ThreadLog: Tek thread'in kayıt halkası (tek yazar)
+// ============================================================================
+class ThreadLog {
+public:
+    ThreadLog(std::uint32_t tid, std::string name, std::size_t capacity) : tid_(tid), name_(std::move(name)) {
+        std::size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        records_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    void append(Event e, std::uint8_t ring, std::size_t pos, std::size_t count) {
+        const std::uint64_t n = written_.load(std::memory_order_relaxed);
+        const auto pos32 = static_cast<std::uint32_t>(pos);
+        const auto ev = static_cast<std::uint8_t>(e);
+        if ((e == Event::Full || e == Event::Empty) && n != 0) {
+            // Aynı pos'ta süren bekleme: son kayda katla
+            Record& last = records_[(n - 1) & mask_];
+            if (last.event == ev && last.ring == ring && last.pos == pos32) {
+                if (last.count != UINT16_MAX) ++last.count;
+                return;
+            }
+        }
+        const auto c = static_cast<std::uint16_t>(std::min<std::size_t>(count, UINT16_MAX));
+        records_[n & mask_] = Record{read_tsc(), pos32, c, ev, ring};
+        written_.store(n + 1, std::memory_order_release);
+    }
+
+    ThreadDump snapshot() const {
+        ThreadDump d;
+        d.tid = tid_;
+        d.name = name_;
+        const std::uint64_t n = written_.load(std::memory_order_acquire);
+        const std::uint64_t first = n > records_.size() ? n - records_.size() : 0;
+        d.dropped = first;
+        d.records.reserve(static_cast<std::size_t>(n - first));
+        for (std::uint64_t i = first; i < n; ++i) d.records.push_back(records_[i & mask_]);
+        return d;
+    }
+
+    void clear() { written_.store(0, std::memory_order_release); }
+    void set_name(std::string name) { name_ = std::move(name); }
+    std::uint32_t tid() const { return tid_; }
+
+private:
+    std::uint32_t tid_;
+    std::string name_;
+    std::vector<Record> records_;
+    std::size_t mask_{0};
+    std::atomic<std::uint64_t> written_{0};
+};
+
+// ============================================================================
+// Registry: Tüm thread halkaları ve TSC kalibrasyonu (process başına tek)
+// ============================================================================
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    // Çağıran thread'in halkası (ilk çağrıda oluşturulur)
+    static ThreadLog& local() {
+        thread_local ThreadLog* log = nullptr;
+        if (!log) log = instance().attach();
+        return *log;
+    }
+
+    // Sonradan oluşan halkaların kayıt sayısı (mevcutlar değişmez)
+    void set_capacity(std::size_t records) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = records;
+    }
+
+    // CircularBuffer başına kimlik (flow eşlemesi için; 256'da sarar)
+    std::uint8_t next_ring() { return static_cast<std::uint8_t>(rings_.fetch_add(1, std::memory_order_relaxed)); }
+
+    // ========================================================================
+    // snapshot: Tüm halkaların kopyası; TSC hızı registry ömrü boyunca
+    // ölçülür (en az 10 ms; gerekirse bekler)
+    // ========================================================================
+    Dump snapshot() const {
+        Dump d;
+        auto elapsed = std::chrono::steady_clock::now() - t0_;
+        if (elapsed < std::chrono::milliseconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+        }
+        const std::uint64_t tsc = read_tsc();
+        elapsed = std::chrono::steady_clock::now() - t0_;
+        d.ticks_per_us = static_cast<double>(tsc - tsc0_) /
+                         std::chrono::duration<double, std::micro>(elapsed).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& log : logs_) d.threads.push_back(log->snapshot());
+        return d;
+    }
+
+    // Tüm halkaları boşaltır (izlenen thread'ler dururken)
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& log : logs_) log->clear();
+    }
+
+    void rename(ThreadLog& log, std::string name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        log.set_name(std::move(name));
+    }
+
+private:
+    Registry() : tsc0_(read_tsc()), t0_(std::chrono::steady_clock::now()) {}
+
+    ThreadLog* attach() {
+        char name[32] = {};
+        ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+        std::lock_guard<std::mutex> lock(mutex_);
+        logs_.push_back(std::make_unique<ThreadLog>(current_tid(), name, capacity_));
+        return logs_.back().get();
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadLog>> logs_;
+    std::size_t capacity_{1 << 16};
+    std::atomic<unsigned> rings_{0};
+    std::uint64_t tsc0_;
+    std::chrono::steady_clock::time_point t0_;
+};
+
+// CircularBuffer kancaları buradan yazar
+inline void emit(Event e, std::uint8_t ring, std::size_t pos, std::size_t count = 1) {
+    Registry::local().append(e, ring, pos, count);
+}
+
+// Çağıran thread'e iz adı verir ("producer-0"); varsayılan pthread adı
+inline void name_thread(const std::string& name) { Registry::instance().rename(Registry::local(), name); }
+
+// ============================================================================
+// İkili dump: "MPMCTRC1", sürüm, thread sayısı, ticks_per_us; her thread
+// için tid, ad uzunluğu, dropped, kayıt sayısı, ad, kayıtlar
+// ============================================================================
+namespace detail {
+inline constexpr std::uint64_t kMagic = 0x3143525443504D4Dull;   // "MPMCTRC1"
+inline constexpr std::uint32_t kVersion = 1;
+
+template <typename T>
+bool put(std::FILE* f, const T& v) { return std::fwrite(&v, sizeof(v), 1, f) == 1; }
+template <typename T>
+bool get(std::FILE* f, T& v) { return std::fread(&v, sizeof(v), 1, f) == 1; }
+}  // namespace detail
+
+inline bool write_dump(const Dump& d, const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    using detail::put;
+    bool ok = put(f, detail::kMagic) && put(f, detail::kVersion) &&
+              put(f, static_cast<std::uint32_t>(d.threads.size())) && put(f, d.ticks_per_us);
+    for (const auto& t : d.threads) {
+        if (!ok) break;
+        ok = put(f, t.tid) && put(f, static_cast<std::uint32_t>(t.name.size())) && put(f, t.dropped) &&
+             put(f, static_cast<std::uint64_t>(t.records.size())) &&
+             std::fwrite(t.name.data(), 1, t.name.size(), f) == t.name.size() &&
+             std::fwrite(t.records.data(), sizeof(Record), t.records.size(), f) == t.records.size();
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+inline bool read_dump(const std::string& path, Dump& d) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    using detail::get;
+    std::uint64_t magic = 0;
+    std::uint32_t version = 0, threads = 0;
+    bool ok = get(f, magic) && magic == detail::kMagic && get(f, version) && version == detail::kVersion &&
+              get(f, threads) && get(f, d.ticks_per_us);
+    struct stat st{};
+    ok = ok && ::fstat(::fileno(f), &st) == 0;
+    d.threads.clear();
+    for (std::uint32_t i = 0; ok && i < threads; ++i) {
+        ThreadDump t;
+        std::uint32_t name_len = 0;
+        std::uint64_t count = 0;
+        ok = get(f, t.tid) && get(f, name_len) && get(f, t.dropped) && get(f, count) && name_len < 4096;
+        if (!ok) break;
+        t.name.resize(name_len);
+        ok = std::fread(t.name.data(), 1, name_len, f) == name_len;
+        // Bozuk/kısa dosyada count dev olabilir: ayırmadan önce kalan baytla sınırla
+        const long at = std::ftell(f);
+        ok = ok && at >= 0 && at <= st.st_size &&
+             count <= static_cast<std::uint64_t>(st.st_size - at) / sizeof(Record);
+        if (!ok) break;
+        t.records.resize(static_cast<std::size_t>(count));
+        ok = std::fread(t.records.data(), sizeof(Record), t.records.size(), f) == t.records.size();
+        d.threads.push_back(std::move(t));
+    }
+    std::fclose(f);
+    return ok;
+}
+
+// ============================================================================
+// write_chrome_json: Dump -> Chrome trace event JSON
+// ============================================================================
+// Claim'ler thread içinde commit/release/abandon olaylarıyla pos üzerinden
+// eşlenir; batch claim'in aralığı son slot'u kapanınca biter. Kapanmamış
+// claim'ler thread'in son olayına kadar "(open)" olarak yazılır.
+// ============================================================================
+inline void write_chrome_json(const Dump& d, std::ostream& out) {
+    std::uint64_t base = UINT64_MAX;
+    for (const auto& t : d.threads) {
+        if (!t.records.empty()) base = std::min(base, t.records.front().tsc);
+    }
+    const double tpu = d.ticks_per_us > 0 ? d.ticks_per_us : 1000.0;
+    auto us = [&](std::uint64_t tsc) { return static_cast<double>(tsc - base) / tpu; };
+    auto key = [](const Record& r, std::uint32_t pos) { return (std::uint64_t{r.ring} << 32) | pos; };
+
+    // Flow sonu sadece commit'i görülen item'lar için
+    std::unordered_set<std::uint64_t> committed;
+    for (const auto& t : d.threads) {
+        for (const auto& r : t.records) {
+            if (static_cast<Event>(r.event) == Event::Commit) committed.insert(key(r, r.pos));
+        }
+    }
+
+    char buf[512];
+    bool first = true;
+    auto emit = [&](const char* json) {
+        out << (first ? "\n" : ",\n") << json;
+        first = false;
+    };
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for (const auto& t : d.threads) {
+        std::string name;
+        for (char c : t.name.empty() ? "tid " + std::to_string(t.tid) : t.name) {
+            if (c == '"' || c == '\\') name += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) name += c;
+        }
+        std::snprintf(buf, sizeof(buf),
+                      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                      t.tid, name.c_str());
+        emit(buf);
+        if (t.dropped) {
+            std::snprintf(buf, sizeof(buf),
+                          "{\"name\":\"dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                          "\"args\":{\"records\":%llu}}",
+                          t.records.empty() ? 0.0 : us(t.records.front().tsc), t.tid,
+                          static_cast<unsigned long long>(t.dropped));
+            emit(buf);
+        }
+
+        struct Open {
+            std::uint64_t start;
+            std::uint32_t pos;
+            std::uint16_t n;
+            std::uint16_t remaining;
+            std::uint16_t lost;
+            bool producer;
+        };
+        std::vector<Open> open;
+        std::unordered_map<std::uint64_t, std::size_t> open_by_pos;
+        auto slice = [&](const Open& o, std::uint64_t end, const char* suffix) {
+            char name_buf[48];
+            if (o.n > 1) std::snprintf(name_buf, sizeof(name_buf), "%s x%u%s", o.producer ? "produce" : "consume",
+                                       o.n, suffix);
+            else std::snprintf(name_buf, sizeof(name_buf), "%s%s", o.producer ? "produce" : "consume", suffix);
+            std::snprintf(buf, sizeof(buf),
+                          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                          "\"tid\":%u,\"args\":{\"pos\":%u,\"n\":%u,\"lost\":%u}}",
+                          name_buf, o.producer ? "producer" : "consumer", us(o.start),
+                          us(end) - us(o.start) + 0.001, t.tid, o.pos, o.n, o.lost);
+            emit(buf);
+        };
+
+        for (std::size_t i = 0; i < t.records.size(); ++i) {
+            const Record& r = t.records[i];
+            const auto e = static_cast<Event>(r.event);
+            const double ts = us(r.tsc);
+            switch (e) {
+                case Event::ProducerClaim:
+                case Event::ConsumerClaim: {
+                    const std::uint16_t n = std::max<std::uint16_t>(r.count, 1);
+                    open.push_back(Open{r.tsc, r.pos, n, n, 0, e == Event::ProducerClaim});
+                    for (std::uint32_t k = 0; k < n; ++k) open_by_pos[key(r, r.pos + k)] = open.size() - 1;
+                    if (e == Event::ConsumerClaim) {
+                        for (std::uint32_t k = 0; k < n; ++k) {
+                            if (!committed.count(key(r, r.pos + k))) continue;
+                            std::snprintf(buf, sizeof(buf),
+                                          "{\"name\":\"item\",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\","
+                                          "\"id\":%llu,\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                                          static_cast<unsigned long long>(key(r, r.pos + k)), ts, t.tid);
+                            emit(buf);
+                        }
+                    }
+                    break;
+                }
+                case Event::Commit:
+                case Event::CommitLost:
+                case Event::Abandon:
+                case Event::Release: {
+                    if (e == Event::Commit) {
+                        std::snprintf(buf, sizeof(buf),
+                                      "{\"name\":\"item\",\"cat\":\"flow\",\"ph\":\"s\",\"id\":%llu,\"ts\":%.3f,"
+                                      "\"pid\":1,\"tid\":%u}",
+                                      static_cast<unsigned long long>(key(r, r.pos)), ts, t.tid);
+                        emit(buf);
+                    }
+                    auto it = open_by_pos.find(key(r, r.pos));
+                    if (it == open_by_pos.end()) break;   // Claim'i halkadan düşmüş
+                    Open& o = open[it->second];
+                    open_by_pos.erase(it);
+                    if (e != Event::Commit && e != Event::Release) ++o.lost;
+                    if (--o.remaining == 0) slice(o, r.tsc, "");
+                    break;
+                }
+                case Event::Full:
+                case Event::Empty: {
+                    const std::uint64_t end = i + 1 < t.records.size() ? t.records[i + 1].tsc : r.tsc;
+                    std::snprintf(buf, sizeof(buf),
+                                  "{\"name\":\"%s\",\"cat\":\"stall\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                                  "\"pid\":1,\"tid\":%u,\"args\":{\"pos\":%u,\"polls\":%u}}",
+                                  event_name(e), ts, us(end) - ts, t.tid, r.pos, r.count);
+                    emit(buf);
+                    break;
+                }
+            }
+        }
+        const std::uint64_t last = t.records.empty() ? 0 : t.records.back().tsc;
+        for (const auto& o : open) {
+            if (o.remaining != 0) slice(o, last, " (open)");
+        }
+    }
+    out << "\n]}\n";
+}
+
+}  // namespace mpmc_trace
@@ -0,0 +1,65 @@
+// ============================================================================
+// trace_export: İkili iz dump'ını Chrome/Perfetto trace JSON'una çevirir
+// ============================================================================
+// Girdi: app --trace FILE (MPMC_TRACE ile derlenmiş) veya
+// mpmc_trace::write_dump ile yazılan dosya. Çıktı ui.perfetto.dev veya
+// chrome://tracing ile açılır. stderr'e thread başına olay özeti yazılır.
+//
+// Build: g++ -std=c++20 -O2 trace_export.cpp -o trace_export
+// Run:   ./trace_export trace.bin trace.json
+//        ./trace_export trace.bin > trace.json
+// ============================================================================
+
+#include "trace.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "Usage: %s TRACE.bin [OUT.json]\n", argv[0]);
+        return 2;
+    }
+    mpmc_trace::Dump dump;
+    if (!mpmc_trace::read_dump(argv[1], dump)) {
+        std::fprintf(stderr, "cannot read trace dump %s\n", argv[1]);
+        return 1;
+    }
+
+    // Özet: thread başına olay sayıları ve bekleme denemeleri
+    std::fprintf(stderr, "%zu threads, %.1f ticks/us\n", dump.threads.size(), dump.ticks_per_us);
+    for (const auto& t : dump.threads) {
+        std::uint64_t counts[8] = {};
+        std::uint64_t polls = 0;
+        for (const auto& r : t.records) {
+            if (r.event < 8) ++counts[r.event];
+            if (r.event == static_cast<std::uint8_t>(mpmc_trace::Event::Full) ||
+                r.event == static_cast<std::uint8_t>(mpmc_trace::Event::Empty)) {
+                polls += r.count;
+            }
+        }
+        std::fprintf(stderr, "  tid %-7u %-16s records %-8zu", t.tid, t.name.c_str(), t.records.size());
+        for (int e = 0; e < 8; ++e) {
+            if (counts[e]) {
+                std::fprintf(stderr, " %s=%llu", mpmc_trace::event_name(static_cast<mpmc_trace::Event>(e)),
+                             static_cast<unsigned long long>(counts[e]));
+            }
+        }
+        if (polls) std::fprintf(stderr, " polls=%llu", static_cast<unsigned long long>(polls));
+        if (t.dropped) std::fprintf(stderr, " dropped=%llu", static_cast<unsigned long long>(t.dropped));
+        std::fprintf(stderr, "\n");
+    }
+
+    if (argc == 3) {
+        std::ofstream out(argv[2]);
+        if (!out) {
+            std::fprintf(stderr, "cannot open %s\n", argv[2]);
+            return 1;
+        }
+        mpmc_trace::write_chrome_json(dump, out);
+        return out ? 0 : 1;
+    }
+    mpmc_trace::write_chrome_json(dump, std::cout);
+    return 0;
+}
@@ -0,0 +1,152 @@
+// ============================================================================
+// UDP Ingest: recvmmsg ile datagram'ları doğrudan claim edilen chunk'lara alır
+// ============================================================================
+// RF front-end'leri UDP datagram gönderir. Klasik yol: recv() ile soket
+// buffer'ına al, sonra ticket.cpu_ptr'a kopyala (datagram başına 1 syscall +
+// 1 kopya). UdpIngest bunun yerine:
+//
+//   1. claim_producer_batch ile N ardışık boş slot claim eder
+//   2. mmsghdr iovec'lerini doğrudan bu chunk'lara (cpu_ptr) yönlendirir
+//   3. Tek bir recvmmsg çağrısı yapar (kernel -> ring tek kopya)
+//   4. Gelen k datagram'ın uzunluğunu size_ptr'a (meta_size_) yazar,
+//      rf.first = kanal id ile işaretler ve k slot'u sırayla commit eder
+//   5. Kullanılmayan N-k slot commit edilmez; tail_ ilerlemediği için
+//      bir sonraki batch'te tekrar kullanılır
+//
+// Buffer'a yazan TEK producer UdpIngest olmalıdır (claim_producer_batch).
+// chunk_size'tan büyük datagram'lar kesilir (MSG_TRUNC) ve sayılır.
+// ============================================================================
+
+#pragma once
+
+#include "circular_buffer.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class UdpIngest {
+public:
+    struct Config {
+        std::size_t batch = 32;   // recvmmsg başına en fazla datagram
+        int channel = 0;          // Slot'lara yazılacak rf.first
+    };
+
+    struct Stats {
+        std::uint64_t datagrams = 0;   // Commit edilen datagram sayısı
+        std::uint64_t syscalls = 0;    // recvmmsg çağrı sayısı
+        std::uint64_t truncated = 0;   // chunk_size'a sığmayıp kesilen datagram
+        std::uint64_t ring_full = 0;   // Boş slot bulunamayan poll sayısı
+    };
+
+    // fd'nin sahipliği çağıranda kalır (UdpIngest kapatmaz)
+    UdpIngest(CircularBuffer& buffer, int fd) : UdpIngest(buffer, fd, Config{}) {}
+    UdpIngest(CircularBuffer& buffer, int fd, Config config)
+        : buffer_(buffer), fd_(fd), config_(config) {
+        if (config_.batch == 0) config_.batch = 1;
+        tickets_.resize(config_.batch);
+        iov_.resize(config_.batch);
+        msgs_.resize(config_.batch);
+    }
+
+    // ========================================================================
+    // open_socket: UDP soketi açar ve bind eder (port 0 = kernel seçer)
+    // ========================================================================
+    // Hata durumunda -1 döner (errno korunur). rcvbuf > 0 ise SO_RCVBUF ayarlanır.
+    // ========================================================================
+    static int open_socket(std::uint16_t port, const char* address = "0.0.0.0", int rcvbuf = 0) {
+        int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        if (rcvbuf > 0) ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1 ||
+            ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            int saved = errno;
+            ::close(fd);
+            errno = saved;
+            return -1;
+        }
+        return fd;
+    }
+
+    // Soketin bağlı olduğu port (port 0 ile açıldıysa gerçek port)
+    static std::uint16_t local_port(int fd) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return 0;
+        return ntohs(addr.sin_port);
+    }
+
+    // ========================================================================
+    // poll_once: Bir batch claim + tek recvmmsg + commit
+    // ========================================================================
+    // flags: MSG_DONTWAIT (varsayılan, hiç veri yoksa hemen döner) veya
+    // MSG_WAITFORONE (en az bir datagram gelene kadar bekler, sonra
+    // beklemeden kalanları alır). Dönüş: commit edilen datagram sayısı;
+    // hata/veri yok durumunda 0 (errno recvmmsg'den).
+    // ========================================================================
+    std::size_t poll_once(int flags = MSG_DONTWAIT) {
+        const std::size_t n = buffer_.claim_producer_batch(tickets_.data(), config_.batch);
+        if (n == 0) {
+            ++stats_.ring_full;
+            return 0;
+        }
+
+        const std::size_t chunk = buffer_.chunk_size();
+        for (std::size_t i = 0; i < n; ++i) {
+            iov_[i].iov_base = tickets_[i].cpu_ptr;
+            iov_[i].iov_len = chunk;
+            std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+            msgs_[i].msg_hdr.msg_iov = &iov_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        ++stats_.syscalls;
+        const int got = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned>(n), flags, nullptr);
+        // Kullanılmayan slot'lar commit edilmez (resizable buffer'da kapı payı geri verilir)
+        for (std::size_t i = got > 0 ? static_cast<std::size_t>(got) : 0; i < n; ++i) {
+            buffer_.abandon_producer(tickets_[i]);
+        }
+        if (got <= 0) return 0;
+
+        std::size_t committed = 0;
+        for (int i = 0; i < got; ++i) {
+            CircularBuffer::Ticket& t = tickets_[static_cast<std::size_t>(i)];
+            const mmsghdr& m = msgs_[static_cast<std::size_t>(i)];
+            std::size_t len = m.msg_len;
+            if (m.msg_hdr.msg_flags & MSG_TRUNC) {
+                ++stats_.truncated;
+                if (len > chunk) len = chunk;
+            }
+            *t.size_ptr = len;
+            *t.rf = {config_.channel, 0.0};
+            // Sırayla commit: tail_ == pos şartı her adımda sağlanır
+            if (buffer_.commit_producer(t)) ++committed;
+        }
+        stats_.datagrams += committed;
+        return committed;
+    }
+
+    const Stats& stats() const { return stats_; }
+    int fd() const { return fd_; }
+
+private:
+    CircularBuffer& buffer_;
+    int fd_;
+    Config config_;
+    Stats stats_;
+
+    // Batch başına yeniden kullanılan diziler (hot path'te allocation yok)
+    std::vector<CircularBuffer::Ticket> tickets_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> msgs_;
+};